@@ -58,6 +58,14 @@ android {
         }
     }
 
+    // ------------------------------------------------------------
+    // Keep bundled ggml models uncompressed so they can be mmapped
+    // straight from the APK (see initContextFromAssetMapped)
+    // ------------------------------------------------------------
+    androidResources {
+        noCompress += "bin"
+    }
+
     // ------------------------------------------------------------
     // Compose and build features
     // ------------------------------------------------------------
@@ -8,26 +8,30 @@ import android.media.*
 import android.util.Log
 import androidx.annotation.RequiresPermission
 import androidx.core.content.ContextCompat
+import com.whispercpp.whisper.WhisperCapture
 import kotlinx.coroutines.*
-import java.io.*
+import java.io.Closeable
 import java.util.concurrent.Executors
 import java.util.concurrent.atomic.AtomicReference
 
 /**
- * High-reliability single-threaded WAV recorder.
+ * High-reliability single-threaded in-memory recorder.
  *
  * State machine:
  *   Idle → Starting → Recording → Stopping → Idle
  *
  * Technical highlights:
  *  • Dedicated single thread + coroutine scope ensures sequential audio operations.
- *  • Writes temporary PCM → rewrites valid RIFF/WAVE header upon stop().
+ *  • Zero-disk: PCM16 chunks go straight into a native [WhisperCapture];
+ *    no temp file and no per-sample byte conversion on the read loop.
+ *  • stop() hands the capture to the caller, which transcribes from memory
+ *    and archives the WAV (WhisperCapture.writeWav) off the critical path.
  *  • Supports rapid Record→Stop taps without race conditions.
  *  • Uses atomic state and AudioRecord release safety.
  *
  * Typical lifecycle:
- *   startRecording(File)
- *   stopRecording()  // suspending
+ *   startRecording()
+ *   stopRecording()  // suspending, returns the WhisperCapture (caller closes)
  *   close()          // on ViewModel/Activity teardown
  */
 class Recorder(
@@ -49,8 +53,7 @@ class Recorder(
     // -------------------------------------------------------------------------
     private var job: Job? = null
     private val activeRecorder = AtomicReference<AudioRecord?>(null)
-    private var tempPcm: File? = null
-    private var targetWav: File? = null
+    private var capture: WhisperCapture? = null
     private var cfg: Config? = null
 
     private enum class State { Idle, Starting, Recording, Stopping }
@@ -68,18 +71,15 @@ class Recorder(
      * Starts recording in a deterministic, race-free manner.
      * Idempotent — calling during active/starting state is ignored.
      *
-     * @param output target WAV file (will be overwritten)
      * @param rates prioritized sample rate candidates
      */
     fun startRecording(
-        output: File,
         rates: IntArray = intArrayOf(16_000, 48_000, 44_100)
     ) {
         if (!state.compareAndSet(State.Idle, State.Starting)) {
             Log.w(TAG, "startRecording ignored: current=${state.get()}")
             return
         }
-        targetWav = output
 
         scope.launch {
             try {
@@ -100,43 +100,31 @@ class Recorder(
                 }
 
                 activeRecorder.set(rec)
-                tempPcm = File.createTempFile("rec_", ".pcm", context.cacheDir)
-                val tmp = tempPcm!!
+                val cap = WhisperCapture(conf.sampleRate)
+                capture = cap
 
                 state.set(State.Recording)
 
-                // Writer coroutine: blocking read() loop → PCM write → stop
+                // Writer coroutine: blocking read() loop → native capture push → stop
                 job = launch {
-                    FileOutputStream(tmp).use { fos ->
-                        val bos = BufferedOutputStream(fos, conf.bufferSize)
-                        val shortBuf = ShortArray(conf.bufferSize / 2)
-                        val byteBuf = ByteArray(shortBuf.size * 2)
-
-                        try {
-                            rec.startRecording()
-                            Log.i(TAG, "🎙 start ${conf.sampleRate}Hz buf=${conf.bufferSize}")
-
-                            while (isActive) {
-                                val n = rec.read(shortBuf, 0, shortBuf.size)
-                                if (n <= 0) {
-                                    if (n < 0) Log.w(TAG, "read() error=$n → break")
-                                    break
-                                }
-                                var j = 0
-                                for (i in 0 until n) {
-                                    val v = shortBuf[i].toInt()
-                                    byteBuf[j++] = (v and 0xFF).toByte()
-                                    byteBuf[j++] = ((v ushr 8) and 0xFF).toByte()
-                                }
-                                bos.write(byteBuf, 0, n * 2)
+                    val shortBuf = ShortArray(conf.bufferSize / 2)
+                    try {
+                        rec.startRecording()
+                        Log.i(TAG, "🎙 start ${conf.sampleRate}Hz buf=${conf.bufferSize}")
+
+                        while (isActive) {
+                            val n = rec.read(shortBuf, 0, shortBuf.size)
+                            if (n <= 0) {
+                                if (n < 0) Log.w(TAG, "read() error=$n → break")
+                                break
                             }
-                            bos.flush()
-                        } finally {
-                            runCatching { rec.stop() }
-                            runCatching { rec.release() }
-                            activeRecorder.compareAndSet(rec, null)
-                            Log.i(TAG, "🎙 stopped & released (writer exit)")
+                            cap.push(shortBuf, 0, n)
                         }
+                    } finally {
+                        runCatching { rec.stop() }
+                        runCatching { rec.release() }
+                        activeRecorder.compareAndSet(rec, null)
+                        Log.i(TAG, "🎙 stopped & released (writer exit)")
                     }
                 }
             } catch (e: Exception) {
@@ -155,21 +143,23 @@ class Recorder(
     // Stop Recording
     // -------------------------------------------------------------------------
     /**
-     * Stops recording and finalizes the WAV file.
+     * Stops recording and hands over the captured audio.
      *
      * Steps:
      *  1. Unblock AudioRecord.read() via stop()
      *  2. Cancel & join writer coroutine
-     *  3. Write valid RIFF/WAV header to target file
-     *  4. Cleanup temp PCM and reset state
+     *  3. Transfer the [WhisperCapture] to the caller (who must close it)
+     *  4. Reset state
+     *
+     * @return the capture, or null if nothing was recorded
      */
-    suspend fun stopRecording() = withContext(Dispatchers.IO) {
+    suspend fun stopRecording(): WhisperCapture? = withContext(Dispatchers.IO) {
         Log.d(TAG, "stopRecording() invoked (state=${state.get()})")
 
         val s = state.get()
         if (s == State.Idle) {
             Log.w(TAG, "stopRecording: already idle")
-            return@withContext
+            return@withContext null
         }
         if (s == State.Starting || s == State.Recording) {
             state.set(State.Stopping)
@@ -189,30 +179,23 @@ class Recorder(
             job?.join()
             Log.d(TAG, "Writer job joined successfully")
 
-            val pcm = tempPcm
-            val wav = targetWav
-            val c = cfg
-            Log.d(TAG, "post-join: pcm=$pcm wav=$wav cfg=$c")
-
-            if (pcm == null || wav == null || c == null) {
-                Log.w(TAG, "stopRecording: missing pieces (aborting WAV write)")
-                state.set(State.Idle)
-                return@withContext
+            val cap = capture
+            capture = null
+            if (cap == null) {
+                Log.w(TAG, "stopRecording: no capture (recording never started)")
+                return@withContext null
             }
-
-            // Write WAV header and merge PCM payload
-            writeWavFromPcm(pcm, wav, c.sampleRate, 1, 16)
-            Log.d(TAG, "WAV header written")
-
-            if (wav.length() <= 44L) {
-                Log.w(TAG, "WAV too short (<=44 bytes), deleting: ${wav.path}")
-                wav.delete()
-            } else {
-                Log.i(TAG, "✅ WAV finalized: ${wav.path} (${wav.length()} bytes)")
+            if (cap.frames == 0L) {
+                Log.w(TAG, "stopRecording: capture empty, discarding")
+                cap.close()
+                return@withContext null
             }
+            Log.i(TAG, "✅ Captured ${cap.frames} frames @ ${cap.sampleRate}Hz (${cap.durationMs} ms)")
+            cap
         } catch (e: Exception) {
             Log.e(TAG, "stopRecording error", e)
             onError(e)
+            null
         } finally {
             cleanup()
             state.set(State.Idle)
@@ -223,35 +206,10 @@ class Recorder(
     // -------------------------------------------------------------------------
     // Internal Helpers
     // -------------------------------------------------------------------------
-    /** Writes RIFF/WAVE header + PCM data → valid WAV file. */
-    private fun writeWavFromPcm(pcm: File, wav: File, rate: Int, ch: Int, bits: Int) {
-        val size = pcm.length().toInt().coerceAtLeast(0)
-        val byteRate = rate * ch * bits / 8
-        val blockAlign = (ch * bits / 8).toShort()
-        DataOutputStream(BufferedOutputStream(FileOutputStream(wav))).use { out ->
-            out.writeBytes("RIFF"); out.writeIntLE(size + 36)
-            out.writeBytes("WAVE")
-            out.writeBytes("fmt "); out.writeIntLE(16)
-            out.writeShortLE(1); out.writeShortLE(ch)
-            out.writeIntLE(rate); out.writeIntLE(byteRate)
-            out.writeShortLE(blockAlign.toInt()); out.writeShortLE(bits)
-            out.writeBytes("data"); out.writeIntLE(size)
-            FileInputStream(pcm).use { it.copyTo(out) }
-        }
-    }
-
-    private fun DataOutputStream.writeShortLE(v: Int) {
-        write(v and 0xFF); write((v ushr 8) and 0xFF)
-    }
-    private fun DataOutputStream.writeIntLE(v: Int) {
-        write(v and 0xFF); write((v ushr 8) and 0xFF)
-        write((v ushr 16) and 0xFF); write((v ushr 24) and 0xFF)
-    }
-
-    /** Deletes temporary files and resets cached config. */
+    /** Frees any capture not handed to the caller and resets cached config. */
     private fun cleanup() {
-        runCatching { tempPcm?.delete() }
-        tempPcm = null; targetWav = null; cfg = null; job = null
+        runCatching { capture?.close() }
+        capture = null; cfg = null; job = null
     }
 
     /** Validates microphone presence and permission. */
@@ -304,7 +262,7 @@ class Recorder(
      * Blocks until cleanup is complete.
      */
     override fun close() {
-        runBlocking { if (isActive()) stopRecording() }
+        runBlocking { if (isActive()) stopRecording()?.close() }
         runCatching { dispatcher.close() }
         runCatching { executor.shutdownNow() }
     }
@@ -98,7 +98,7 @@ fun ConfigButtonWithDialog(viewModel: MainScreenViewModel) {
             text = {
                 Column(verticalArrangement = Arrangement.spacedBy(8.dp)) {
                     Text("Select language")
-                    val languages = listOf("en" to "English", "ja" to "Japanese", "sw" to "Swahili")
+                    val languages = listOf("auto" to "Auto-detect", "en" to "English", "ja" to "Japanese", "sw" to "Swahili")
                     DropdownSelector(
                         currentValue = viewModel.selectedLanguage,
                         options = languages,
@@ -129,6 +129,22 @@ fun ConfigButtonWithDialog(viewModel: MainScreenViewModel) {
                         )
                         Text("Translate to English")
                     }
+
+                    Row(verticalAlignment = Alignment.CenterVertically) {
+                        Checkbox(
+                            checked = viewModel.beamDecoding,
+                            onCheckedChange = { viewModel.updateBeamDecoding(it) }
+                        )
+                        Text("Beam search (slower, more accurate)")
+                    }
+
+                    Row(verticalAlignment = Alignment.CenterVertically) {
+                        Checkbox(
+                            checked = viewModel.draftPreview,
+                            onCheckedChange = { viewModel.updateDraftPreview(it) }
+                        )
+                        Text("Draft preview (tiny model first)")
+                    }
                 }
             },
             confirmButton = {
@@ -37,9 +37,17 @@ import androidx.core.net.toUri
 import androidx.lifecycle.ViewModel
 import androidx.lifecycle.ViewModelProvider
 import androidx.lifecycle.viewModelScope
-import com.negi.whispers.media.decodeWaveFile
+import com.negi.whispers.media.decodeAudioFileToBuffer
 import com.negi.whispers.recorder.Recorder
 import com.whispercpp.whisper.WhisperContext
+import com.whispercpp.whisper.WhisperDecodeParams
+import com.whispercpp.whisper.WhisperDraftPair
+import com.whispercpp.whisper.WhisperModelCache
+import com.whispercpp.whisper.WhisperModelStore
+import com.whispercpp.whisper.WhisperPool
+import com.whispercpp.whisper.WhisperThermalScheduler
+import com.whispercpp.whisper.WhisperVadConfig
+import com.whispercpp.whisper.toTranscript
 import kotlinx.coroutines.*
 import kotlinx.coroutines.flow.collectLatest
 import kotlinx.coroutines.sync.Mutex
@@ -47,12 +55,45 @@ import kotlinx.coroutines.sync.withLock
 import kotlinx.serialization.builtins.ListSerializer
 import kotlinx.serialization.json.Json
 import java.io.File
+import java.nio.FloatBuffer
 import java.text.SimpleDateFormat
 import java.util.*
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.Executors
+import java.util.concurrent.atomic.AtomicInteger
 import java.util.concurrent.atomic.AtomicReference
 
 private const val TAG = "MainScreenViewModel"
 
+/** Clips longer than this (30 s @ 16 kHz) stream their segments into the log. */
+private const val LIVE_SEGMENTS_MIN_SAMPLES = 30 * 16_000
+
+/** Clips longer than this (2 min @ 16 kHz) are chunked across all pool states. */
+private const val LONG_FORM_MIN_SAMPLES = 120 * 16_000
+
+/** An idle [WhisperPool] frees its states after this long without pooled jobs. */
+private const val POOL_IDLE_MS = 30_000L
+
+/** Draft model for the preview pass ahead of larger models. */
+private const val DRAFT_MODEL = "ggml-tiny-q5_1.bin"
+
+/** Draft threads: the draft runs beside the selected model and must not slow it down. */
+private const val DRAFT_THREADS = 2
+
+/** Default decoding: whisper's greedy defaults, encoder context sized per memo. */
+private val GREEDY_PARAMS = WhisperDecodeParams(autoAudioCtx = true)
+
+/** Opt-in beam search ([MainScreenViewModel.updateBeamDecoding]): ~5× decode cost. */
+private val BEAM_PARAMS = WhisperDecodeParams.ACCURATE.copy(autoAudioCtx = true)
+
+/**
+ * Thermal downgrade order, largest first. The default ggml-model-q4_0.bin
+ * is base at q4_0: cheaper than base-q5_1, dearer than tiny.
+ */
+private val MODEL_LADDER = listOf(
+    "ggml-small-q5_1.bin", "ggml-base-q5_1.bin", "ggml-model-q4_0.bin", "ggml-tiny-q5_1.bin"
+)
+
 /**
  * Provides state and logic for the main Whisper screen.
  * Manages user recording, transcription, and playback lifecycle.
@@ -71,6 +112,8 @@ class MainScreenViewModel(private val app: Application) : ViewModel() {
     var isModelLoading by mutableStateOf(false); private set
     var hasAllRequiredPermissions by mutableStateOf(false); private set
     var translateToEnglish by mutableStateOf(false); private set
+    var draftPreview by mutableStateOf(false); private set
+    var beamDecoding by mutableStateOf(false); private set
     var myRecords by mutableStateOf<List<MyRecord>>(emptyList()); private set
 
     // ---------------------------------------------------------------------
@@ -80,14 +123,57 @@ class MainScreenViewModel(private val app: Application) : ViewModel() {
     private val modelsDir = File(app.filesDir, "models")
     private val recDir = File(app.filesDir, "recordings")
     private var whisperCtx: WhisperContext? = null
+    /**
+     * Extra states over [whisperCtx]'s weights for concurrent re-transcription.
+     * Each state costs tens of MB, so the pool is created by the first pooled
+     * job and freed [POOL_IDLE_MS] after the last one (see [acquirePool]).
+     */
+    private var whisperPool: WhisperPool? = null
+    /** Guards [whisperPool], [poolJobs] and [poolIdleRelease]. */
+    private val poolMutex = Mutex()
+    private var poolJobs = 0
+    private var poolIdleRelease: Job? = null
+    /**
+     * Tiny model for [draftPreview]: its transcript is shown while [whisperCtx] refines it.
+     * Loaded and released on [draftDispatcher] only.
+     */
+    @Volatile private var draftCtx: WhisperContext? = null
+    /** WAV archive jobs still writing, by path: readers of that file join them first. */
+    private val pendingArchives = ConcurrentHashMap<String, Job>()
+    /** Serializes every [draftCtx] load / release (settings toggle, model switch, teardown). */
+    private val draftDispatcher = Executors.newSingleThreadExecutor { r ->
+        Thread(r, "DraftModelThread").apply { isDaemon = true }
+    }.asCoroutineDispatcher()
+    /**
+     * Greedy decoding (whisper defaults) unless [beamDecoding] is on, then beam
+     * search; encoder context sized to each memo either way.
+     */
+    private val decodeParams: WhisperDecodeParams
+        get() = if (beamDecoding) BEAM_PARAMS else GREEDY_PARAMS
+    /** Threads / cores / model tier for sustained sessions (main-context jobs). */
+    private val thermal = WhisperThermalScheduler(app)
+    /** Model picked by the user; thermal downgrades return to it (see [adjustModelTier]). */
+    private var userModel = selectedModel
+    /** When the last thermal downgrade happened (elapsedRealtime), 0 outside the highest level. */
+    private var thermalDowngradeAtMs = 0L
+    /** When the level last fell below the highest while downgraded (elapsedRealtime), 0 otherwise. */
+    private var thermalCoolSinceMs = 0L
     private var mediaPlayer: MediaPlayer? = null
     private var currentFile: File? = null
 
     private val transcribeJobRef = AtomicReference<Job?>(null)
+    private val activeTranscriptions = AtomicInteger(0)
     private val saveMutex = Mutex()
     private val json = Json { prettyPrint = false; ignoreUnknownKeys = true }
     private var recordStartMs: Long = 0L
 
+    /**
+     * Decode target for main-context jobs: the context's reusable off-heap
+     * buffer (grows to the longest clip), so dictation does not allocate.
+     */
+    private fun mainAudioBuffer(samples: Int): FloatBuffer =
+        whisperCtx?.audioBuffer(samples) ?: WhisperContext.allocateAudioBuffer(samples)
+
     private val recorder = Recorder(app) { e ->
         Log.e(TAG, "Recorder error", e)
         isRecording = false
@@ -99,6 +185,7 @@ class MainScreenViewModel(private val app: Application) : ViewModel() {
     // ---------------------------------------------------------------------
 
     init {
+        WhisperModelCache.install(app)
         viewModelScope.launch {
             setupDirs()
             loadRecords()
@@ -137,8 +224,23 @@ class MainScreenViewModel(private val app: Application) : ViewModel() {
 
     fun updateSelectedLanguage(lang: String) { selectedLanguage = lang }
     fun updateTranslate(enable: Boolean) { translateToEnglish = enable }
+    fun updateBeamDecoding(enable: Boolean) { beamDecoding = enable }
+
+    fun updateDraftPreview(enable: Boolean) {
+        if (enable == draftPreview) return
+        draftPreview = enable
+        viewModelScope.launch { loadDraftModel() }
+    }
 
     fun updateSelectedModel(model: String) {
+        userModel = model
+        thermalDowngradeAtMs = 0L
+        thermalCoolSinceMs = 0L
+        switchModel(model)
+    }
+
+    /** Loads [model] without changing the user's choice ([userModel]). */
+    private fun switchModel(model: String) {
         if (model == selectedModel) return
         selectedModel = model
         viewModelScope.launch { loadModel(model) }
@@ -155,10 +257,32 @@ class MainScreenViewModel(private val app: Application) : ViewModel() {
         try {
             releaseWhisper()
             releaseMediaPlayer()
+            // Cached: switching back to a recent model skips the weight reload.
+            // The extracted copy (no zip / AAsset layer) is preferred once it exists
+            // and its hash was checked; it shares the asset's cache entry.
+            val asset = "models/$model"
+            val extracted = WhisperModelStore.verifiedFile(app, asset)
             whisperCtx = withContext(Dispatchers.IO) {
-                WhisperContext.createContextFromAsset(app.assets, "models/$model")
-            }
+                if (extracted != null) WhisperContext.createContextFromFileCached(extracted.path)
+                else WhisperContext.createContextFromAssetCached(app.assets, asset)
+            }.also { it.setVad(WhisperVadConfig()) }  // skip pauses in voice memos
             addToastLog("📦 Model loaded: $model")
+            loadDraftModel()
+            // Pay first-run costs now, while the user is still getting ready to speak.
+            whisperCtx?.let { ctx ->
+                viewModelScope.launch {
+                    runCatching { ctx.warmUp() }
+                        .onSuccess { Log.i(TAG, "Warm-up: $it ms") }
+                        .onFailure { Log.w(TAG, "Warm-up skipped", it) }
+                }
+            }
+            // First run: extract in the background so the next launch loads from a file.
+            if (extracted == null) {
+                viewModelScope.launch {
+                    runCatching { WhisperModelStore.extract(app, asset) }
+                        .onFailure { Log.w(TAG, "Model extraction skipped", it) }
+                }
+            }
         } catch (e: Exception) {
             Log.e(TAG, "Model load failed", e)
             addToastLog("⛔ Model load failed: ${e.message}")
@@ -168,6 +292,40 @@ class MainScreenViewModel(private val app: Application) : ViewModel() {
         }
     }
 
+    /** Loads or releases [draftCtx] to match [draftPreview] and the selected model. */
+    private suspend fun loadDraftModel() = withContext(draftDispatcher) {
+        val wanted = draftPreview && selectedModel != DRAFT_MODEL
+        if (wanted == (draftCtx != null)) return@withContext
+        if (!wanted) {
+            releaseDraftLocked()
+            return@withContext
+        }
+        // Same source rules as loadModel(): the verified extracted copy once it exists.
+        val asset = "models/$DRAFT_MODEL"
+        val extracted = WhisperModelStore.verifiedFile(app, asset)
+        runCatching {
+            if (extracted != null) WhisperContext.createContextFromFileCached(extracted.path)
+            else WhisperContext.createContextFromAssetCached(app.assets, asset)
+        }
+            .onSuccess { draftCtx = it.apply { threadCount = DRAFT_THREADS } }
+            .onFailure {
+                Log.w(TAG, "Draft model load failed", it)
+                addToastLog("⚠️ Draft preview unavailable: ${it.message}")
+            }
+        if (extracted == null) {
+            viewModelScope.launch {
+                runCatching { WhisperModelStore.extract(app, asset) }
+                    .onFailure { Log.w(TAG, "Draft model extraction skipped", it) }
+            }
+        }
+    }
+
+    /** Frees [draftCtx]; caller is on [draftDispatcher]. */
+    private suspend fun releaseDraftLocked() {
+        runCatching { draftCtx?.release() }
+        draftCtx = null
+    }
+
     // ---------------------------------------------------------------------
     // Recording Controls
     // ---------------------------------------------------------------------
@@ -190,16 +348,17 @@ class MainScreenViewModel(private val app: Application) : ViewModel() {
                     val elapsed = SystemClock.elapsedRealtime() - recordStartMs
                     if (elapsed < 800L) delay(800L - elapsed)
 
-                    withContext(Dispatchers.IO) { recorder.stopRecording() }
+                    val capture = withContext(Dispatchers.IO) { recorder.stopRecording() }
 
                     val file = currentFile
                     currentFile = null
-                    if (file == null || !file.exists()) {
+                    if (file == null) {
+                        capture?.close()
                         addToastLog("⚠️ Recording missing")
                         return@launch
                     }
-                    if (file.length() <= 44L) {
-                        addToastLog("⚠️ WAV too short / silent")
+                    if (capture == null) {
+                        addToastLog("⚠️ Recording too short / silent")
                         return@launch
                     }
 
@@ -207,7 +366,21 @@ class MainScreenViewModel(private val app: Application) : ViewModel() {
                     val recIndex = myRecords.lastIndex
                     onScrollToIndex(recIndex)
                     addResultLog("🧠 Transcribing...", recIndex)
-                    startTranscriptionJob(file, recIndex)
+
+                    // Transcribe straight from memory; archive the WAV in parallel.
+                    val archive = viewModelScope.launch(Dispatchers.IO) {
+                        runCatching { capture.writeWav(file) }.onFailure {
+                            Log.e(TAG, "WAV archive failed", it)
+                            addResultLog("⚠️ WAV save failed: ${it.message}", recIndex)
+                        }
+                    }
+                    pendingArchives[file.path] = archive
+                    archive.invokeOnCompletion { pendingArchives.remove(file.path, archive) }
+                    startTranscriptionJob(
+                        index = recIndex,
+                        load = { capture.toBuffer(allocate = ::mainAudioBuffer) },
+                        onDone = { archive.invokeOnCompletion { capture.close() } }
+                    )
                 } else {
                     // Start recording
                     if (!hasAllRequiredPermissions) {
@@ -219,7 +392,7 @@ class MainScreenViewModel(private val app: Application) : ViewModel() {
                     currentFile = file
                     recordStartMs = SystemClock.elapsedRealtime()
                     addToastLog("🎙️ Recording started...")
-                    recorder.startRecording(file, intArrayOf(16_000, 48_000, 44_100))
+                    recorder.startRecording(intArrayOf(16_000, 48_000, 44_100))
                     isRecording = true
                 }
             } catch (e: Exception) {
@@ -238,6 +411,13 @@ class MainScreenViewModel(private val app: Application) : ViewModel() {
     /**
      * Re-runs transcription for an existing record.
      * Prevents rapid re-trigger with debounce guard.
+     *
+     * Runs on the main context when it is idle, so that repeated runs of the
+     * same record (e.g. in another language) reuse its retained log-mel and
+     * skip the WAV decode. Otherwise runs on [whisperPool]: re-transcriptions
+     * of different records proceed concurrently (up to the pool size) and do
+     * not cancel each other. Either way a clip of [LONG_FORM_MIN_SAMPLES] or
+     * more is chunked across the pool's states (see [transcribeLongPooled]).
      */
     fun reTranscribe(index: Int) {
         viewModelScope.launch {
@@ -257,13 +437,22 @@ class MainScreenViewModel(private val app: Application) : ViewModel() {
 
             val rec = myRecords[index]
             val file = File(rec.absolutePath)
+            awaitArchive(file)
             if (!file.exists()) {
                 addResultLog("⛔ Missing file: ${file.name}", index)
                 return@launch
             }
 
             addResultLog("🔁 Re-transcribing ${file.name}...", index)
-            startTranscriptionJob(file, index)
+            if (whisperCtx != null && transcribeJobRef.get()?.isActive != true) {
+                startTranscriptionJob(
+                    index,
+                    load = { decodeAudioFileToBuffer(file, allocate = ::mainAudioBuffer) },
+                    melKey = WhisperContext.melKeyFor(file)
+                )
+            } else {
+                startPooledTranscriptionJob(file, index)
+            }
         }
     }
 
@@ -271,12 +460,118 @@ class MainScreenViewModel(private val app: Application) : ViewModel() {
     // Transcription
     // ---------------------------------------------------------------------
 
-    private fun startTranscriptionJob(file: File, index: Int) {
+    /**
+     * Independent job on [whisperPool] (falls back to the main context).
+     * Decodes into its own buffer because pooled jobs overlap.
+     */
+    private suspend fun startPooledTranscriptionJob(file: File, index: Int) {
+        val pool = acquirePool() ?: return startTranscriptionJob(
+            index, load = { decodeAudioFileToBuffer(file, allocate = ::mainAudioBuffer) }
+        )
+        val job = viewModelScope.launch(Dispatchers.Default) {
+            transcribeAudio(
+                load = { decodeAudioFileToBuffer(file) },
+                index = index,
+                transcribe = { pcm ->
+                    if (pool.size > 1 && pcm.remaining() >= LONG_FORM_MIN_SAMPLES) {
+                        // Meetings / archive: chunks decoded in parallel on all pool states.
+                        pool.transcribeLong(pcm, selectedLanguage, translateToEnglish, decodeParams)
+                            .toTranscript()
+                    } else {
+                        pool.transcribeData(pcm, selectedLanguage, translateToEnglish, params = decodeParams)
+                    }
+                }
+            )
+        }
+        job.invokeOnCompletion { e ->
+            viewModelScope.launch { releasePool(pool) }
+            addResultLog(
+                if (e == null) "✅ Transcription completed" else "⛔ Transcription failed: ${e.message}",
+                index
+            )
+        }
+    }
+
+    /**
+     * Long clip of a main-context job, chunked across [whisperPool]'s states
+     * (the main context only resolved its language).
+     *
+     * @return the transcript, or null when no pool of two or more states is available
+     */
+    private suspend fun transcribeLongPooled(samples: FloatBuffer, lang: String): String? {
+        val pool = acquirePool() ?: return null
+        try {
+            if (pool.size < 2) return null
+            return pool.transcribeLong(samples, lang, translateToEnglish, decodeParams).toTranscript()
+        } finally {
+            releasePool(pool)
+        }
+    }
+
+    /**
+     * Takes one job reference on [whisperPool], creating it over [whisperCtx]
+     * on first use; pair with [releasePool].
+     *
+     * @return the pool, or null without a model or if its states cannot be allocated
+     */
+    private suspend fun acquirePool(): WhisperPool? = poolMutex.withLock {
+        poolIdleRelease?.cancel()
+        poolIdleRelease = null
+        val pool = whisperPool ?: whisperCtx?.let { ctx ->
+            runCatching { WhisperPool.create(ctx) }
+                .onSuccess { Log.i(TAG, "Pool created (${it.size} states)") }
+                .onFailure { Log.w(TAG, "Pool unavailable", it) }
+                .getOrNull()
+        }
+        whisperPool = pool
+        if (pool != null) poolJobs++
+        pool
+    }
+
+    /**
+     * Drops a job reference from [acquirePool]; the last one schedules the
+     * idle release. References to an already replaced pool are ignored.
+     */
+    private suspend fun releasePool(pool: WhisperPool) = poolMutex.withLock {
+        if (pool !== whisperPool) return@withLock
+        poolJobs = (poolJobs - 1).coerceAtLeast(0)
+        if (poolJobs > 0) return@withLock
+        poolIdleRelease?.cancel()
+        poolIdleRelease = viewModelScope.launch {
+            delay(POOL_IDLE_MS)
+            poolMutex.withLock {
+                if (poolJobs == 0) freePoolLocked()
+            }
+        }
+    }
+
+    /** Frees the pool's states (waits for running jobs). [poolMutex] held. */
+    private suspend fun freePoolLocked() {
+        val pool = whisperPool ?: return
+        whisperPool = null
+        poolJobs = 0
+        runCatching { pool.release() }
+        Log.i(TAG, "Pool released")
+    }
+
+    /**
+     * Launches a transcription; [load] produces the 16 kHz PCM on IO and
+     * [onDone] runs once the job finishes, is cancelled or fails. With a
+     * [melKey] the clip's log-mel is retained on the main context and a
+     * later run with the same key skips [load] entirely.
+     */
+    private fun startTranscriptionJob(
+        index: Int,
+        load: suspend () -> FloatBuffer,
+        onDone: () -> Unit = {},
+        melKey: String? = null
+    ) {
         transcribeJobRef.getAndSet(null)?.cancel()
         val job = viewModelScope.launch(Dispatchers.Default, CoroutineStart.UNDISPATCHED) {
-            transcribeAudio(file, index)
+            transcribeAudio(load, index, melKey = melKey)
         }
         job.invokeOnCompletion { e ->
+            onDone()
             addResultLog(
                 if (e == null) "✅ Transcription completed" else "⛔ Transcription failed: ${e.message}",
                 index
@@ -285,27 +580,90 @@ class MainScreenViewModel(private val app: Application) : ViewModel() {
         transcribeJobRef.set(job)
     }
 
-    private suspend fun transcribeAudio(file: File, index: Int = -1) {
+    private suspend fun transcribeAudio(
+        load: suspend () -> FloatBuffer,
+        index: Int = -1,
+        transcribe: (suspend (FloatBuffer) -> String)? = null,
+        melKey: String? = null
+    ) {
         val ctx = whisperCtx ?: run {
             addResultLog("⛔ Model not loaded", index)
             return
         }
+        activeTranscriptions.incrementAndGet()
         canTranscribe = false
+        var decision: WhisperThermalScheduler.Decision? = null
+        var pooledRun = transcribe != null  // ctx's run stats do not describe this job
         try {
-            val samples = withContext(Dispatchers.IO) { decodeWaveFile(file) }
-            if (samples.isEmpty()) {
-                addResultLog("⛔ No audio samples", index)
-                return
+            if (transcribe == null) decision = thermal.apply(ctx)
+            var start = System.currentTimeMillis()
+            // "auto": a recording's language is detected once, then passed explicitly.
+            var lang = if (selectedLanguage == "auto") melKey?.let(ctx::cachedLanguage) ?: selectedLanguage else selectedLanguage
+            // Same recording again (other language / task): no WAV decode, no mel.
+            val retained = if (transcribe == null && melKey != null) {
+                ctx.transcribeRetained(melKey, lang, translateToEnglish, params = decodeParams)
+            } else null
+            // whisper_full() detected the language on the retained mel: keep it for the next run.
+            if (retained != null && melKey != null && lang == "auto") {
+                ctx.getLastLanguage()?.takeIf { it != "auto" }?.let { code ->
+                    ctx.rememberLanguage(melKey, code)
+                    lang = code
+                }
+            }
+            val text = retained ?: run {
+                val samples = withContext(Dispatchers.IO) { load() }
+                if (!samples.hasRemaining()) {
+                    addResultLog("⛔ No audio samples", index)
+                    return
+                }
+                start = System.currentTimeMillis()
+                // Long memos: show each 30 s window's segments as soon as they are decoded.
+                val live = transcribe == null && samples.remaining() > LIVE_SEGMENTS_MIN_SAMPLES
+                val draft = draftCtx.takeIf { melKey == null }
+                if (transcribe == null && melKey != null) lang = ctx.resolveLanguage(lang, samples, melKey)
+                // Meetings / archive: chunked across the pool even when started on the main context.
+                val chunked = if (transcribe == null && samples.remaining() >= LONG_FORM_MIN_SAMPLES) {
+                    transcribeLongPooled(samples, lang)?.also { pooledRun = true }
+                } else null
+                when {
+                    chunked != null -> chunked
+                    transcribe != null -> transcribe(samples)
+                    live -> {
+                        ctx.transcribeFlow(samples, lang, translateToEnglish, decodeParams, melKey = melKey)
+                            .collect { seg -> addResultLog("▸ [${seg.startMs / 1000}s] ${seg.text.trim()}", index) }
+                        ""  // already logged segment by segment
+                    }
+                    draft != null -> {
+                        // Tiny transcript while the selected model runs beside it.
+                        var final = ""
+                        WhisperDraftPair(draft, ctx)
+                            .transcribe(samples, selectedLanguage, translateToEnglish, decodeParams)
+                            .collect { pass ->
+                                val text = pass.segments.toTranscript()
+                                if (pass.final) final = text
+                                else addResultLog("✏️ Draft (${pass.elapsedMs} ms)\n$text", index)
+                            }
+                        final
+                    }
+                    else -> ctx.transcribeData(
+                        samples, lang, translateToEnglish, params = decodeParams, melKey = melKey
+                    )
+                }
             }
-            val start = System.currentTimeMillis()
-            val text = ctx.transcribeData(samples, selectedLanguage, translateToEnglish)
-                ?: "(no result)"
             val elapsed = System.currentTimeMillis() - start
+            val stats = if (!pooledRun) ctx.getLastRunStats() else null
+            stats?.let { Log.i(TAG, "Run stats: ${it.toMap()}") }
+            stats?.let(thermal::record)
+            val ctxNote = stats?.let { st ->
+                val a = st.audioCtx
+                ", enc=${st.encodeMs.toInt()} ms, RTF=${"%.2f".format(st.realTimeFactor)}" +
+                    ", audio_ctx=${a.used}" + if (a.fellBack) " (retried from ${a.initial})" else ""
+            }.orEmpty()
             addResultLog(
                 """
-                ✅ Transcribed (${elapsed} ms)
+                ✅ Transcribed (${elapsed} ms$ctxNote${if (retained != null) ", retained mel" else ""})
                 Model: $selectedModel
-                Lang: $selectedLanguage${if (translateToEnglish) "→en" else ""}
+                Lang: ${if (lang != selectedLanguage) "$selectedLanguage ($lang)" else lang}${if (translateToEnglish) "→en" else ""}
                 $text
                 """.trimIndent(), index
             )
@@ -313,8 +671,39 @@ class MainScreenViewModel(private val app: Application) : ViewModel() {
             Log.e(TAG, "Transcribe failed", e)
             addResultLog("⛔ Transcribe failed: ${e.message}", index)
         } finally {
-            canTranscribe = true
+            if (activeTranscriptions.decrementAndGet() == 0) canTranscribe = true
+        }
+        decision?.let(::adjustModelTier)
+    }
+
+    /**
+     * Model tier between jobs: still throttling at the lowest thread setting
+     * steps one rung down [MODEL_LADDER] on entering the highest level, and
+     * again only after a further cool-down period there. The user's own
+     * model comes back once the level has stayed below the highest for a
+     * cool-down period too, so a brief dip does not trigger a heavy reload.
+     */
+    private fun adjustModelTier(decision: WhisperThermalScheduler.Decision) {
+        val now = SystemClock.elapsedRealtime()
+        if (!decision.downgrade) {
+            thermalDowngradeAtMs = 0L
+            if (selectedModel == userModel) {
+                thermalCoolSinceMs = 0L
+                return
+            }
+            if (thermalCoolSinceMs == 0L) thermalCoolSinceMs = now
+            if (now - thermalCoolSinceMs < WhisperThermalScheduler.COOL_DOWN_MS) return
+            thermalCoolSinceMs = 0L
+            addToastLog("🌡️ Device cooler: back to $userModel")
+            switchModel(userModel)
+            return
         }
+        thermalCoolSinceMs = 0L
+        if (thermalDowngradeAtMs != 0L && now - thermalDowngradeAtMs < WhisperThermalScheduler.COOL_DOWN_MS) return
+        val smaller = WhisperThermalScheduler.smallerModel(selectedModel, MODEL_LADDER) ?: return
+        thermalDowngradeAtMs = now
+        addToastLog("🌡️ Device hot: switching to $smaller")
+        switchModel(smaller)
     }
 
     // ---------------------------------------------------------------------
@@ -324,6 +713,7 @@ class MainScreenViewModel(private val app: Application) : ViewModel() {
     fun playRecording(path: String, index: Int) = viewModelScope.launch {
         if (isRecording) return@launch
         val f = File(path)
+        awaitArchive(f)
         if (!f.exists()) {
             addResultLog("⛔ Missing: ${f.name}", index)
             return@launch
@@ -401,6 +791,11 @@ class MainScreenViewModel(private val app: Application) : ViewModel() {
     // Filesystem & Cleanup
     // ---------------------------------------------------------------------
 
+    /** Waits until a just-stopped recording's WAV is on disk (see [pendingArchives]). */
+    private suspend fun awaitArchive(file: File) {
+        pendingArchives[file.path]?.join()
+    }
+
     private suspend fun createNewAudioFile(): File {
         val ts = SimpleDateFormat("yyyyMMdd_HHmmss_SSS", Locale.US).format(Date())
         return File(recDir, "rec_$ts.wav")
@@ -411,6 +806,12 @@ class MainScreenViewModel(private val app: Application) : ViewModel() {
     }
 
     private suspend fun releaseWhisper() = withContext(Dispatchers.IO) {
+        poolMutex.withLock {
+            poolIdleRelease?.cancel()
+            poolIdleRelease = null
+            freePoolLocked()
+        }
+        withContext(draftDispatcher) { releaseDraftLocked() }
         runCatching { whisperCtx?.release() }
         whisperCtx = null
     }
@@ -429,6 +830,7 @@ class MainScreenViewModel(private val app: Application) : ViewModel() {
                 releaseWhisper()
                 releaseMediaPlayer()
                 runCatching { recorder.close() }
+                runCatching { draftDispatcher.close() }
             }
         }
     }
@@ -21,6 +21,9 @@ android {
     defaultConfig {
         minSdk = 26
 
+        // Benchmarks: ./gradlew :nativelib:connectedDebugAndroidTest (see src/androidTest)
+        testInstrumentationRunner = "androidx.test.runner.AndroidJUnitRunner"
+
         // ABI filter
         ndk {
             abiFilters += listOf("arm64-v8a")
@@ -34,7 +37,9 @@ android {
             cmake {
                 arguments(
                     "-DANDROID_STL=c++_shared",
-                    project.findProperty("GGML_HOME")?.let { "-DGGML_HOME=$it" } ?: "-DGGML_HOME="
+                    project.findProperty("GGML_HOME")?.let { "-DGGML_HOME=$it" } ?: "-DGGML_HOME=",
+                    // -PWHISPER_BENCH=ON also enables bench natives in release builds
+                    "-DWHISPER_BENCH=${project.findProperty("WHISPER_BENCH") ?: "OFF"}"
                 )
             }
         }
@@ -44,6 +49,9 @@ android {
         debug {
             isMinifyEnabled = false
             buildConfigField("boolean", "JNI_DEBUG", "true")
+            externalNativeBuild {
+                cmake { arguments("-DWHISPER_BENCH=ON") }
+            }
         }
         release {
             isMinifyEnabled = false
@@ -77,6 +85,10 @@ android {
             java.srcDirs("src/main/java", "src/main/kotlin")
             jniLibs.srcDirs("src/main/jniLibs")
         }
+        getByName("androidTest") {
+            // Benchmark corpus + the app's bundled models (models/*.bin)
+            assets.srcDirs("src/androidTest/assets", rootProject.file("app/src/main/assets"))
+        }
     }
 
     externalNativeBuild {
@@ -0,0 +1,119 @@
+// file: com/whispercpp/whisper/bench/BenchCorpus.kt
+// ============================================================
+// ✅ BenchCorpus — Fixed 16 kHz benchmark clips
+// ------------------------------------------------------------
+// • Manifest: assets/corpus/corpus.json (versioned)
+// • Seeded clips synthesized bit-exactly: voiced syllables, word gaps, pauses
+// • Optional real recordings: 16 kHz WAVs next to the manifest
+// ============================================================
+
+package com.whispercpp.whisper.bench
+
+import android.content.Context
+import com.whispercpp.whisper.WhisperAudio
+import org.json.JSONObject
+import java.io.File
+import java.util.Random
+import kotlin.math.PI
+import kotlin.math.abs
+
+/** One corpus clip: mono float PCM at [BenchCorpus.SAMPLE_RATE]. */
+internal class BenchClip(val name: String, val pcm: FloatArray) {
+    val seconds: Double get() = pcm.size.toDouble() / BenchCorpus.SAMPLE_RATE
+}
+
+internal object BenchCorpus {
+
+    const val SAMPLE_RATE = 16_000
+    private const val MANIFEST = "corpus/corpus.json"
+
+    /** Manifest version; reports with different versions are not comparable. */
+    fun version(context: Context): Int = manifest(context).getInt("version")
+
+    /** All clips of the manifest, in manifest order. */
+    fun load(context: Context): List<BenchClip> {
+        val clips = manifest(context).getJSONArray("clips")
+        return List(clips.length()) { i ->
+            val c = clips.getJSONObject(i)
+            val name = c.getString("name")
+            val pcm = if (c.has("file")) readWav(context, "corpus/" + c.getString("file"))
+            else synthesize(c.getInt("seconds"), c.getLong("seed"))
+            BenchClip(name, pcm)
+        }
+    }
+
+    private fun manifest(context: Context): JSONObject =
+        JSONObject(context.assets.open(MANIFEST).bufferedReader().use { it.readText() })
+
+    private fun readWav(context: Context, asset: String): FloatArray {
+        val tmp = File(context.cacheDir, asset.substringAfterLast('/'))
+        context.assets.open(asset).use { input -> tmp.outputStream().use { input.copyTo(it) } }
+        val buf = WhisperAudio.decode(tmp, SAMPLE_RATE)
+        return FloatArray(buf.remaining()).also { buf.get(it) }
+    }
+
+    /**
+     * Speech-like test signal, identical on every device and run for a seed:
+     * phrases of 4–10 voiced syllables (glottal pulse train through two
+     * formant resonators, Hann envelope), 30–120 ms word gaps and 0.3–0.8 s
+     * pauses, over a −60 dB noise floor. Exercises mel, encoder, decoder and
+     * VAD without shipping recordings; the decoded text is not meaningful.
+     * StrictMath keeps the samples identical across devices / ART versions.
+     */
+    fun synthesize(seconds: Int, seed: Long): FloatArray {
+        val rnd = Random(seed)
+        val out = FloatArray(seconds * SAMPLE_RATE)
+        var pos = 0
+        while (pos < out.size) {
+            repeat(4 + rnd.nextInt(7)) {
+                pos = syllable(out, pos, rnd)
+                pos += ms(30 + rnd.nextInt(91))
+            }
+            pos += ms(300 + rnd.nextInt(501))
+        }
+        var peak = 0f
+        for (i in out.indices) {
+            out[i] += (rnd.nextGaussian() * 1e-3).toFloat()
+            peak = maxOf(peak, abs(out[i]))
+        }
+        if (peak > 0f) for (i in out.indices) out[i] *= 0.5f / peak
+        return out
+    }
+
+    /** Writes one syllable at [start]; returns the position after it. */
+    private fun syllable(out: FloatArray, start: Int, rnd: Random): Int {
+        val len = ms(150 + rnd.nextInt(151))
+        val f0 = 100.0 + 120.0 * rnd.nextDouble()
+        val f1 = Resonator(300.0 + 500.0 * rnd.nextDouble(), 80.0)
+        val f2 = Resonator(900.0 + 1600.0 * rnd.nextDouble(), 120.0)
+        var phase = 0.0
+        for (k in 0 until len) {
+            val i = start + k
+            if (i >= out.size) return out.size
+            // Slight pitch glide over the syllable.
+            phase += (f0 * (1.0 - 0.1 * k / len)) / SAMPLE_RATE
+            val pulse = if (phase >= 1.0) { phase -= 1.0; 1.0 } else 0.0
+            val env = StrictMath.sin(PI * k / len).let { it * it }
+            out[i] += (env * (f1.step(pulse) + 0.5 * f2.step(pulse))).toFloat()
+        }
+        return start + len
+    }
+
+    private fun ms(v: Int): Int = v * SAMPLE_RATE / 1000
+
+    /** Two-pole resonator at [freq] Hz with bandwidth [bw] Hz. */
+    private class Resonator(freq: Double, bw: Double) {
+        private val r = StrictMath.exp(-PI * bw / SAMPLE_RATE)
+        private val a1 = 2.0 * r * StrictMath.cos(2.0 * PI * freq / SAMPLE_RATE)
+        private val a2 = -r * r
+        private var y1 = 0.0
+        private var y2 = 0.0
+
+        fun step(x: Double): Double {
+            val y = (1.0 - r) * x + a1 * y1 + a2 * y2
+            y2 = y1
+            y1 = y
+            return y
+        }
+    }
+}
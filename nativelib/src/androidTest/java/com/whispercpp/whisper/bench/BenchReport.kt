@@ -0,0 +1,113 @@
+// file: com/whispercpp/whisper/bench/BenchReport.kt
+// ============================================================
+// ✅ BenchReport — JSON results for cross-commit / cross-variant comparison
+// ------------------------------------------------------------
+// • One file per suite: <suite>-<variant>.json (meta + results[])
+// • Meta: commit, .so variant, CPU features, device, SDK, model, corpus version
+// • Written to the AGP additional test output dir when available
+//   (pulled into build/outputs/connected_android_test_additional_output),
+//   else to the test APK's external files dir
+// • Instrumentation args: model=<asset path>, commit=<sha>, runs=<n>
+// ============================================================
+
+package com.whispercpp.whisper.bench
+
+import android.os.Build
+import android.util.Log
+import androidx.test.platform.app.InstrumentationRegistry
+import com.whispercpp.whisper.WhisperCpuFeatures
+import com.whispercpp.whisper.WhisperLib
+import org.json.JSONArray
+import org.json.JSONObject
+import org.junit.Assume
+import java.io.File
+
+private const val LOG_TAG = "WhisperBench"
+
+internal class BenchReport(private val suite: String) {
+
+    private val results = JSONArray()
+
+    /** Adds one measurement row; null metrics are omitted. */
+    fun add(name: String, vararg metrics: Pair<String, Any?>) {
+        val row = JSONObject().put("name", name)
+        for ((k, v) in metrics) if (v != null) row.put(k, v)
+        results.put(row)
+        Log.i(LOG_TAG, "$suite/$row")
+    }
+
+    /** Writes the report; returns the file. */
+    fun write(): File {
+        val json = JSONObject()
+            .put("suite", suite)
+            .put("meta", meta())
+            .put("results", results)
+        val file = File(outputDir(), "$suite-${WhisperLib.loadedVariant}.json")
+        file.writeText(json.toString(2))
+        Log.i(LOG_TAG, "Report: ${file.absolutePath}")
+        return file
+    }
+
+    companion object {
+
+        private val args get() = InstrumentationRegistry.getArguments()
+
+        /** Context of the test APK (holds the corpus and model assets). */
+        val context get() = InstrumentationRegistry.getInstrumentation().context
+
+        /** Model under test (asset path); `-e model models/ggml-base-q5_1.bin`. */
+        val modelAsset: String get() = args.getString("model") ?: "models/ggml-tiny-q5_1.bin"
+
+        /** Repetitions for steady-state numbers; `-e runs 5`. */
+        val runs: Int get() = args.getString("runs")?.toIntOrNull()?.coerceAtLeast(1) ?: 5
+
+        /**
+         * Skips the suite unless [modelAsset] is a real model: a checkout
+         * without Git LFS objects only has ~130-byte pointer files.
+         */
+        fun assumeModel() {
+            val bytes = runCatching { context.assets.openFd(modelAsset).use { it.length } }
+                .getOrElse { runCatching { context.assets.open(modelAsset).use { it.available().toLong() } }.getOrDefault(0L) }
+            Assume.assumeTrue("Model $modelAsset missing or an LFS pointer ($bytes bytes)", bytes > 1L shl 20)
+        }
+
+        fun meta(): JSONObject = JSONObject()
+            .put("commit", args.getString("commit") ?: "")
+            .put("variant", WhisperLib.loadedVariant)
+            .put("features", WhisperCpuFeatures.features.toString())
+            .put("abi", WhisperCpuFeatures.abi)
+            .put("device", "${Build.MANUFACTURER} ${Build.MODEL}")
+            .put("soc", if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.S) Build.SOC_MODEL else Build.HARDWARE)
+            .put("sdk", Build.VERSION.SDK_INT)
+            .put("model", modelAsset)
+            .put("corpus", BenchCorpus.version(context))
+            .put("runs", runs)
+            .put("timestamp", System.currentTimeMillis())
+
+        private fun outputDir(): File {
+            val dir = args.getString("additionalTestOutputDir")?.let(::File)
+                ?: File(context.getExternalFilesDir(null), "whisper-bench")
+            return dir.apply { mkdirs() }
+        }
+
+        /** Wall time of [block] in ms. */
+        inline fun timeMs(block: () -> Unit): Double {
+            val t0 = System.nanoTime()
+            block()
+            return (System.nanoTime() - t0) / 1e6
+        }
+
+        fun median(xs: List<Double>): Double {
+            if (xs.isEmpty()) return -1.0
+            val s = xs.sorted()
+            return if (s.size % 2 == 1) s[s.size / 2] else (s[s.size / 2 - 1] + s[s.size / 2]) / 2
+        }
+
+        /** A /proc/self/status field in kB (VmRSS, VmHWM), or -1. */
+        fun procStatusKb(key: String): Long =
+            File("/proc/self/status").useLines { lines ->
+                lines.firstOrNull { it.startsWith("$key:") }
+                    ?.substringAfter(':')?.trim()?.substringBefore(' ')?.toLongOrNull()
+            } ?: -1L
+    }
+}
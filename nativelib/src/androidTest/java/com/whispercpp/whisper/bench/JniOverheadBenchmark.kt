@@ -0,0 +1,84 @@
+// file: com/whispercpp/whisper/bench/JniOverheadBenchmark.kt
+// ============================================================
+// ✅ JniOverheadBenchmark — Cost per JNI crossing on the result path
+// ------------------------------------------------------------
+// • getTextSegmentCount / getTextSegment / T0 / T1: ns per call
+// • Per-segment getters vs one packed getAllSegments() per result
+// • Measured on the JNI thread over the 30 s corpus clip's result
+// ============================================================
+
+package com.whispercpp.whisper.bench
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import com.whispercpp.whisper.WhisperContext
+import com.whispercpp.whisper.WhisperLib
+import com.whispercpp.whisper.bench.BenchReport.Companion.context
+import com.whispercpp.whisper.bench.BenchReport.Companion.median
+import com.whispercpp.whisper.bench.BenchReport.Companion.modelAsset
+import kotlinx.coroutines.runBlocking
+import org.junit.AfterClass
+import org.junit.Assume
+import org.junit.BeforeClass
+import org.junit.Test
+import org.junit.runner.RunWith
+
+@RunWith(AndroidJUnit4::class)
+class JniOverheadBenchmark {
+
+    companion object {
+        private const val CALLS = 20_000
+        private const val ROUNDS = 5
+
+        private val report = BenchReport("jni-overhead")
+        private lateinit var ctx: WhisperContext
+
+        @BeforeClass
+        @JvmStatic
+        fun transcribe() {
+            BenchReport.assumeModel()
+            val clips = BenchCorpus.load(context)
+            val clip = clips.firstOrNull { it.seconds >= 30.0 } ?: clips.maxBy { it.pcm.size }
+            ctx = WhisperContext.createContextFromAsset(context.assets, modelAsset)
+            runBlocking { ctx.transcribeData(clip.pcm, "en", false) }
+        }
+
+        @AfterClass
+        @JvmStatic
+        fun release() {
+            if (::ctx.isInitialized) runBlocking { ctx.release() }
+            report.write()
+        }
+    }
+
+    @Test
+    fun segmentGetters() = runBlocking {
+        val n = ctx.withHandle { WhisperLib.getTextSegmentCount(it) }
+        Assume.assumeTrue("No segments decoded", n > 0)
+        report.add("getTextSegmentCount", "ns_per_call" to perCall { WhisperLib.getTextSegmentCount(it) })
+        report.add("getTextSegment", "ns_per_call" to perCall { WhisperLib.getTextSegment(it, 0) })
+        report.add("getTextSegmentT0", "ns_per_call" to perCall { WhisperLib.getTextSegmentT0(it, 0) })
+        report.add("getTextSegmentT1", "ns_per_call" to perCall { WhisperLib.getTextSegmentT1(it, 0) })
+
+        // Whole result: 1 + 3n crossings vs one packed buffer.
+        report.add("result_per_segment_getters", "segments" to n, "ns_per_result" to perCall(CALLS / 100) { p ->
+            for (i in 0 until WhisperLib.getTextSegmentCount(p)) {
+                WhisperLib.getTextSegment(p, i)
+                WhisperLib.getTextSegmentT0(p, i)
+                WhisperLib.getTextSegmentT1(p, i)
+            }
+        })
+        report.add("result_packed", "segments" to n, "ns_per_result" to perCall(CALLS / 100) { p ->
+            WhisperLib.getAllSegments(p, false)
+        })
+    }
+
+    /** Median over [ROUNDS] of the mean ns per [block] call, on the JNI thread. */
+    private suspend fun perCall(calls: Int = CALLS, block: (Long) -> Any?): Double = ctx.withHandle { p ->
+        repeat(calls / 10) { block(p) }  // JIT / cache warm-up
+        median(List(ROUNDS) {
+            val t0 = System.nanoTime()
+            repeat(calls) { block(p) }
+            (System.nanoTime() - t0).toDouble() / calls
+        })
+    }
+}
@@ -0,0 +1,109 @@
+// file: com/whispercpp/whisper/bench/ModelLoadBenchmark.kt
+// ============================================================
+// ✅ ModelLoadBenchmark — Load time + RSS per model loader
+// ------------------------------------------------------------
+// • File (extracted copy, mmap), asset (mapped APK entry), InputStream
+// • Asset via the model cache: cold load vs warm hit
+// • Model cache emptied before each cold load; the page cache cannot be
+//   dropped without root, so the first run is reported separately
+// ============================================================
+
+package com.whispercpp.whisper.bench
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import com.whispercpp.whisper.WhisperContext
+import com.whispercpp.whisper.WhisperModelCache
+import com.whispercpp.whisper.WhisperModelStore
+import com.whispercpp.whisper.bench.BenchReport.Companion.context
+import com.whispercpp.whisper.bench.BenchReport.Companion.median
+import com.whispercpp.whisper.bench.BenchReport.Companion.modelAsset
+import com.whispercpp.whisper.bench.BenchReport.Companion.procStatusKb
+import com.whispercpp.whisper.bench.BenchReport.Companion.runs
+import com.whispercpp.whisper.bench.BenchReport.Companion.timeMs
+import kotlinx.coroutines.runBlocking
+import org.junit.AfterClass
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+
+@RunWith(AndroidJUnit4::class)
+class ModelLoadBenchmark {
+
+    companion object {
+        private val report = BenchReport("model-load")
+
+        @AfterClass
+        @JvmStatic
+        fun writeReport() {
+            report.write()
+        }
+    }
+
+    @Before
+    fun setUp() {
+        BenchReport.assumeModel()
+        WhisperModelCache.trim(0L)
+    }
+
+    @Test
+    fun file() {
+        val file = runBlocking { WhisperModelStore.extract(context, modelAsset) }
+        measure("file") { WhisperContext.createContextFromFile(file.path) }
+    }
+
+    @Test
+    fun asset() = measure("asset") {
+        WhisperContext.createContextFromAsset(context.assets, modelAsset)
+    }
+
+    @Test
+    fun inputStream() = measure("input_stream") {
+        context.assets.open(modelAsset).use { WhisperContext.createContextFromInputStream(it) }
+    }
+
+    @Test
+    fun assetCachedCold() = measure("asset_cached_cold") {
+        WhisperContext.createContextFromAssetCached(context.assets, modelAsset)
+    }
+
+    @Test
+    fun assetCachedWarm() {
+        // Prime once; every measured run is a cache hit.
+        runBlocking { WhisperContext.createContextFromAssetCached(context.assets, modelAsset).release() }
+        measure("asset_cached_warm", coldEachRun = false) {
+            WhisperContext.createContextFromAssetCached(context.assets, modelAsset)
+        }
+    }
+
+    /**
+     * Loads [runs] + 1 times, releasing after each. Reports the first load,
+     * the median / min / max of the rest, the native load time and the
+     * largest resident-set growth across a load.
+     */
+    private fun measure(name: String, coldEachRun: Boolean = true, load: () -> WhisperContext) {
+        val times = ArrayList<Double>()
+        val nativeMs = ArrayList<Double>()
+        var rssKb = 0L
+        repeat(runs + 1) {
+            if (coldEachRun) WhisperModelCache.trim(0L)
+            val before = procStatusKb("VmRSS")
+            lateinit var ctx: WhisperContext
+            times += timeMs { ctx = load() }
+            rssKb = maxOf(rssKb, procStatusKb("VmRSS") - before)
+            runBlocking {
+                ctx.getLastRunStats()?.let { nativeMs += it.loadMs }
+                ctx.release()
+            }
+        }
+        val steady = times.drop(1)
+        report.add(
+            name,
+            "first_ms" to times.first(),
+            "median_ms" to median(steady),
+            "min_ms" to steady.min(),
+            "max_ms" to steady.max(),
+            "native_median_ms" to median(nativeMs.drop(1)),
+            "rss_delta_kb" to rssKb
+        )
+    }
+}
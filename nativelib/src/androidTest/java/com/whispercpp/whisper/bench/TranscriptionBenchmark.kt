@@ -0,0 +1,109 @@
+// file: com/whispercpp/whisper/bench/TranscriptionBenchmark.kt
+// ============================================================
+// ✅ TranscriptionBenchmark — Latency / RTF / memory over the corpus
+// ------------------------------------------------------------
+// • First run after load (cold caches, no warm-up) on the shortest clip
+// • Per clip: one warm-up, then median of `runs` transcriptions
+// • Native stage timings + peak RSS from WhisperRunStats, VmHWM
+// • Segment count / text hash: a latency shift with a changed hash means
+//   the decoder produced different output, not just ran slower
+// ============================================================
+
+package com.whispercpp.whisper.bench
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import com.whispercpp.whisper.WhisperContext
+import com.whispercpp.whisper.WhisperRunStats
+import com.whispercpp.whisper.bench.BenchReport.Companion.context
+import com.whispercpp.whisper.bench.BenchReport.Companion.median
+import com.whispercpp.whisper.bench.BenchReport.Companion.modelAsset
+import com.whispercpp.whisper.bench.BenchReport.Companion.procStatusKb
+import com.whispercpp.whisper.bench.BenchReport.Companion.runs
+import com.whispercpp.whisper.bench.BenchReport.Companion.timeMs
+import kotlinx.coroutines.runBlocking
+import org.junit.AfterClass
+import org.junit.Assert.assertTrue
+import org.junit.BeforeClass
+import org.junit.FixMethodOrder
+import org.junit.Test
+import org.junit.runner.RunWith
+import org.junit.runners.MethodSorters
+import java.nio.FloatBuffer
+
+@RunWith(AndroidJUnit4::class)
+@FixMethodOrder(MethodSorters.NAME_ASCENDING)
+class TranscriptionBenchmark {
+
+    companion object {
+        private val report = BenchReport("transcription")
+        private lateinit var ctx: WhisperContext
+        private lateinit var clips: List<BenchClip>
+
+        @BeforeClass
+        @JvmStatic
+        fun load() {
+            BenchReport.assumeModel()
+            clips = BenchCorpus.load(context)
+            ctx = WhisperContext.createContextFromAsset(context.assets, modelAsset)
+        }
+
+        @AfterClass
+        @JvmStatic
+        fun release() {
+            if (::ctx.isInitialized) runBlocking { ctx.release() }
+            report.write()
+        }
+    }
+
+    /** Runs first (name order): nothing has touched the weights or buffers yet. */
+    @Test
+    fun a_firstRun() = runBlocking {
+        val clip = clips.minBy { it.pcm.size }
+        val buffer = direct(clip)
+        val ms = timeMs { ctx.transcribeData(buffer.duplicate(), "en", false) }
+        report.add("first/${clip.name}", "latency_ms" to ms, "rtf" to ms / (clip.seconds * 1000), *stats(ctx.getLastRunStats()))
+    }
+
+    @Test
+    fun b_steadyState() = runBlocking {
+        for (clip in clips) {
+            val buffer = direct(clip)
+            ctx.transcribeData(buffer.duplicate(), "en", false)  // warm-up
+            val times = ArrayList<Double>()
+            var last: WhisperRunStats? = null
+            repeat(runs) {
+                times += timeMs { ctx.transcribeData(buffer.duplicate(), "en", false) }
+                last = ctx.getLastRunStats()
+            }
+            val segments = ctx.getSegments()
+            val latency = median(times)
+            report.add(
+                "steady/${clip.name}",
+                "audio_s" to clip.seconds,
+                "latency_ms" to latency,
+                "min_ms" to times.min(),
+                "max_ms" to times.max(),
+                "rtf" to latency / (clip.seconds * 1000),
+                "segments" to segments.size,
+                "text_hash" to segments.joinToString("") { it.text }.hashCode(),
+                "vm_hwm_kb" to procStatusKb("VmHWM"),
+                *stats(last)
+            )
+            assertTrue("latency must be positive", latency > 0.0)
+        }
+    }
+
+    private fun direct(clip: BenchClip): FloatBuffer =
+        WhisperContext.allocateAudioBuffer(clip.pcm.size).apply { put(clip.pcm); flip() }
+
+    private fun stats(s: WhisperRunStats?): Array<Pair<String, Any?>> = if (s == null) emptyArray() else arrayOf(
+        "mel_ms" to s.melMs,
+        "encode_ms" to s.encodeMs,
+        "decode_ms" to s.decodeMs,
+        "encode_passes" to s.encodePasses,
+        "fallbacks" to s.fallbacks,
+        "threads" to s.threads,
+        "peak_rss_delta_bytes" to s.peakRssDeltaBytes,
+        "compute_buffer_bytes" to s.computeBufferBytes
+    )
+}
@@ -3,23 +3,43 @@
 // ✅ WhisperContext — JNI-safe, Coroutine-isolated, Debug-stable
 // ------------------------------------------------------------
 // • Serializes all JNI/whisper.cpp calls onto a dedicated single thread
-// • Runtime ABI + CPU feature detection to choose an optimized .so
+// • Runtime HWCAP detection (getauxval) to choose the fastest .so variant
 // • Clear lifecycle: init → transcribe → release → dispatcher close
 // • Re-entrancy guard to avoid overlapping whisper_full() calls
 // • Rich logging for diagnosability and production forensics
 // • Works with three model sources: File / Asset / InputStream
+// • Live sliding-window sessions via WhisperStream
+// • Big.LITTLE-aware pinning of ggml workers (WhisperThreadPolicy)
+// • Optional VAD pre-pass to skip silence (WhisperVadConfig)
+// • Keep-alive asset model cache with LRU eviction (WhisperModelCache)
+// • warmUp(): first-touch costs paid right after load, not on first utterance
+// • Per-call decoding strategy: greedy / beam, fallback, limits (WhisperDecodeParams)
+// • transcribeFlow(): segments + progress delivered while whisper_full() runs
+// • getLastRunStats(): structured per-run telemetry (WhisperRunStats)
+// • transcribeRetained(): re-decode the last clip's log-mel (no WAV decode / mel)
+// • Reused buffers: PCM (audioBuffer), FloatArray staging, native result arena
+// • Draft-then-refine over two models (WhisperDraftPair, getLastLanguage())
+// • Language detection once per session / recording (detectLanguage, resolveLanguage)
+// • Token / word timing from one run: getTokens(), getWords(), DTW alignment heads
 // ============================================================
 
 package com.whispercpp.whisper
 
 import android.content.res.AssetManager
-import android.os.Build
 import android.util.Log
 import kotlinx.coroutines.*
+import kotlinx.coroutines.channels.Channel
+import kotlinx.coroutines.flow.Flow
+import kotlinx.coroutines.flow.buffer
+import kotlinx.coroutines.flow.channelFlow
 import java.io.File
 import java.io.InputStream
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.FloatBuffer
 import java.util.concurrent.Executors
 import java.util.concurrent.atomic.AtomicBoolean
+import java.util.concurrent.atomic.AtomicInteger
 import kotlin.math.max
 import kotlin.math.min
 
@@ -35,16 +55,23 @@ private const val LOG_TAG = "WhisperJNI"
  * - The dispatcher’s thread is created once and closed on release().
  *
  * Cancellation notes:
- * - `whisper_full()` is a blocking native call. Suspending callers can be
- *   cancelled, but the native computation continues until completion. If you
- *   need early aborts, wire a native-side abort hook (not included here).
+ * - `whisper_full()` is a blocking native call. Cancelling a suspended caller
+ *   of [transcribeData] or [WhisperStream.poll] aborts that caller's own run
+ *   (see `requestAbort`), which whisper/ggml poll between graph nodes, so the
+ *   JNI thread is freed within one compute step instead of after the full run.
+ *   A caller still queued behind another run is dropped from the queue; the
+ *   run in progress is not touched.
  *
  * Threading:
  * - All JNI calls (init/transcribe/free/bench) run on the same single thread.
  * - This avoids subtle data races in ggml working buffers and allocator.
+ * - For concurrent jobs over one set of weights use [WhisperPool]: each pool
+ *   worker is a state context ([parent] != null) with its own JNI thread and
+ *   `whisper_state`, sharing the parent's model.
  */
 class WhisperContext private constructor(
-    private var ptr: Long
+    @Volatile private var ptr: Long,
+    private val parent: WhisperContext? = null
 ) {
 
     // ------------------------------------------------------------
@@ -71,6 +98,41 @@ class WhisperContext private constructor(
     /** Re-entrancy guard to prevent overlapping transcriptions on the same ctx. */
     private val busy = AtomicBoolean(false)
 
+    /** Orders requestAbort() from arbitrary threads against native free in release(). */
+    private val abortLock = Any()
+
+    /** Source of per-call abort tokens (never 0; see [withAbortOnCancel]). */
+    private val abortTokens = AtomicInteger(0)
+
+    /** Token of the [withAbortOnCancel] call running on the JNI thread, 0 when none (guarded by [abortLock]). */
+    private var activeAbortToken = 0
+
+    /** Reusable PCM buffer handed out by [audioBuffer]; grows to the longest clip. */
+    private var pcmArena: FloatBuffer? = null
+    private val pcmArenaLock = Any()
+
+    /** Copy target for [transcribeData] over a FloatArray (JNI thread only). */
+    private var staging: FloatBuffer? = null
+
+    /** Current view of the native result arena (JNI thread only; see getAllSegmentsArena). */
+    private var resultView: ByteBuffer? = null
+
+    /** Detected language per session / recording key (see [resolveLanguage]). */
+    private val languages = WhisperLanguageCache()
+
+    /** Live state contexts created over this model (released before the weights). */
+    private val states = mutableSetOf<WhisperContext>()
+
+    /** Worker count used by whisper_full(); follows the active [WhisperThreadPolicy]. */
+    @Volatile
+    var threadCount: Int = WhisperCpuConfig.preferredThreadCount
+        private set
+
+    init {
+        // First job on the JNI thread: pin it (and thus every ggml worker) to the big cores.
+        scope.launch { applyThreadPolicy(WhisperThreadPolicy.DEFAULT) }
+    }
+
     // ------------------------------------------------------------
     // Transcription API
     // ------------------------------------------------------------
@@ -81,50 +143,493 @@ class WhisperContext private constructor(
      * Contract:
      * - Executes on the dedicated JNI thread (never the caller thread).
      * - Not re-entrant: throws if a previous call is still running.
+     * - Cancellable: cancelling the caller aborts the native run early.
      * - Returns concatenated segments; optionally appends timestamps.
      *
      * @param data Float PCM samples normalized to [-1.0, 1.0]
      * @param lang Language code ("en", "ja", "sw") or "auto" for auto-detect
      * @param translate If true, runs translation-to-English mode
      * @param printTimestamp Append per-segment [t0 - t1] after each line
+     * @param params Decoding strategy / limits; null = greedy defaults
      */
     suspend fun transcribeData(
         data: FloatArray,
         lang: String,
         translate: Boolean,
-        printTimestamp: Boolean = true
-    ): String = withContext(scope.coroutineContext) {
-        check(ptr != 0L) { "WhisperContext: already released (ptr == 0)" }
-        // Enforce single active whisper_full() per context.
-        if (!busy.compareAndSet(false, true)) {
-            throw IllegalStateException("Transcription already in progress on this WhisperContext")
+        printTimestamp: Boolean = true,
+        params: WhisperDecodeParams? = null
+    ): String = withAbortOnCancel {
+        withNative {
+            // One copy into a direct buffer reused across calls (the direct
+            // entry points never pin or copy the Java array).
+            val need = maxOf(data.size, 1)
+            val buffer = staging?.takeIf { it.capacity() >= need }
+                ?: allocateAudioBuffer(growCapacity(staging?.capacity() ?: 0, need)).also { staging = it }
+            buffer.clear()
+            buffer.put(data).flip()
+            if (!buffer.hasRemaining()) return@withNative ""
+            runDirect(buffer, lang, translate, params)
+            collectText(printTimestamp)
         }
-        try {
-            val numThreads = WhisperCpuConfig.preferredThreadCount
-            Log.i(LOG_TAG, "Transcribe start: threads=$numThreads lang=$lang translate=$translate, samples=${data.size}")
-
-            // JNI → whisper_full()
-            WhisperLib.fullTranscribe(ptr, lang, numThreads, translate, data)
-
-            // Gather decoded segments
-            val n = WhisperLib.getTextSegmentCount(ptr)
-            buildString(capacity = n * 32) {
-                for (i in 0 until n) {
-                    append(WhisperLib.getTextSegment(ptr, i))
-                    if (printTimestamp) {
-                        val t0 = WhisperLib.getTextSegmentT0(ptr, i)
-                        val t1 = WhisperLib.getTextSegmentT1(ptr, i)
-                        append(" [${toTimestamp(t0)} - ${toTimestamp(t1)}]\n")
-                    } else {
-                        append('\n')
+    }
+
+    /**
+     * This context's reusable direct PCM buffer, grown to hold at least
+     * [samples] (never shrunk); returned cleared. Pass it as a decoder's
+     * `allocate` hook, e.g. `WhisperAudio.decode(file, allocate = ctx::audioBuffer)`,
+     * so back-to-back dictation decodes into the same memory every time.
+     *
+     * The buffer is shared: do not refill it while a transcription on this
+     * context still reads it. After growth, earlier buffers simply stop
+     * being reused (they stay valid until garbage-collected).
+     */
+    fun audioBuffer(samples: Int): FloatBuffer = synchronized(pcmArenaLock) {
+        require(samples >= 0) { "samples must be >= 0" }
+        val cur = pcmArena
+        val buf = if (cur != null && cur.capacity() >= samples) cur
+        else allocateAudioBuffer(growCapacity(cur?.capacity() ?: 0, maxOf(samples, 1))).also {
+            pcmArena = it
+            Log.d(LOG_TAG, "PCM buffer grown to ${it.capacity()} samples")
+        }
+        buf.clear()
+        buf
+    }
+
+    /**
+     * Zero-copy variant of [transcribeData] reading samples in place from a
+     * direct [FloatBuffer] (see [allocateAudioBuffer]).
+     *
+     * Reads `buffer.remaining()` samples starting at `buffer.position()`;
+     * the buffer's position/limit are not modified. The buffer must not be
+     * written to until this call returns.
+     *
+     * @param buffer Direct, native-order FloatBuffer of PCM normalized to [-1.0, 1.0]
+     * @param params Decoding strategy / limits; null = greedy defaults
+     * @param melKey Retain this clip's log-mel under this key for [transcribeRetained]
+     *   (see [melKeyFor]); ignored with the model VAD ([WhisperVadConfig] model path)
+     */
+    suspend fun transcribeData(
+        buffer: FloatBuffer,
+        lang: String,
+        translate: Boolean,
+        printTimestamp: Boolean = true,
+        params: WhisperDecodeParams? = null,
+        melKey: String? = null
+    ): String = withAbortOnCancel {
+        withNative {
+            require(buffer.isDirect) { "transcribeData(FloatBuffer) requires a direct buffer" }
+            if (!buffer.hasRemaining()) return@withNative ""
+            runDirect(buffer, lang, translate, params)
+            if (melKey != null) retainMel(melKey)
+            collectText(printTimestamp)
+        }
+    }
+
+    /**
+     * Re-decodes the clip whose log-mel this context retained under [melKey]
+     * (other language, task or params) without its PCM: the WAV decode and
+     * mel computation are skipped. The encoder still runs; stock whisper.cpp
+     * cannot be handed a cached encoder output.
+     *
+     * The mel lives in this context's `whisper_state` (no extra memory) and
+     * is dropped as soon as anything else runs here: another clip, a stream,
+     * [warmUp] or [benchModel].
+     *
+     * @return the transcript, or null if [melKey] is no longer retained
+     */
+    suspend fun transcribeRetained(
+        melKey: String,
+        lang: String,
+        translate: Boolean,
+        printTimestamp: Boolean = true,
+        params: WhisperDecodeParams? = null
+    ): String? = withAbortOnCancel {
+        withNative {
+            val numThreads = threadCount
+            val rc = if (params == null) {
+                WhisperLib.fullTranscribeRetained(ptr, 0L, melKey, lang, numThreads, translate)
+            } else {
+                params.useNative { h -> WhisperLib.fullTranscribeRetained(ptr, h, melKey, lang, numThreads, translate) }
+            }
+            when (rc) {
+                0 -> collectText(printTimestamp)
+                1 -> null
+                else -> error("Re-decoding retained mel failed")
+            }
+        }
+    }
+
+    /** True if [transcribeRetained] would find [melKey] on this context. */
+    suspend fun hasRetainedMel(melKey: String): Boolean = withNative(exclusive = false) {
+        WhisperLib.melRetained(ptr, melKey)
+    }
+
+    /** Labels the last run's log-mel; JNI thread only. */
+    private fun retainMel(melKey: String) {
+        if (!WhisperLib.melRetain(ptr, melKey)) Log.d(LOG_TAG, "Mel not retained (model VAD or failed run)")
+    }
+
+    /**
+     * Like [transcribeData], but emits each segment as soon as whisper
+     * commits it (after every 30 s window) instead of after the whole clip.
+     *
+     * The flow is cold: collecting starts the run, cancelling the collector
+     * aborts it. Completes after the last segment; afterwards [getSegments]
+     * returns the same result.
+     *
+     * @param buffer Direct, native-order FloatBuffer of PCM normalized to [-1.0, 1.0]
+     * @param params Decoding strategy / limits; null = greedy defaults
+     * @param onProgress Called with 0…100 on the transcribing thread (keep it cheap)
+     * @param melKey Retain the log-mel for [transcribeRetained] (see [transcribeData])
+     */
+    fun transcribeFlow(
+        buffer: FloatBuffer,
+        lang: String,
+        translate: Boolean,
+        params: WhisperDecodeParams? = null,
+        onProgress: ((Int) -> Unit)? = null,
+        melKey: String? = null
+    ): Flow<WhisperSegment> = channelFlow {
+        val listener = object : WhisperNativeListener {
+            override fun onSegment(index: Int, t0: Long, t1: Long, utf8: ByteArray) {
+                trySend(WhisperSegment(String(utf8, Charsets.UTF_8), t0, t1))
+            }
+
+            override fun onProgress(percent: Int) {
+                onProgress?.invoke(percent)
+            }
+        }
+        withAbortOnCancel {
+            withNative {
+                require(buffer.isDirect) { "transcribeFlow requires a direct buffer" }
+                if (!buffer.hasRemaining()) return@withNative
+                check(WhisperLib.setListener(ptr, listener)) { "Failed to install result listener" }
+                try {
+                    runDirect(buffer, lang, translate, params)
+                    if (melKey != null) retainMel(melKey)
+                } finally {
+                    WhisperLib.setListener(ptr, null)
+                }
+            }
+        }
+    }.buffer(Channel.UNLIMITED)
+
+    /** Runs whisper_full() over buffer's remaining samples. JNI thread only. */
+    private fun runDirect(buffer: FloatBuffer, lang: String, translate: Boolean, params: WhisperDecodeParams?) {
+        val numThreads = threadCount
+        val n = buffer.remaining()
+        Log.i(LOG_TAG, "Transcribe start (direct): threads=$numThreads lang=$lang translate=$translate, samples=$n")
+        if (params == null) {
+            WhisperLib.fullTranscribeDirect(ptr, lang, numThreads, translate, buffer, buffer.position(), n)
+        } else {
+            Log.d(LOG_TAG, "Decode params: $params")
+            params.useNative { h ->
+                WhisperLib.fullTranscribeWithParams(ptr, h, lang, numThreads, translate, buffer, buffer.position(), n)
+            }
+        }
+    }
+
+    /**
+     * Encoder context chosen for the most recent run on this context
+     * (see [WhisperDecodeParams.autoAudioCtx]); zeros if nothing was encoded.
+     */
+    suspend fun getLastAudioCtx(): WhisperAudioCtx = withNative(exclusive = false) {
+        val a = WhisperLib.getLastAudioCtx(ptr)
+        if (a == null || a.size < 2) WhisperAudioCtx(0, 0) else WhisperAudioCtx(a[0], a[1])
+    }
+
+    /**
+     * Telemetry of this context's load and its most recent transcription:
+     * stage timings, sampling / fallback counts, peak RSS, buffer sizes,
+     * threads and library variant. Also traced as ATrace sections
+     * (`whisper:load`, `whisper:vad`, `whisper:full`) for Perfetto.
+     *
+     * @return stats, or null if the native record is unavailable
+     */
+    suspend fun getLastRunStats(): WhisperRunStats? = withNative(exclusive = false) {
+        WhisperRunStats.decode(WhisperLib.getLastRunStats(ptr), WhisperLib.loadedVariant)
+    }
+
+    /**
+     * Language of the most recent transcription: the requested code, or the
+     * detected one for "auto".
+     *
+     * @return ISO code ("en", "ja", …), or null before the first result
+     */
+    suspend fun getLastLanguage(): String? = withNative(exclusive = false) {
+        WhisperLib.getLastLanguage(ptr)
+    }
+
+    /**
+     * Spoken-language probabilities of the first [seconds] of [buffer],
+     * without transcribing it: one encoder pass and one decoder step, the
+     * cost "auto" otherwise adds to every [transcribeData].
+     *
+     * Replaces a retained log-mel (see [transcribeRetained]); the last
+     * transcription result is kept. Reads from `buffer.position()` and does
+     * not modify the buffer.
+     *
+     * @param buffer Direct, native-order FloatBuffer of 16 kHz PCM
+     * @param topK number of candidates to return
+     * @return up to [topK] languages, most probable first; empty for an
+     *   English-only model, empty audio or a failed pass
+     */
+    suspend fun detectLanguage(
+        buffer: FloatBuffer,
+        seconds: Float = WhisperLanguage.DETECT_SECONDS,
+        topK: Int = 3
+    ): List<WhisperLanguage> = withNative {
+        require(buffer.isDirect) { "detectLanguage requires a direct buffer" }
+        val n = min(buffer.remaining(), (seconds * 16_000).toInt())
+        if (n <= 0) return@withNative emptyList()
+        val pairs = WhisperLib.detectLanguage(ptr, buffer, buffer.position(), n, threadCount, topK)
+            ?: return@withNative emptyList()
+        List(pairs.size / 2) { i ->
+            WhisperLanguage(WhisperLib.getLanguageCode(pairs[2 * i].toInt()) ?: "", pairs[2 * i + 1])
+        }.filter { it.code.isNotEmpty() }
+    }
+
+    /**
+     * Resolves [lang] for a transcription of [buffer]: an explicit code is
+     * returned as is; for "auto" the language cached under [key] (a session
+     * or recording, e.g. [melKeyFor]) or, on a miss, [detectLanguage] on the
+     * clip's first seconds. Pass the result to [transcribeData] so repeated
+     * runs over the same source skip whisper's detection pass.
+     *
+     * A detection below [WhisperLanguage.MIN_PROBABILITY] is not trusted:
+     * "auto" is returned (whisper_full() then detects on its own window)
+     * and nothing is cached.
+     */
+    suspend fun resolveLanguage(lang: String, buffer: FloatBuffer, key: String? = null): String {
+        if (lang != "auto") return lang
+        key?.let { languages[it] }?.let { return it }
+        val top = detectLanguage(buffer).firstOrNull()
+        if (top == null || top.probability < WhisperLanguage.MIN_PROBABILITY) {
+            Log.i(LOG_TAG, "Language unresolved (${top?.code} p=${top?.probability}); keeping auto")
+            return lang
+        }
+        if (key != null) languages[key] = top.code
+        return top.code
+    }
+
+    /** Language cached under [key] by [resolveLanguage] / [rememberLanguage], or null. */
+    fun cachedLanguage(key: String): String? = languages[key]
+
+    /** Caches [code] for [key], e.g. [getLastLanguage] after an "auto" run. */
+    fun rememberLanguage(key: String, code: String) {
+        languages[key] = code
+    }
+
+    /** Drops [key]'s language (the session ended, or the speaker switched language). */
+    fun forgetLanguage(key: String) {
+        languages.remove(key)
+    }
+
+    /** Last run's segments via the native result arena (one crossing, no Java array). JNI thread only. */
+    private fun packedSegments(withTokenProbs: Boolean): List<WhisperSegment> {
+        val view = WhisperLib.getAllSegmentsArena(ptr, withTokenProbs, resultView)
+            ?: return decodePackedSegments(WhisperLib.getAllSegments(ptr, withTokenProbs))
+        resultView = view
+        return decodePackedSegments(view)
+    }
+
+    /** Formats the last run's segments (single packed JNI crossing). JNI thread only. */
+    private fun collectText(printTimestamp: Boolean): String {
+        val segments = packedSegments(false)
+        return formatTranscript(segments, printTimestamp).also {
+            Log.i(LOG_TAG, "Transcribe complete: segments=${segments.size} chars=${it.length}")
+        }
+    }
+
+    /**
+     * Returns the segments of the most recent run on this context.
+     *
+     * @param withTokenProbs Also fetch per-token probabilities
+     */
+    suspend fun getSegments(withTokenProbs: Boolean = false): List<WhisperSegment> =
+        withNative(exclusive = false) { packedSegments(withTokenProbs) }
+
+    /**
+     * Returns every token of the most recent run (one packed JNI crossing):
+     * id, text, probability and timing from the same whisper_full() pass.
+     *
+     * t0 / t1 need [WhisperDecodeParams.tokenTimestamps] on that run; the
+     * DTW time needs a model loaded after [setAlignmentHeads]. Missing
+     * times are -1.
+     *
+     * @param includeSpecial Keep timestamp / control tokens
+     */
+    suspend fun getTokens(includeSpecial: Boolean = false): List<WhisperToken> =
+        withNative(exclusive = false) { decodePackedTokens(WhisperLib.getAllTokens(ptr, includeSpecial)) }
+
+    /**
+     * Word-level timing of the most recent run ([getTokens] grouped by
+     * [toWords]), e.g. for subtitles, without a second max_len = 1 decode.
+     */
+    suspend fun getWords(): List<WhisperWord> = getTokens().toWords()
+
+    // ------------------------------------------------------------
+    // Streaming API
+    // ------------------------------------------------------------
+
+    /**
+     * Opens a live transcription session over this context.
+     *
+     * The session decodes a sliding window of at most [lengthMs] every [stepMs]
+     * of new audio and commits segments that end before the trailing [keepMs].
+     * See [WhisperStream] for the push/poll contract.
+     *
+     * @param lang Language code or "auto"
+     * @param translate If true, runs translation-to-English mode
+     * @param stepMs New audio required before the next decode
+     * @param lengthMs Maximum decoded window (≤ 30 000)
+     * @param keepMs Trailing audio kept uncommitted and re-decoded next step
+     */
+    suspend fun createStream(
+        lang: String,
+        translate: Boolean = false,
+        stepMs: Int = 3_000,
+        lengthMs: Int = 10_000,
+        keepMs: Int = 200
+    ): WhisperStream = withNative(exclusive = false) {
+        check(parent == null) { "Streams require a model context, not a pool state" }
+        check(WhisperLib.hasDefaultState(ptr)) {
+            "Streams require the model's default state; another handle on this cached model holds it"
+        }
+        val numThreads = threadCount
+        val handle = WhisperLib.streamCreate(ptr, lang, numThreads, translate, stepMs, lengthMs, keepMs)
+        check(handle != 0L) { "Failed to create stream session" }
+        Log.i(LOG_TAG, "Stream created: step=$stepMs len=$lengthMs keep=$keepMs lang=$lang")
+        WhisperStream(this@WhisperContext, handle)
+    }
+
+    /**
+     * Runs [block] on the JNI thread with the raw native handle, for
+     * in-module diagnostics (e.g. per-call JNI overhead benchmarks).
+     */
+    internal suspend fun <T> withHandle(block: (Long) -> T): T =
+        withNative(exclusive = false) { block(ptr) }
+
+    /**
+     * Runs [block] on the dedicated JNI thread with a live native pointer.
+     *
+     * @param exclusive If true, holds the re-entrancy guard so no other
+     *                  exclusive call can overlap (required around whisper_full()).
+     */
+    internal suspend fun <T> withNative(exclusive: Boolean = true, block: () -> T): T =
+        withContext(scope.coroutineContext) {
+            check(ptr != 0L) { "WhisperContext: already released (ptr == 0)" }
+            // Enforce single active whisper_full() per context.
+            if (exclusive && !busy.compareAndSet(false, true)) {
+                throw IllegalStateException("Transcription already in progress on this WhisperContext")
+            }
+            try {
+                block()
+            } finally {
+                if (exclusive) busy.set(false)
+            }
+        }
+
+    /**
+     * Runs [block] in [scope] under a fresh abort token and aborts the native
+     * run if the caller is cancelled.
+     *
+     * The caller resumes with [CancellationException] immediately. A call
+     * still queued is cancelled before it starts; a call already on the JNI
+     * thread has its own token aborted, so its whisper_full() unwinds shortly
+     * after and no other call's run is affected.
+     */
+    internal suspend fun <T> withAbortOnCancel(block: suspend () -> T): T =
+        suspendCancellableCoroutine { cont ->
+            val resumed = AtomicBoolean(false)
+            val token = abortTokens.incrementAndGet().takeIf { it != 0 } ?: abortTokens.incrementAndGet()
+            val job = scope.launch {
+                val result = runCatching {
+                    armAbort(token)
+                    try { block() } finally { armAbort(0) }
+                }
+                // Ignored by the continuation once it is cancelled.
+                if (resumed.compareAndSet(false, true)) cont.resumeWith(result)
+            }
+            // Covers a scope already cancelled by release(): the body never runs.
+            job.invokeOnCompletion { cause ->
+                if (cause != null && resumed.compareAndSet(false, true)) {
+                    cont.resumeWith(Result.failure(cause))
+                }
+            }
+            cont.invokeOnCancellation {
+                job.cancel()  // still queued: never starts
+                synchronized(abortLock) {
+                    val p = ptr
+                    if (p != 0L && activeAbortToken == token) {
+                        WhisperLib.requestAbort(p, token)
+                        Log.i(LOG_TAG, "Cancellation → native abort requested")
                     }
                 }
-            }.also {
-                Log.i(LOG_TAG, "Transcribe complete: segments=$n chars=${it.length}")
             }
-        } finally {
-            busy.set(false)
         }
+
+    /** Publishes [token] as the running call's (0 = none), natively and for [withAbortOnCancel]. */
+    private fun armAbort(token: Int) {
+        synchronized(abortLock) {
+            val p = ptr
+            if (p != 0L) WhisperLib.setAbortToken(p, token)
+            activeAbortToken = token
+        }
+    }
+
+    // ------------------------------------------------------------
+    // VAD pre-pass
+    // ------------------------------------------------------------
+
+    /**
+     * Enables or disables silence skipping for subsequent [transcribeData] calls.
+     *
+     * With VAD on, only detected speech regions are encoded. Returned segment
+     * timestamps still refer to the original audio, and an all-silence clip
+     * yields no segments without running the model. Streams are unaffected.
+     */
+    suspend fun setVad(config: WhisperVadConfig) = withNative(exclusive = false) {
+        val p = ptr
+        if (p == 0L) return@withNative
+        WhisperLib.setVad(
+            p, config.mode.native, config.modelPath,
+            config.thresholdDb, config.speechProbability,
+            config.minSpeechMs, config.minSilenceMs, config.padMs
+        )
+        Log.i(LOG_TAG, "VAD configured: $config")
+    }
+
+    // ------------------------------------------------------------
+    // Thread policy
+    // ------------------------------------------------------------
+
+    /**
+     * Pins this context's compute thread (and the ggml workers it spawns) to
+     * the cores selected by [policy] and adopts its thread count.
+     *
+     * ggml creates its workers inside each whisper_full() from the calling
+     * thread, and Linux threads inherit the creator's affinity and nice value,
+     * so the policy is re-applied natively before every run. Worker spin /
+     * poll behaviour stays at ggml's defaults: stock whisper.cpp does not
+     * accept an external ggml threadpool.
+     *
+     * @return number of CPUs in the applied mask
+     */
+    suspend fun setThreadPolicy(policy: WhisperThreadPolicy): Int = withNative(exclusive = false) {
+        applyThreadPolicy(policy)
+    }
+
+    /** Runs on the JNI thread. */
+    private fun applyThreadPolicy(policy: WhisperThreadPolicy): Int {
+        val p = ptr
+        if (p == 0L) return 0
+        val cores = policy.cores()
+        val applied = WhisperLib.setThreadPolicy(p, cores, policy.nice ?: Int.MIN_VALUE)
+        threadCount = policy.threadCount(cores)
+        Log.i(LOG_TAG, "Thread policy ${policy.affinity}: cores=${cores.contentToString()} " +
+                "mask=$applied threads=$threadCount nice=${policy.nice}")
+        return applied
     }
 
     // ------------------------------------------------------------
@@ -145,6 +650,66 @@ class WhisperContext private constructor(
     suspend fun benchGgmlMulMat(nThreads: Int): String =
         withContext(scope.coroutineContext) { WhisperLib.benchGgmlMulMat(nThreads) }
 
+    /**
+     * Benchmarks this model on silence at thread counts 1, 2, 4, … [maxThreads].
+     *
+     * Each result averages [runs] passes (after one warm-up) of: log-mel of 30 s,
+     * one encoder pass, 256 single-token / 64 batched / one 256-token prompt
+     * decode, as reported by `whisper_get_timings`.
+     *
+     * Always available (does not require WHISPER_BENCH). Overwrites the
+     * context's last transcription result.
+     *
+     * @return one [WhisperBenchResult] per thread count, or empty on failure
+     */
+    suspend fun benchModel(
+        maxThreads: Int = threadCount,
+        runs: Int = 3
+    ): List<WhisperBenchResult> {
+        require(maxThreads >= 1) { "maxThreads must be >= 1" }
+        require(runs >= 1) { "runs must be >= 1" }
+        check(parent == null) { "benchModel requires a model context, not a pool state" }
+        return withNative {
+            check(WhisperLib.hasDefaultState(ptr)) {
+                "benchModel requires the model's default state; another handle on this cached model holds it"
+            }
+            WhisperBenchResult.decode(WhisperLib.benchModel(ptr, maxThreads, runs))
+        }
+    }
+
+    /**
+     * Runs the encoder and a short decode once on silence, so that the first
+     * real transcription starts with faulted-in compute buffers and ramped-up
+     * cores instead of paying those costs while the user waits.
+     *
+     * Call right after loading, off the UI path. Queues ahead of later jobs
+     * on this context; the last transcription result is not affected.
+     *
+     * @return warm-up duration in ms, or -1 on failure
+     */
+    suspend fun warmUp(): Int = withNative { WhisperLib.warmUp(ptr, threadCount) }
+
+    // ------------------------------------------------------------
+    // Shared-weight states (see WhisperPool)
+    // ------------------------------------------------------------
+
+    /**
+     * Creates an independent decoding context over this model's weights.
+     *
+     * The result has its own JNI thread and `whisper_state` (KV cache and
+     * compute buffers, tens of MB) but no copy of the weights. It inherits
+     * this context's VAD setting and is released automatically, at the
+     * latest, when this context is released.
+     */
+    internal suspend fun createStateContext(): WhisperContext {
+        check(parent == null) { "Cannot create a state from a pool state" }
+        val handle = withNative(exclusive = false) { WhisperLib.stateCreate(ptr) }
+        check(handle != 0L) { "whisper_init_state() failed" }
+        return WhisperContext(handle, parent = this).also { child ->
+            synchronized(states) { states += child }
+        }
+    }
+
     // ------------------------------------------------------------
     // Lifecycle
     // ------------------------------------------------------------
@@ -159,13 +724,22 @@ class WhisperContext private constructor(
      *   tear down the backing Executor thread. Subsequent calls are no-ops.
      */
     suspend fun release() {
+        // 0) States borrow our weights: free them first.
+        val children = synchronized(states) { states.toList().also { states.clear() } }
+        children.forEach { it.release() }
+        parent?.let { p -> synchronized(p.states) { p.states -= this } }
+
         // 1) Free native on the JNI thread
         withContext(scope.coroutineContext) {
             if (ptr != 0L) {
-                runCatching { WhisperLib.freeContext(ptr) }
-                    .onSuccess { Log.d(LOG_TAG, "Released native context (ptr=$ptr)") }
-                    .onFailure { e -> Log.e(LOG_TAG, "Error releasing native context", e) }
-                ptr = 0L
+                synchronized(abortLock) {
+                    val p = ptr
+                    ptr = 0L
+                    resultView = null  // viewed the freed arena
+                    runCatching { WhisperLib.freeContext(p) }
+                        .onSuccess { Log.d(LOG_TAG, "Released native context (ptr=$p)") }
+                        .onFailure { e -> Log.e(LOG_TAG, "Error releasing native context", e) }
+                }
             } else {
                 Log.w(LOG_TAG, "Release called on an already freed context")
             }
@@ -183,7 +757,8 @@ class WhisperContext private constructor(
     @Suppress("deprecation")
     protected fun finalize() {
         try {
-            if (ptr != 0L) {
+            // A state must never outlive its weights; if the parent is gone, leak instead.
+            if (ptr != 0L && (parent == null || parent.ptr != 0L)) {
                 Log.w(LOG_TAG, "finalize(): native context still alive; forcing release()")
                 runBlocking { release() }
             }
@@ -199,7 +774,9 @@ class WhisperContext private constructor(
     companion object {
 
         /**
-         * Create a context from a filesystem path (fastest; mmap-capable).
+         * Create a context from a filesystem path (fastest: the file is
+         * mmap()ed and read sequentially, no APK / zip layer). See
+         * [WhisperModelStore] for extracting a bundled model once.
          */
         fun createContextFromFile(filePath: String): WhisperContext {
             require(filePath.isNotBlank()) { "filePath must not be blank" }
@@ -212,6 +789,11 @@ class WhisperContext private constructor(
         /**
          * Create a context by streaming model bytes from an InputStream.
          * The stream may be network-backed or decrypted-on-the-fly.
+         *
+         * A native thread reads ahead in 1–8 MB blocks while the weights
+         * are parsed, so the stream needs no BufferedInputStream wrapper and
+         * must not be touched by other code until this returns. The caller
+         * still owns (and closes) [stream].
          */
         fun createContextFromInputStream(stream: InputStream): WhisperContext {
             val ptr = WhisperLib.initContextFromInputStream(stream)
@@ -221,16 +803,80 @@ class WhisperContext private constructor(
         }
 
         /**
-         * Create a context from an Android asset (AAsset streaming; low-RAM).
+         * Create a context from an Android asset.
+         *
+         * Prefers mapping the APK entry directly (requires the asset to be stored
+         * uncompressed); native code falls back to AAsset streaming otherwise.
          */
         fun createContextFromAsset(assetManager: AssetManager, assetPath: String): WhisperContext {
             require(assetPath.isNotBlank()) { "assetPath must not be blank" }
-            val ptr = WhisperLib.initContextFromAsset(assetManager, assetPath)
+            val ptr = WhisperLib.initContextFromAssetMapped(assetManager, assetPath)
             require(ptr != 0L) { "Failed to create context from asset: $assetPath" }
             Log.i(LOG_TAG, "WhisperContext created from asset: $assetPath")
             return WhisperContext(ptr)
         }
 
+        /**
+         * Like [createContextFromAsset], but served from the process-wide
+         * [WhisperModelCache]: a recently used model is returned without
+         * reloading its weights. [release] hands the model back to the cache.
+         * While another handle on the same model is alive the new one gets a
+         * private decoder state: it transcribes normally, but [createStream]
+         * and [benchModel] need the default state and fail on it.
+         */
+        fun createContextFromAssetCached(assetManager: AssetManager, assetPath: String): WhisperContext {
+            require(assetPath.isNotBlank()) { "assetPath must not be blank" }
+            val ptr = WhisperLib.initContextFromAssetCached(assetManager, assetPath)
+            require(ptr != 0L) { "Failed to create context from asset: $assetPath" }
+            Log.i(LOG_TAG, "WhisperContext acquired from model cache: $assetPath")
+            return WhisperContext(ptr)
+        }
+
+        /**
+         * Like [createContextFromFile], but served from the process-wide
+         * [WhisperModelCache] (keyed by sampled content hash, so an extracted
+         * copy shares the entry of its asset).
+         * [release] hands the model back to the cache.
+         */
+        fun createContextFromFileCached(filePath: String): WhisperContext {
+            require(filePath.isNotBlank()) { "filePath must not be blank" }
+            val ptr = WhisperLib.initContextFromFileCached(filePath)
+            require(ptr != 0L) { "Failed to create context from file: $filePath" }
+            Log.i(LOG_TAG, "WhisperContext acquired from model cache: $filePath")
+            return WhisperContext(ptr)
+        }
+
+        /**
+         * Allocates a direct, native-order FloatBuffer for [transcribeData].
+         * Intended to be reused across calls to avoid large heap arrays.
+         */
+        fun allocateAudioBuffer(samples: Int): FloatBuffer {
+            require(samples >= 0) { "samples must be >= 0" }
+            return ByteBuffer.allocateDirect(samples * Float.SIZE_BYTES)
+                .order(ByteOrder.nativeOrder())
+                .asFloatBuffer()
+        }
+
+        /** Next capacity for a reused buffer: at least [need], ≥ 1.5× [current] to limit regrowth. */
+        internal fun growCapacity(current: Int, need: Int): Int =
+            maxOf(need, (current + current / 2).coerceAtMost(Int.MAX_VALUE / Float.SIZE_BYTES))
+
+        /**
+         * Key for [transcribeData]'s `melKey` identifying a recording by
+         * path, size and modification time (changes when the file is rewritten).
+         */
+        fun melKeyFor(file: File): String = "${file.absolutePath}:${file.length()}:${file.lastModified()}"
+
+        /**
+         * Alignment heads for DTW token timestamps of models loaded from now
+         * on (cached models included; they are keyed by the preset). Use
+         * [WhisperAlignmentHeads.forModel] for the model file; [NONE][WhisperAlignmentHeads.NONE]
+         * turns DTW off. DTW adds a small cost per decoded segment.
+         */
+        fun setAlignmentHeads(heads: WhisperAlignmentHeads) {
+            check(WhisperLib.setDtwPreset(heads.native)) { "Alignment heads $heads not supported" }
+        }
+
         /** Returns GGML/whisper system info string from native. */
         fun getSystemInfo(): String = WhisperLib.getSystemInfo()
     }
@@ -242,12 +888,28 @@ class WhisperContext private constructor(
 // Loads an appropriate native .so and exposes JNI entry points.
 // The JNI signatures must match the C code exactly.
 // ============================================================
-private class WhisperLib {
+/**
+ * Native result listener (see `setListener` in whisperLib.c).
+ * Called on the JNI thread while whisper_full() runs; must not block.
+ */
+internal interface WhisperNativeListener {
+    /** Segment [index] was committed; [utf8] is its text, times in 10 ms ticks. */
+    fun onSegment(index: Int, t0: Long, t1: Long, utf8: ByteArray)
+
+    /** Whole-run progress, 0…100. */
+    fun onProgress(percent: Int)
+}
+
+internal class WhisperLib {
     companion object {
+        /** Name of the loaded library variant (declared before init so it is not reset). */
+        var loadedVariant: String = ""
+            private set
+
         init {
-            // Try to load an optimized ABI-specific binary first, then fall back.
-            val abi = Build.SUPPORTED_ABIS.firstOrNull().orEmpty()
-            val feats = cpuInfo().orEmpty()
+            // Try the fastest variant this CPU supports (getauxval-based), then fall back.
+            val abi = WhisperCpuFeatures.abi
+            val feats = WhisperCpuFeatures.features
 
             fun tryLoad(name: String): Boolean = try {
                 System.loadLibrary(name); true
@@ -256,16 +918,10 @@ private class WhisperLib {
                 false
             }
 
-            val loaded =
-                // ARMv8.2-A + FP16 (half-precision SIMD) → asimdhp/fphp/fp16
-                (isArm64(abi) && hasFp16(feats) && tryLoad("whisper_v8fp16_va")) ||
-                        // ARMv7-A + VFPv4
-                        (isArmv7(abi) && hasVfpv4(feats) && tryLoad("whisper_vfpv4")) ||
-                        // Generic fallback (portable CPU path)
-                        tryLoad("whisper")
-
-            if (loaded) {
-                Log.i(LOG_TAG, "Native whisper library loaded (ABI=$abi, fp16=${hasFp16(feats)}, vfpv4=${hasVfpv4(feats)})")
+            val loaded = WhisperCpuFeatures.variantCandidates().firstOrNull { tryLoad(it) }
+            if (loaded != null) {
+                loadedVariant = loaded
+                Log.i(LOG_TAG, "Native whisper library loaded: lib$loaded.so (ABI=$abi, $feats)")
             } else {
                 error("Failed to load any native whisper library")
             }
@@ -274,49 +930,70 @@ private class WhisperLib {
         // -------- JNI method declarations (must match C signatures) --------
         @JvmStatic external fun initContext(modelPath: String): Long
         @JvmStatic external fun initContextFromAsset(assetManager: AssetManager, assetPath: String): Long
+        @JvmStatic external fun initContextFromAssetMapped(assetManager: AssetManager, assetPath: String): Long
         @JvmStatic external fun initContextFromInputStream(inputStream: InputStream): Long
+        @JvmStatic external fun initContextFromAssetCached(assetManager: AssetManager, assetPath: String): Long
+        @JvmStatic external fun initContextFromFileCached(modelPath: String): Long
+        @JvmStatic external fun modelCacheSetBudget(bytes: Long)
+        @JvmStatic external fun modelCacheTrim(limitBytes: Long): Long
+        @JvmStatic external fun modelCacheStats(): LongArray?
         @JvmStatic external fun freeContext(contextPtr: Long)
+        @JvmStatic external fun hasDefaultState(contextPtr: Long): Boolean
+        @JvmStatic external fun stateCreate(contextPtr: Long): Long
+        @JvmStatic external fun setAbortToken(contextPtr: Long, token: Int)
+        @JvmStatic external fun requestAbort(contextPtr: Long, token: Int)
+        @JvmStatic external fun setThreadPolicy(contextPtr: Long, cpus: IntArray?, nice: Int): Int
+        @JvmStatic external fun setVad(contextPtr: Long, mode: Int, modelPath: String?, thresholdDb: Float, speechProbability: Float, minSpeechMs: Int, minSilenceMs: Int, padMs: Int)
         @JvmStatic external fun fullTranscribe(contextPtr: Long, lang: String, numThreads: Int, translate: Boolean, audioData: FloatArray)
+        @JvmStatic external fun fullTranscribeDirect(contextPtr: Long, lang: String, numThreads: Int, translate: Boolean, audioData: FloatBuffer, offset: Int, numSamples: Int)
+        @JvmStatic external fun fullTranscribeWithParams(contextPtr: Long, paramsPtr: Long, lang: String, numThreads: Int, translate: Boolean, audioData: FloatBuffer, offset: Int, numSamples: Int)
+        @JvmStatic external fun getLastAudioCtx(contextPtr: Long): IntArray?
+        @JvmStatic external fun getLastRunStats(contextPtr: Long): DoubleArray?
+        @JvmStatic external fun getLastLanguage(contextPtr: Long): String?
+        @JvmStatic external fun getLanguageCode(id: Int): String?
+        @JvmStatic external fun detectLanguage(contextPtr: Long, audioData: FloatBuffer, offset: Int, numSamples: Int, numThreads: Int, topK: Int): FloatArray?
+        @JvmStatic external fun melRetain(contextPtr: Long, key: String): Boolean
+        @JvmStatic external fun melRetained(contextPtr: Long, key: String): Boolean
+        @JvmStatic external fun fullTranscribeRetained(contextPtr: Long, paramsPtr: Long, key: String, lang: String, numThreads: Int, translate: Boolean): Int
+        @JvmStatic external fun paramsCreate(strategy: Int): Long
+        @JvmStatic external fun paramsSetInt(paramsPtr: Long, key: Int, value: Int): Boolean
+        @JvmStatic external fun paramsSetFloat(paramsPtr: Long, key: Int, value: Float): Boolean
+        @JvmStatic external fun paramsSetString(paramsPtr: Long, key: Int, value: String?): Boolean
+        @JvmStatic external fun paramsFree(paramsPtr: Long)
+        @JvmStatic external fun setListener(contextPtr: Long, listener: WhisperNativeListener?): Boolean
         @JvmStatic external fun getTextSegmentCount(contextPtr: Long): Int
         @JvmStatic external fun getTextSegment(contextPtr: Long, index: Int): String
         @JvmStatic external fun getTextSegmentT0(contextPtr: Long, index: Int): Long
         @JvmStatic external fun getTextSegmentT1(contextPtr: Long, index: Int): Long
+        @JvmStatic external fun getAllSegments(contextPtr: Long, withTokenProbs: Boolean): ByteArray?
+        @JvmStatic external fun getAllSegmentsArena(contextPtr: Long, withTokenProbs: Boolean, current: ByteBuffer?): ByteBuffer?
+        @JvmStatic external fun getAllTokens(contextPtr: Long, includeSpecial: Boolean): ByteArray?
+        @JvmStatic external fun setDtwPreset(preset: Int): Boolean
+        @JvmStatic external fun streamCreate(contextPtr: Long, lang: String, numThreads: Int, translate: Boolean, stepMs: Int, lengthMs: Int, keepMs: Int): Long
+        @JvmStatic external fun streamPush(streamPtr: Long, audioData: FloatArray, offset: Int, length: Int)
+        @JvmStatic external fun streamPoll(streamPtr: Long, flush: Boolean): Int
+        @JvmStatic external fun streamGetSegment(streamPtr: Long, index: Int): String
+        @JvmStatic external fun streamGetSegmentT0(streamPtr: Long, index: Int): Long
+        @JvmStatic external fun streamGetSegmentT1(streamPtr: Long, index: Int): Long
+        @JvmStatic external fun streamGetPartial(streamPtr: Long): String
+        @JvmStatic external fun streamClose(streamPtr: Long)
+        @JvmStatic external fun longformPlan(audioData: FloatBuffer, offset: Int, numSamples: Int, targetSamples: Int, overlapSamples: Int): IntArray?
+        @JvmStatic external fun decodeWaveLength(path: String, targetSampleRate: Int): Int
+        @JvmStatic external fun decodeWave(path: String, targetSampleRate: Int, dst: FloatBuffer): Int
+        @JvmStatic external fun decodeMediaLength(fd: Int, offset: Long, length: Long, targetSampleRate: Int): Int
+        @JvmStatic external fun decodeMedia(fd: Int, offset: Long, length: Long, targetSampleRate: Int, dst: FloatBuffer): Int
+        @JvmStatic external fun captureCreate(sampleRate: Int): Long
+        @JvmStatic external fun capturePush(capturePtr: Long, samples: ShortArray, offset: Int, length: Int): Long
+        @JvmStatic external fun captureLength(capturePtr: Long, targetSampleRate: Int): Int
+        @JvmStatic external fun captureRead(capturePtr: Long, targetSampleRate: Int, dst: FloatBuffer): Int
+        @JvmStatic external fun captureWriteWav(capturePtr: Long, path: String): Int
+        @JvmStatic external fun captureClose(capturePtr: Long)
         @JvmStatic external fun getSystemInfo(): String
         @JvmStatic external fun benchMemcpy(nthread: Int): String
         @JvmStatic external fun benchGgmlMulMat(nthread: Int): String
-
-        // -------- Runtime feature detection helpers --------
-
-        /** Returns raw /proc/cpuinfo contents (if available). */
-        private fun cpuInfo(): String? = try {
-            File("/proc/cpuinfo").inputStream().bufferedReader().use { it.readText() }
-        } catch (e: Exception) {
-            Log.w(LOG_TAG, "Could not read /proc/cpuinfo", e); null
-        }
-
-        /** True if ABI indicates 64-bit ARM. */
-        private fun isArm64(abi: String): Boolean = abi.equals("arm64-v8a", ignoreCase = true)
-
-        /** True if ABI indicates 32-bit ARMv7. */
-        private fun isArmv7(abi: String): Boolean = abi.equals("armeabi-v7a", ignoreCase = true)
-
-        /**
-         * Detects FP16 (half-precision) SIMD support for arm64.
-         * Common tokens: "asimdhp", "fphp", "fp16".
-         */
-        private fun hasFp16(info: String): Boolean {
-            val s = info.lowercase()
-            return "asimdhp" in s || "fphp" in s || "fp16" in s
-        }
-
-        /**
-         * Detects VFPv4 on armv7. Common tokens: "vfpv4", "neon", "asimd".
-         * We require at least VFPv4 for the optimized v7 binary.
-         */
-        private fun hasVfpv4(info: String): Boolean {
-            val s = info.lowercase()
-            return "vfpv4" in s
-        }
+        @JvmStatic external fun benchModel(contextPtr: Long, maxThreads: Int, numRuns: Int): FloatArray?
+        @JvmStatic external fun warmUp(contextPtr: Long, numThreads: Int): Int
+        @JvmStatic external fun quantizeModel(srcPath: String, dstPath: String, ftype: Int, keepEncoder: Boolean): Int
     }
 }
 
@@ -324,6 +1001,19 @@ private class WhisperLib {
 // Utility functions (pure Kotlin)
 // ============================================================
 
+/** One line per segment, optionally followed by " [t0 - t1]" (the transcribeData format). */
+internal fun formatTranscript(segments: List<WhisperSegment>, printTimestamp: Boolean): String =
+    buildString(capacity = segments.size * 32) {
+        for (seg in segments) {
+            append(seg.text)
+            if (printTimestamp) {
+                append(" [${toTimestamp(seg.t0)} - ${toTimestamp(seg.t1)}]\n")
+            } else {
+                append('\n')
+            }
+        }
+    }
+
 /**
  * Converts whisper segment ticks (10 ms per unit) to "hh:mm:ss.mmm".
  * Note: whisper_t0/t1 are typically in 10 ms units; this function
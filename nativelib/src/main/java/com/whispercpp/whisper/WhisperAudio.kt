@@ -0,0 +1,173 @@
+// file: com/whispercpp/whisper/WhisperAudio.kt
+// ============================================================
+// ✅ WhisperAudio — Native WAV / compressed audio decode into direct buffers
+// ------------------------------------------------------------
+// • mmap()-based RIFF parser (no Java-heap copy of the file)
+// • m4a / AAC, Opus, MP3, FLAC, … via NDK AMediaCodec, decoded in chunks
+// • PCM16 / float32 → mono (NEON), any channel count
+// • Polyphase windowed-sinc resampling to the target rate (streaming for codecs)
+// • Writes straight into the FloatBuffer handed to transcription
+// • decode(): picks the WAV or codec path from the file header
+// • allocate hook: decode into a context's reusable buffer (WhisperContext.audioBuffer)
+// ============================================================
+
+package com.whispercpp.whisper
+
+import android.os.ParcelFileDescriptor
+import android.util.Log
+import java.io.File
+import java.io.IOException
+import java.io.RandomAccessFile
+import java.nio.FloatBuffer
+
+private const val LOG_TAG = "WhisperAudio"
+
+/**
+ * Native audio decoding entry points.
+ *
+ * Thread-safe: every call is independent (no shared native state), so these
+ * may run on an IO dispatcher while a [WhisperContext] is transcribing.
+ */
+object WhisperAudio {
+
+    // Status codes mirrored from `enum audio_status` in whisperAudio.h.
+    private const val AUDIO_ERR_IO = -1
+    private const val AUDIO_ERR_MALFORMED = -2
+    private const val AUDIO_ERR_FORMAT = -3
+    private const val AUDIO_ERR_CAPACITY = -4
+    private const val AUDIO_ERR_NOMEM = -5
+    private const val AUDIO_ERR_CODEC = -6
+
+    /**
+     * Decodes any supported audio file: RIFF/WAVE through [decodeWave],
+     * everything else through [decodeMedia].
+     *
+     * @throws IOException if the file is unreadable, malformed or unsupported
+     */
+    @Throws(IOException::class)
+    fun decode(
+        file: File,
+        targetSampleRate: Int = 16_000,
+        reuse: FloatBuffer? = null,
+        allocate: (Int) -> FloatBuffer = WhisperContext::allocateAudioBuffer
+    ): FloatBuffer =
+        if (isWave(file)) decodeWave(file, targetSampleRate, reuse, allocate)
+        else decodeMedia(file, targetSampleRate, reuse, allocate)
+
+    /**
+     * Decodes a WAV file to mono float PCM at [targetSampleRate].
+     *
+     * [reuse] is refilled when it is direct and large enough; otherwise the
+     * destination comes from [allocate] (a new direct buffer by default;
+     * pass [WhisperContext.audioBuffer] to reuse a context's buffer).
+     *
+     * @return buffer with position 0 and limit = decoded sample count
+     * @throws IOException if the file is unreadable, malformed or unsupported
+     */
+    @Throws(IOException::class)
+    fun decodeWave(
+        file: File,
+        targetSampleRate: Int = 16_000,
+        reuse: FloatBuffer? = null,
+        allocate: (Int) -> FloatBuffer = WhisperContext::allocateAudioBuffer
+    ): FloatBuffer {
+        require(file.exists()) { "File not found: ${file.path}" }
+        val n = check(WhisperLib.decodeWaveLength(file.path, targetSampleRate), file)
+
+        val dst = if (reuse != null && reuse.isDirect && reuse.capacity() >= n) reuse
+        else allocate(n)
+
+        val written = check(WhisperLib.decodeWave(file.path, targetSampleRate, dst), file)
+        dst.clear()
+        dst.limit(written)
+        Log.d(LOG_TAG, "Decoded ${file.name}: samples=$written @ ${targetSampleRate}Hz")
+        return dst
+    }
+
+    /**
+     * Decodes compressed audio (m4a / AAC, Opus, MP3, FLAC, … — whatever the
+     * platform extractor and decoders support) to mono float PCM.
+     *
+     * The codec output is resampled chunk by chunk straight into the
+     * destination; no decoded copy exists on the Java heap. [reuse] is
+     * refilled when it is direct and large enough for the duration-derived
+     * bound, otherwise the destination comes from [allocate].
+     *
+     * @return buffer with position 0 and limit = decoded sample count
+     * @throws IOException if the file cannot be demuxed or decoded
+     */
+    @Throws(IOException::class)
+    fun decodeMedia(
+        file: File,
+        targetSampleRate: Int = 16_000,
+        reuse: FloatBuffer? = null,
+        allocate: (Int) -> FloatBuffer = WhisperContext::allocateAudioBuffer
+    ): FloatBuffer {
+        require(file.exists()) { "File not found: ${file.path}" }
+        return ParcelFileDescriptor.open(file, ParcelFileDescriptor.MODE_READ_ONLY).use {
+            decodeMedia(it, 0L, file.length(), targetSampleRate, reuse, file.path, allocate)
+        }
+    }
+
+    /**
+     * [decodeMedia] over an open descriptor, e.g. a `content://` import from
+     * `ContentResolver.openFileDescriptor(uri, "r")`. [fd] is not closed.
+     *
+     * @param offset / length byte range of the media inside [fd]
+     *   (length defaults to the descriptor's stat size)
+     */
+    @Throws(IOException::class)
+    fun decodeMedia(
+        fd: ParcelFileDescriptor,
+        offset: Long = 0L,
+        length: Long = fd.statSize - offset,
+        targetSampleRate: Int = 16_000,
+        reuse: FloatBuffer? = null,
+        name: String = "fd ${fd.fd}",
+        allocate: (Int) -> FloatBuffer = WhisperContext::allocateAudioBuffer
+    ): FloatBuffer {
+        if (length <= 0) throw IOException("Failed to decode $name: empty or unsized source")
+        val bound = check(WhisperLib.decodeMediaLength(fd.fd, offset, length, targetSampleRate), name)
+
+        val dst = if (reuse != null && reuse.isDirect && reuse.capacity() >= bound) reuse
+        else allocate(bound)
+
+        val written = check(WhisperLib.decodeMedia(fd.fd, offset, length, targetSampleRate, dst), name)
+        dst.clear()
+        dst.limit(written)
+        Log.d(LOG_TAG, "Decoded $name: samples=$written (bound $bound) @ ${targetSampleRate}Hz")
+        return dst
+    }
+
+    /** True when [file] starts with a RIFF/WAVE header. */
+    private fun isWave(file: File): Boolean = runCatching {
+        RandomAccessFile(file, "r").use { raf ->
+            val h = ByteArray(12)
+            raf.length() >= 12 && raf.read(h) == 12 &&
+                String(h, 0, 4, Charsets.US_ASCII) == "RIFF" &&
+                String(h, 8, 4, Charsets.US_ASCII) == "WAVE"
+        }
+    }.getOrDefault(false)
+
+    /** Maps a native status to a count or throws an [IOException] describing it. */
+    private fun check(rc: Int, file: File): Int {
+        if (rc >= 0) return rc
+        throw IOException("Failed to decode WAV ${file.path}: ${describe(rc)}")
+    }
+
+    private fun check(rc: Int, name: String): Int {
+        if (rc >= 0) return rc
+        throw IOException("Failed to decode $name: ${describe(rc)}")
+    }
+
+    /** Human-readable reason for a negative `audio_status`. */
+    internal fun describe(rc: Int): String = when (rc) {
+        AUDIO_ERR_IO -> "cannot open or map file"
+        AUDIO_ERR_MALFORMED -> "invalid RIFF/WAVE structure or empty 'data' chunk"
+        AUDIO_ERR_FORMAT -> "unsupported encoding (only PCM16 and float32 supported)"
+        AUDIO_ERR_CAPACITY -> "destination buffer too small"
+        AUDIO_ERR_NOMEM -> "out of memory"
+        AUDIO_ERR_CODEC -> "no audio track or no decoder for it"
+        else -> "error $rc"
+    }
+}
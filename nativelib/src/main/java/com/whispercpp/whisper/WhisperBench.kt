@@ -0,0 +1,56 @@
+// file: com/whispercpp/whisper/WhisperBench.kt
+// ============================================================
+// ✅ WhisperBench — Structured per-thread-count model timings
+// ------------------------------------------------------------
+// • Decodes the flat float[] rows returned by native benchModel()
+// • One row per measured thread count (1, 2, 4, … maxThreads)
+// • Used to pick thread counts / model sizes per device from data
+// ============================================================
+
+package com.whispercpp.whisper
+
+/**
+ * Averaged timings of one benchmark configuration.
+ *
+ * @property threads ggml worker threads used
+ * @property melMs log-mel spectrogram of 30 s audio
+ * @property encodeMs one encoder pass over a 30 s window
+ * @property decodeMs per single-token decoder call
+ * @property batchdMs per 5-token batched decoder call
+ * @property promptMs per 256-token prompt decoder call
+ * @property tokensPerSec single-token decode throughput
+ */
+data class WhisperBenchResult(
+    val threads: Int,
+    val melMs: Float,
+    val encodeMs: Float,
+    val decodeMs: Float,
+    val batchdMs: Float,
+    val promptMs: Float,
+    val tokensPerSec: Float
+) {
+    /** Estimated wall time of a 30 s window with ~[tokens] output tokens. */
+    fun estimateWindowMs(tokens: Int = 64): Float = melMs + encodeMs + decodeMs * tokens
+
+    companion object {
+        /** Must match BENCH_FIELDS in whisperLib.c. */
+        private const val FIELDS = 7
+
+        /** Decodes the native row-major float[] (null → empty). */
+        internal fun decode(rows: FloatArray?): List<WhisperBenchResult> {
+            if (rows == null) return emptyList()
+            return (0 until rows.size / FIELDS).map { r ->
+                val o = r * FIELDS
+                WhisperBenchResult(
+                    threads = rows[o].toInt(),
+                    melMs = rows[o + 1],
+                    encodeMs = rows[o + 2],
+                    decodeMs = rows[o + 3],
+                    batchdMs = rows[o + 4],
+                    promptMs = rows[o + 5],
+                    tokensPerSec = rows[o + 6]
+                )
+            }
+        }
+    }
+}
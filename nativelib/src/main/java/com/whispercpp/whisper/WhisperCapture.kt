@@ -0,0 +1,133 @@
+// file: com/whispercpp/whisper/WhisperCapture.kt
+// ============================================================
+// ✅ WhisperCapture — Zero-disk recording buffer (native PCM16)
+// ------------------------------------------------------------
+// • push() copies AudioRecord ShortArray chunks straight into native memory
+// • toBuffer() converts + resamples once into a direct FloatBuffer
+// • writeWav() archives the same samples off the critical path
+// • No temp PCM file, no Java-heap FloatArray of the whole clip
+// ============================================================
+
+package com.whispercpp.whisper
+
+import android.util.Log
+import java.io.Closeable
+import java.io.File
+import java.io.IOException
+import java.nio.FloatBuffer
+import java.util.concurrent.locks.ReentrantReadWriteLock
+import kotlin.concurrent.read
+import kotlin.concurrent.write
+
+private const val LOG_TAG = "WhisperCapture"
+
+/**
+ * Growable native buffer of mono PCM16 at the device [sampleRate].
+ *
+ * Typical use (recorder → transcription without touching disk):
+ * ```
+ * val capture = WhisperCapture(48_000)
+ * while (recording) capture.push(shortBuf, 0, n)
+ * val pcm = capture.toBuffer(16_000, allocate = ctx::audioBuffer)   // transcribe now
+ * launch(IO) { capture.writeWav(file) }                              // archive later
+ * ```
+ *
+ * Threading:
+ * - [push], [toBuffer] and [writeWav] may run concurrently from any threads;
+ *   the native side serializes access with its own mutex.
+ * - [close] waits for in-flight calls and makes later calls no-ops / throw.
+ *
+ * @throws IllegalStateException if the native buffer cannot be allocated
+ */
+class WhisperCapture(val sampleRate: Int) : Closeable {
+
+    private val lock = ReentrantReadWriteLock()
+    private var handle: Long = WhisperLib.captureCreate(sampleRate)
+
+    @Volatile
+    var frames: Long = 0L
+        private set
+
+    init {
+        check(handle != 0L) { "captureCreate($sampleRate) failed" }
+    }
+
+    /** Captured duration at [sampleRate]. */
+    val durationMs: Long get() = frames * 1000L / sampleRate
+
+    /**
+     * Appends PCM16 samples. No-op after [close].
+     *
+     * @throws IllegalStateException if the native buffer cannot grow
+     */
+    fun push(samples: ShortArray, offset: Int = 0, length: Int = samples.size - offset) {
+        if (length <= 0) return
+        lock.read {
+            val h = handle
+            if (h == 0L) return
+            val total = WhisperLib.capturePush(h, samples, offset, length)
+            check(total >= 0) { "capturePush failed (offset=$offset length=$length)" }
+            frames = total
+        }
+    }
+
+    /**
+     * Converts everything captured so far to mono float at [targetSampleRate].
+     *
+     * [reuse] is refilled when it is direct and large enough; otherwise the
+     * destination comes from [allocate] (a new direct buffer by default, or
+     * e.g. [WhisperContext.audioBuffer]).
+     *
+     * @return buffer with position 0 and limit = sample count
+     * @throws IOException if the capture is closed or conversion fails
+     */
+    @Throws(IOException::class)
+    fun toBuffer(
+        targetSampleRate: Int = 16_000,
+        reuse: FloatBuffer? = null,
+        allocate: (Int) -> FloatBuffer = WhisperContext::allocateAudioBuffer
+    ): FloatBuffer = lock.read {
+        val h = handle
+        if (h == 0L) throw IOException("Capture already closed")
+        val n = WhisperLib.captureLength(h, targetSampleRate)
+        if (n < 0) throw IOException("Capture conversion failed: ${WhisperAudio.describe(n)}")
+
+        val dst = if (reuse != null && reuse.isDirect && reuse.capacity() >= n) reuse
+        else allocate(maxOf(n, 1))
+
+        val written = WhisperLib.captureRead(h, targetSampleRate, dst)
+        if (written < 0) throw IOException("Capture conversion failed: ${WhisperAudio.describe(written)}")
+        dst.clear()
+        dst.limit(written)
+        dst
+    }
+
+    /**
+     * Writes the capture as a mono PCM16 WAV at [sampleRate].
+     *
+     * Written to a `.part` sibling and renamed into place: readers of [file]
+     * see either no file or the complete WAV, never a partial one.
+     *
+     * @throws IOException if the capture is closed or the file cannot be written
+     */
+    @Throws(IOException::class)
+    fun writeWav(file: File) = lock.read {
+        val h = handle
+        if (h == 0L) throw IOException("Capture already closed")
+        val part = File(file.parentFile, "${file.name}.part")
+        val rc = WhisperLib.captureWriteWav(h, part.path)
+        if (rc < 0 || !part.renameTo(file)) {
+            part.delete()
+            throw IOException("Failed to write WAV ${file.path}: " +
+                if (rc < 0) WhisperAudio.describe(rc) else "rename failed")
+        }
+        Log.d(LOG_TAG, "Archived ${file.name}: frames=$frames @ ${sampleRate}Hz")
+    }
+
+    /** Frees the native buffer. Idempotent. */
+    override fun close() = lock.write {
+        val h = handle
+        handle = 0L
+        if (h != 0L) WhisperLib.captureClose(h)
+    }
+}
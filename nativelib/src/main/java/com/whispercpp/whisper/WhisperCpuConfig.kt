@@ -5,6 +5,7 @@
 // • Detects big.LITTLE topology via /sys frequency & variant heuristics
 // • Robust against permission or I/O failures
 // • Provides stable minimum thread count (≥2)
+// • Exposes the matching core index sets for affinity pinning
 // • Fine-grained debug logging for SoC frequency / cluster distribution
 // ============================================================
 
@@ -34,6 +35,18 @@ object WhisperCpuConfig {
     val preferredThreadCount: Int
         get() = CpuInfo.determineHighPerfCpuCount()
             .coerceAtLeast(2)
+
+    /**
+     * CPU indices whose max frequency exceeds the slowest cluster
+     * (the same cores [preferredThreadCount] counts). Empty if unknown
+     * or the SoC is homogeneous.
+     */
+    val performanceCores: IntArray
+        get() = CpuInfo.coresByFrequency { freq, min, _ -> freq > min }
+
+    /** CPU indices running at the highest max frequency (prime cluster). */
+    val primeCores: IntArray
+        get() = CpuInfo.coresByFrequency { freq, _, max -> freq == max }
 }
 
 /**
@@ -135,6 +148,23 @@ private class CpuInfo(private val lines: List<String>) {
             safeFallback()
         }
 
+        /**
+         * Selects core indices by their /sys max frequency.
+         * [select] receives (core freq, min freq, max freq) in kHz.
+         * Returns empty when frequencies are unknown or all equal.
+         */
+        fun coresByFrequency(select: (Int, Int, Int) -> Boolean): IntArray = try {
+            val cores = readCpuInfo().getProcessorIndices()
+            val freqs = cores.associateWith { getMaxCpuFrequency(it) }.filterValues { it > 0 }
+            val min = freqs.values.minOrNull() ?: 0
+            val max = freqs.values.maxOrNull() ?: 0
+            if (freqs.isEmpty() || min == max) IntArray(0)
+            else freqs.filter { (_, f) -> select(f, min, max) }.keys.sorted().toIntArray()
+        } catch (e: Exception) {
+            Log.w(LOG_TAG, "Core set detection failed", e)
+            IntArray(0)
+        }
+
         /**
          * Fallback heuristic when detection fails completely.
          *
@@ -0,0 +1,128 @@
+// file: com/whispercpp/whisper/WhisperCpuFeatures.kt
+// ============================================================
+// ✅ WhisperCpuFeatures — HWCAP-based native variant selection
+// ------------------------------------------------------------
+// • Reads AT_HWCAP / AT_HWCAP2 via getauxval() (libwhisper_cpu.so)
+// • Decodes fp16 / dotprod / i8mm / sve (arm64) and vfpv4 (armv7)
+// • Orders libwhisper_*.so candidates fastest-first for the loader
+// • Falls back to /proc/cpuinfo tokens if the probe cannot be loaded
+// ============================================================
+
+package com.whispercpp.whisper
+
+import android.os.Build
+import android.util.Log
+import java.io.File
+
+private const val LOG_TAG = "WhisperCpuFeatures"
+
+/**
+ * CPU capabilities relevant to the prebuilt whisper variants.
+ *
+ * Variant table (must match `build_library` flags in CMakeLists.txt):
+ * - `whisper_v9_sve`      : fp16 + dotprod + i8mm + sve
+ * - `whisper_v86_i8mm`    : fp16 + dotprod + i8mm
+ * - `whisper_v82_dotprod` : fp16 + dotprod
+ * - `whisper_v8fp16_va`   : fp16
+ * - `whisper_vfpv4`       : armv7 vfpv4
+ */
+internal object WhisperCpuFeatures {
+
+    // arm64 bits from <asm/hwcap.h>
+    private const val HWCAP_FPHP = 1L shl 9
+    private const val HWCAP_ASIMDHP = 1L shl 10
+    private const val HWCAP_ASIMDDP = 1L shl 20
+    private const val HWCAP_SVE = 1L shl 22
+    private const val HWCAP2_I8MM = 1L shl 13
+
+    // armv7 bits from <asm/hwcap.h>
+    private const val HWCAP_ARM_VFPV4 = 1L shl 16
+
+    /** Decoded feature set. */
+    data class Features(
+        val fp16: Boolean = false,
+        val dotprod: Boolean = false,
+        val i8mm: Boolean = false,
+        val sve: Boolean = false,
+        val vfpv4: Boolean = false,
+        val source: String = "none"
+    )
+
+    val abi: String = Build.SUPPORTED_ABIS.firstOrNull().orEmpty()
+
+    /** Features of this device (probe once; hwcaps never change at runtime). */
+    val features: Features by lazy { probeHwcaps() ?: parseCpuInfo() }
+
+    /**
+     * Library names to try, fastest first.
+     * The portable `whisper` build is always appended last.
+     */
+    fun variantCandidates(): List<String> {
+        val f = features
+        val out = mutableListOf<String>()
+        when {
+            abi.equals("arm64-v8a", ignoreCase = true) -> {
+                if (f.fp16 && f.dotprod && f.i8mm && f.sve) out += "whisper_v9_sve"
+                if (f.fp16 && f.dotprod && f.i8mm) out += "whisper_v86_i8mm"
+                if (f.fp16 && f.dotprod) out += "whisper_v82_dotprod"
+                if (f.fp16) out += "whisper_v8fp16_va"
+            }
+            abi.equals("armeabi-v7a", ignoreCase = true) -> {
+                if (f.vfpv4) out += "whisper_vfpv4"
+            }
+        }
+        out += "whisper"
+        return out
+    }
+
+    @JvmStatic
+    private external fun nativeHwcaps(): LongArray?
+
+    /** getauxval() path; null if the probe library is unavailable. */
+    private fun probeHwcaps(): Features? {
+        val caps = try {
+            System.loadLibrary("whisper_cpu")
+            nativeHwcaps()
+        } catch (e: UnsatisfiedLinkError) {
+            Log.w(LOG_TAG, "libwhisper_cpu.so unavailable → /proc/cpuinfo fallback: ${e.message}")
+            null
+        } ?: return null
+        if (caps.size < 2) return null
+
+        val hw = caps[0]
+        val hw2 = caps[1]
+        return if (abi.equals("armeabi-v7a", ignoreCase = true)) {
+            Features(vfpv4 = (hw and HWCAP_ARM_VFPV4) != 0L, source = "hwcap")
+        } else {
+            Features(
+                fp16 = (hw and HWCAP_FPHP) != 0L && (hw and HWCAP_ASIMDHP) != 0L,
+                dotprod = (hw and HWCAP_ASIMDDP) != 0L,
+                i8mm = (hw2 and HWCAP2_I8MM) != 0L,
+                sve = (hw and HWCAP_SVE) != 0L,
+                source = "hwcap"
+            )
+        }
+    }
+
+    /** Legacy text path: "Features" tokens from /proc/cpuinfo. */
+    private fun parseCpuInfo(): Features {
+        val text = try {
+            File("/proc/cpuinfo").readText().lowercase()
+        } catch (e: Exception) {
+            Log.w(LOG_TAG, "Could not read /proc/cpuinfo", e)
+            return Features()
+        }
+        val tokens = text.lineSequence()
+            .filter { it.startsWith("features") }
+            .flatMap { it.substringAfter(':').trim().split(Regex("\\s+")) }
+            .toSet()
+        return Features(
+            fp16 = "asimdhp" in tokens || "fphp" in tokens,
+            dotprod = "asimddp" in tokens,
+            i8mm = "i8mm" in tokens,
+            sve = "sve" in tokens,
+            vfpv4 = "vfpv4" in tokens,
+            source = "cpuinfo"
+        )
+    }
+}
@@ -0,0 +1,151 @@
+// file: com/whispercpp/whisper/WhisperDecodeParams.kt
+// ============================================================
+// ✅ WhisperDecodeParams — Decoding strategy per call / device class
+// ------------------------------------------------------------
+// • Greedy or beam search, best-of, temperature fallback on/off
+// • Token / segment limits and a reduced encoder context (audio_ctx)
+// • autoAudioCtx: audio_ctx sized per clip, full-context retry if it degenerates
+// • tokenTimestamps: per-token times for getTokens() / getWords()
+// • Built into a native params block (paramsCreate / paramsSet*)
+//   for fullTranscribeWithParams(); unset fields keep whisper defaults
+// • Presets: FAST (low-end), ACCURATE (flagship), COMMAND (short clips)
+// ============================================================
+
+package com.whispercpp.whisper
+
+/**
+ * Decoding parameters for [WhisperContext.transcribeData].
+ *
+ * `null` leaves whisper.cpp's default for that field.
+ *
+ * @property strategy greedy (fast) or beam search (more accurate, ~beamSize× decode cost)
+ * @property beamSize beams for [Strategy.BEAM]
+ * @property bestOf candidates sampled when a segment is re-decoded at a higher temperature
+ * @property temperature initial sampling temperature (0 = argmax)
+ * @property temperatureInc fallback step; 0 disables fallback (see [noFallback])
+ * @property noFallback never re-decode a segment that fails the entropy / logprob checks
+ * @property entropyThold fallback when the token entropy is above this
+ * @property logprobThold fallback when the average logprob is below this
+ * @property noSpeechThold segments above this no-speech probability are skipped
+ * @property maxLen max characters per segment (0 = unlimited)
+ * @property maxTokens max tokens per segment (0 = unlimited)
+ * @property audioCtx encoder frames (1500 = 30 s, 0 = model default); must cover the clip
+ * @property autoAudioCtx when [audioCtx] is unset: size the encoder context to each clip
+ *   (frames + ~1.3 s, multiple of 64, ≥ 256) and re-run with the full context if the result
+ *   looks degenerate; see [WhisperContext.getLastAudioCtx]
+ * @property singleSegment force one segment per run
+ * @property noTimestamps skip timestamp tokens (faster, segments get coarse times)
+ * @property tokenTimestamps per-token t0 / t1 for [WhisperContext.getTokens] /
+ *   [WhisperContext.getWords] (on implicitly while [maxLen] splits segments)
+ * @property initialPrompt text used as previous context (vocabulary / style hints)
+ */
+data class WhisperDecodeParams(
+    val strategy: Strategy = Strategy.GREEDY,
+    val beamSize: Int? = null,
+    val bestOf: Int? = null,
+    val temperature: Float? = null,
+    val temperatureInc: Float? = null,
+    val noFallback: Boolean = false,
+    val entropyThold: Float? = null,
+    val logprobThold: Float? = null,
+    val noSpeechThold: Float? = null,
+    val maxLen: Int? = null,
+    val maxTokens: Int? = null,
+    val audioCtx: Int? = null,
+    val autoAudioCtx: Boolean = false,
+    val singleSegment: Boolean? = null,
+    val noTimestamps: Boolean? = null,
+    val tokenTimestamps: Boolean = false,
+    val initialPrompt: String? = null
+) {
+    /** Native values match `enum whisper_sampling_strategy`. */
+    enum class Strategy(internal val native: Int) { GREEDY(0), BEAM(1) }
+
+    /**
+     * Builds a native params block, passes it to [block] and frees it.
+     *
+     * @throws IllegalArgumentException if a value is rejected natively
+     */
+    internal fun <T> useNative(block: (Long) -> T): T {
+        val h = WhisperLib.paramsCreate(strategy.native)
+        check(h != 0L) { "paramsCreate(${strategy.name}) failed" }
+        try {
+            fun int(key: Int, v: Int?) = require(v == null || WhisperLib.paramsSetInt(h, key, v)) { "Invalid decode param $key=$v" }
+            fun bool(key: Int, v: Boolean?) = int(key, v?.let { if (it) 1 else 0 })
+            fun float(key: Int, v: Float?) = require(v == null || WhisperLib.paramsSetFloat(h, key, v)) { "Invalid decode param $key=$v" }
+
+            int(KEY_BEAM_SIZE, beamSize)
+            int(KEY_BEST_OF, bestOf)
+            int(KEY_MAX_LEN, maxLen)
+            int(KEY_MAX_TOKENS, maxTokens)
+            int(KEY_AUDIO_CTX, audioCtx)
+            if (autoAudioCtx) bool(KEY_AUTO_AUDIO_CTX, true)
+            bool(KEY_SINGLE_SEGMENT, singleSegment)
+            bool(KEY_NO_TIMESTAMPS, noTimestamps)
+            if (tokenTimestamps) bool(KEY_TOKEN_TIMESTAMPS, true)
+            float(KEY_TEMPERATURE, temperature)
+            float(KEY_TEMPERATURE_INC, temperatureInc)
+            if (noFallback) bool(KEY_NO_FALLBACK, true)
+            float(KEY_ENTROPY_THOLD, entropyThold)
+            float(KEY_LOGPROB_THOLD, logprobThold)
+            float(KEY_NO_SPEECH_THOLD, noSpeechThold)
+            if (initialPrompt != null) {
+                require(WhisperLib.paramsSetString(h, KEY_INITIAL_PROMPT, initialPrompt)) { "Invalid initial prompt" }
+            }
+            return block(h)
+        } finally {
+            WhisperLib.paramsFree(h)
+        }
+    }
+
+    companion object {
+        // Keys match `enum jni_param_key` in whisperLib.c.
+        internal const val KEY_BEAM_SIZE = 0
+        internal const val KEY_BEST_OF = 1
+        internal const val KEY_MAX_LEN = 2
+        internal const val KEY_MAX_TOKENS = 3
+        internal const val KEY_AUDIO_CTX = 4
+        internal const val KEY_NO_FALLBACK = 5
+        internal const val KEY_SINGLE_SEGMENT = 6
+        internal const val KEY_NO_TIMESTAMPS = 7
+        internal const val KEY_AUTO_AUDIO_CTX = 11
+        internal const val KEY_TOKEN_TIMESTAMPS = 12
+        internal const val KEY_TEMPERATURE = 20
+        internal const val KEY_TEMPERATURE_INC = 21
+        internal const val KEY_ENTROPY_THOLD = 22
+        internal const val KEY_LOGPROB_THOLD = 23
+        internal const val KEY_NO_SPEECH_THOLD = 24
+        internal const val KEY_INITIAL_PROMPT = 30
+
+        /** Greedy, single candidate, no temperature fallback: bounded latency on low-end phones. */
+        val FAST = WhisperDecodeParams(bestOf = 1, noFallback = true)
+
+        /** Beam search (5 beams, best of 5): for flagships when accuracy matters more than speed. */
+        val ACCURATE = WhisperDecodeParams(strategy = Strategy.BEAM, beamSize = 5, bestOf = 5)
+
+        /**
+         * Short voice commands: greedy, no fallback, one segment and an encoder
+         * context sized to each clip ([autoAudioCtx]).
+         */
+        val COMMAND = WhisperDecodeParams(
+            bestOf = 1, noFallback = true, singleSegment = true, autoAudioCtx = true
+        )
+
+        /**
+         * Picks [ACCURATE] on devices with ≥ 4 performance cores, otherwise [FAST].
+         */
+        fun forDevice(): WhisperDecodeParams =
+            if (WhisperCpuConfig.performanceCores.size >= 4) ACCURATE else FAST
+    }
+}
+
+/**
+ * Encoder context of the last run ([WhisperContext.getLastAudioCtx]).
+ *
+ * @property used audio_ctx of the kept result (model default when full)
+ * @property initial audio_ctx of the first attempt
+ */
+data class WhisperAudioCtx(val used: Int, val initial: Int) {
+    /** The reduced context degenerated and the run was repeated at full context. */
+    val fellBack: Boolean get() = used != initial
+}
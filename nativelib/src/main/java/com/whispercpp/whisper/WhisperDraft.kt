@@ -0,0 +1,100 @@
+// file: com/whispercpp/whisper/WhisperDraft.kt
+// ============================================================
+// ✅ WhisperDraft — Draft model (tiny) + target model (base / small)
+// ------------------------------------------------------------
+// • Draft and target passes run side by side on their own contexts
+// • Draft result: tiny-model latency for a provisional transcript
+// • Target result: final text at target-model accuracy, never held
+//   back by the draft (a draft still running then is cancelled)
+// • Both contexts come from the model cache: pairing costs no reload
+// ============================================================
+
+package com.whispercpp.whisper
+
+import android.util.Log
+import kotlinx.coroutines.cancelAndJoin
+import kotlinx.coroutines.flow.Flow
+import kotlinx.coroutines.flow.channelFlow
+import kotlinx.coroutines.launch
+import java.nio.FloatBuffer
+
+private const val LOG_TAG = "WhisperDraft"
+
+/**
+ * One pass of [WhisperDraftPair.transcribe].
+ *
+ * @property segments the pass's segments (10 ms ticks, clip timeline)
+ * @property language language the pass decoded in (null if unknown)
+ * @property final false for the draft, true for the target's result
+ * @property elapsedMs wall time of this pass
+ */
+data class WhisperDraftPass(
+    val segments: List<WhisperSegment>,
+    val language: String?,
+    val final: Boolean,
+    val elapsedMs: Long
+)
+
+/**
+ * Draft-then-refine transcription over two models sharing one vocabulary
+ * (e.g. tiny → small, both multilingual).
+ *
+ * Typical use (dictation with an instant preview):
+ * ```
+ * val pair = WhisperDraftPair(tinyCtx, smallCtx)
+ * pair.transcribe(pcm, "auto", false).collect { pass ->
+ *     show(pass.segments.toTranscript(), provisional = !pass.final)
+ * }
+ * ```
+ *
+ * Not token-level speculative decoding: verifying K drafted tokens in one
+ * target pass needs the target's logits at every position of the batch,
+ * and whisper.cpp's public decoder API (`whisper_decode_with_state`) only
+ * keeps the last one. The encoders cannot be shared either (different
+ * widths), so each model encodes the clip itself.
+ *
+ * The passes run concurrently, so the final result arrives about as fast
+ * as the target alone; give [draft] few threads ([WhisperContext.threadCount])
+ * to leave the cores to the target.
+ *
+ * @property draft small, fast model
+ * @property target accurate model whose result is final
+ */
+class WhisperDraftPair(val draft: WhisperContext, val target: WhisperContext) {
+
+    init {
+        require(draft !== target) { "draft and target must be different contexts" }
+    }
+
+    /**
+     * Runs [draft] and [target] concurrently: emits the draft result if it
+     * completes first, then the target's. Cancelling the collector aborts
+     * both native runs.
+     *
+     * @param buffer Direct buffer; only read (both passes see the same samples)
+     * @param params target decoding parameters
+     * @param draftParams draft decoding parameters (default: greedy defaults)
+     */
+    fun transcribe(
+        buffer: FloatBuffer,
+        lang: String,
+        translate: Boolean,
+        params: WhisperDecodeParams? = null,
+        draftParams: WhisperDecodeParams? = null
+    ): Flow<WhisperDraftPass> = channelFlow {
+        val start = System.currentTimeMillis()
+        val preview = launch {
+            draft.transcribeData(buffer.duplicate(), lang, translate, false, draftParams)
+            val language = if (lang == "auto") draft.getLastLanguage() else lang
+            send(WhisperDraftPass(draft.getSegments(), language, false, System.currentTimeMillis() - start))
+        }
+
+        target.transcribeData(buffer.duplicate(), lang, translate, false, params)
+        // A draft finishing after the target would only show stale text.
+        preview.cancelAndJoin()
+        val language = if (lang == "auto") target.getLastLanguage() else lang
+        val pass = WhisperDraftPass(target.getSegments(), language, true, System.currentTimeMillis() - start)
+        Log.i(LOG_TAG, "Draft + target: lang=$language target=${pass.elapsedMs} ms")
+        send(pass)
+    }
+}
@@ -0,0 +1,53 @@
+// file: com/whispercpp/whisper/WhisperLanguage.kt
+// ============================================================
+// ✅ WhisperLanguage — Detected spoken language + per-key cache
+// ------------------------------------------------------------
+// • WhisperContext.detectLanguage(): top-k probabilities from a clip's first seconds
+// • One detection per session / recording; later runs get the code explicitly
+// • Low-confidence results are not cached: whisper_full() detects itself
+// ============================================================
+
+package com.whispercpp.whisper
+
+/**
+ * One candidate of [WhisperContext.detectLanguage].
+ *
+ * @property code ISO code as whisper.cpp names it ("en", "ja", "sw", …)
+ * @property probability softmax over the language tokens, 0…1
+ */
+data class WhisperLanguage(
+    val code: String,
+    val probability: Float
+) {
+    companion object {
+        /** Audio handed to detection: enough speech for a stable argmax at a fraction of a 30 s window's mel. */
+        const val DETECT_SECONDS = 8f
+
+        /** Below this the top language is not trusted (silence, music, code-switching). */
+        const val MIN_PROBABILITY = 0.5f
+
+        /** Keys (sessions / recordings) whose language [WhisperContext] remembers. */
+        internal const val CACHE_SIZE = 64
+    }
+}
+
+/**
+ * Language of each session / recording key, most recently used kept;
+ * thread-safe (pool workers and the UI read it concurrently).
+ */
+internal class WhisperLanguageCache(private val capacity: Int = WhisperLanguage.CACHE_SIZE) {
+
+    private val map = object : LinkedHashMap<String, String>(16, 0.75f, true) {
+        override fun removeEldestEntry(eldest: MutableMap.MutableEntry<String, String>): Boolean = size > capacity
+    }
+
+    operator fun get(key: String): String? = synchronized(map) { map[key] }
+
+    operator fun set(key: String, code: String) {
+        synchronized(map) { map[key] = code }
+    }
+
+    fun remove(key: String) {
+        synchronized(map) { map.remove(key) }
+    }
+}
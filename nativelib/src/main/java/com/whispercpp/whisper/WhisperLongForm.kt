@@ -0,0 +1,105 @@
+// file: com/whispercpp/whisper/WhisperLongForm.kt
+// ============================================================
+// ✅ WhisperLongForm — Chunk planning + stitching for long recordings
+// ------------------------------------------------------------
+// • Native plan: ~N-minute chunks cut inside pauses (energy VAD)
+// • Hard cuts (no pause found) overlap; the overlap is split at its middle
+// • Segments shifted onto the recording's timeline, seam duplicates dropped
+// • Executed concurrently by WhisperPool.transcribeLong()
+// ============================================================
+
+package com.whispercpp.whisper
+
+import java.nio.FloatBuffer
+
+/** One planned chunk: samples [start, end) relative to the clip's first sample. */
+internal data class WhisperChunk(val start: Int, val end: Int)
+
+internal object WhisperLongForm {
+
+    /** 10 ms whisper ticks → samples at 16 kHz. */
+    private const val SAMPLES_PER_TICK = 160
+    private const val SAMPLE_RATE = 16_000
+
+    /** Chunks shorter than this waste most of whisper's fixed 30 s encoder window. */
+    private const val MIN_CHUNK_SAMPLES = 60 * SAMPLE_RATE
+    private const val MAX_CHUNK_SAMPLES = 10 * 60 * SAMPLE_RATE
+
+    /** Seam duplicates may be timed up to this far apart (1 s). */
+    private const val SEAM_SLACK_TICKS = 100L
+
+    /**
+     * Chunk length for [samples] over [workers] states: about two chunks per
+     * worker, so a slow chunk does not leave the other states idle at the end.
+     */
+    fun chunkSamples(samples: Int, workers: Int): Int =
+        (samples / (2 * workers.coerceAtLeast(1))).coerceIn(MIN_CHUNK_SAMPLES, MAX_CHUNK_SAMPLES)
+
+    /**
+     * Plans chunks over `buffer.remaining()` samples (native longformPlan).
+     * Falls back to a single chunk if planning fails.
+     */
+    fun plan(buffer: FloatBuffer, chunkSamples: Int, overlapSamples: Int): List<WhisperChunk> {
+        val n = buffer.remaining()
+        val flat = WhisperLib.longformPlan(buffer, buffer.position(), n, chunkSamples, overlapSamples)
+            ?: return listOf(WhisperChunk(0, n))
+        return List(flat.size / 2) { WhisperChunk(flat[2 * it], flat[2 * it + 1]) }
+    }
+
+    /** Read-only view of [chunk] over [buffer]; independent position / limit per job. */
+    fun slice(buffer: FloatBuffer, chunk: WhisperChunk): FloatBuffer {
+        val base = buffer.position()
+        return buffer.duplicate().also {
+            it.limit(base + chunk.end)
+            it.position(base + chunk.start)
+        }
+    }
+
+    /**
+     * Joins per-chunk results ([perChunk] times relative to each chunk) into
+     * one timeline.
+     *
+     * At each seam the boundary is the middle of the overlap (the cut itself
+     * when chunks abut): a chunk keeps the segments whose midpoint falls on its
+     * side. If the same text still appears on both sides of a seam (a sentence
+     * straddling the boundary decoded twice), the later copy is dropped: every
+     * later segment near the seam is compared with every earlier one near it.
+     */
+    fun stitch(chunks: List<WhisperChunk>, perChunk: List<List<WhisperSegment>>): List<WhisperSegment> {
+        require(chunks.size == perChunk.size) { "chunks / results mismatch" }
+        val out = ArrayList<WhisperSegment>(perChunk.sumOf { it.size })
+        for (i in chunks.indices) {
+            val lo = if (i == 0) Long.MIN_VALUE else seamTicks(chunks[i - 1], chunks[i])
+            val hi = if (i == chunks.lastIndex) Long.MAX_VALUE else seamTicks(chunks[i], chunks[i + 1])
+            val reach = if (i == 0) 0L else seamReachTicks(chunks[i - 1], chunks[i])
+            // Earlier segments reaching into the seam window (out is in time order).
+            val near = if (i == 0) emptyList() else out.takeLastWhile { it.t1 >= lo - reach }
+            val offset = chunks[i].start.toLong() / SAMPLES_PER_TICK
+            for (seg in perChunk[i]) {
+                val shifted = seg.copy(t0 = seg.t0 + offset, t1 = seg.t1 + offset)
+                val mid = (shifted.t0 + shifted.t1) / 2
+                if (mid < lo || mid >= hi) continue
+                if (shifted.t0 <= lo + reach && near.any { sameText(it, shifted) }) continue
+                out += shifted
+            }
+        }
+        return out
+    }
+
+    /** Boundary between consecutive chunks, in ticks of the clip timeline. */
+    private fun seamTicks(prev: WhisperChunk, next: WhisperChunk): Long =
+        (next.start.toLong() + maxOf(prev.end, next.start)) / 2 / SAMPLES_PER_TICK
+
+    /**
+     * How far from the seam a segment may lie and still straddle it: half the
+     * overlap plus [SEAM_SLACK_TICKS] for whisper's timestamp drift.
+     */
+    private fun seamReachTicks(prev: WhisperChunk, next: WhisperChunk): Long =
+        (maxOf(prev.end, next.start) - next.start).toLong() / 2 / SAMPLES_PER_TICK + SEAM_SLACK_TICKS
+
+    private fun sameText(a: WhisperSegment, b: WhisperSegment): Boolean =
+        normalize(a.text) == normalize(b.text)
+
+    private fun normalize(s: String): String =
+        s.lowercase().filter { it.isLetterOrDigit() }
+}
@@ -0,0 +1,111 @@
+// file: com/whispercpp/whisper/WhisperModelCache.kt
+// ============================================================
+// ✅ WhisperModelCache — Keep-alive models across context switches
+// ------------------------------------------------------------
+// • Process-wide native cache keyed by sampled content hash (asset = extracted copy)
+// • Byte budget with LRU eviction of idle models (in-use models are pinned)
+// • ComponentCallbacks2.onTrimMemory → trims idle models under pressure
+// • Filled via WhisperContext.createContextFromAssetCached() / createContextFromFileCached()
+// ============================================================
+
+package com.whispercpp.whisper
+
+import android.app.ActivityManager
+import android.content.ComponentCallbacks2
+import android.content.Context
+import android.content.res.Configuration
+import android.util.Log
+import java.util.concurrent.atomic.AtomicBoolean
+
+private const val LOG_TAG = "WhisperModelCache"
+
+/**
+ * Front end for the native model cache.
+ *
+ * Typical use (model picker):
+ * ```
+ * WhisperModelCache.install(application)          // once; hooks onTrimMemory
+ * ctx?.release()                                  // model goes back to the cache
+ * ctx = WhisperContext.createContextFromAssetCached(assets, "models/$name")
+ * ```
+ *
+ * Accounting: each model is charged its asset size (≈ resident weights)
+ * plus the KV cache and compute buffers of its default decoder state, which
+ * whisper.cpp keeps until the weights are freed, so an idle entry holds
+ * both. Private states of further concurrent handles are freed with their
+ * context and are not counted.
+ */
+object WhisperModelCache {
+
+    /** Snapshot of the cache contents. */
+    data class Stats(val entries: Int, val inUse: Int, val bytes: Long, val budgetBytes: Long)
+
+    private val installed = AtomicBoolean(false)
+
+    /**
+     * Upper bound for cached weights in bytes. Lowering it evicts idle models
+     * immediately; models in use are kept even when the total exceeds it.
+     */
+    var budgetBytes: Long
+        get() = stats().budgetBytes
+        set(value) = WhisperLib.modelCacheSetBudget(value.coerceAtLeast(0L))
+
+    fun stats(): Stats {
+        val s = WhisperLib.modelCacheStats() ?: return Stats(0, 0, 0L, 0L)
+        return Stats(s[0].toInt(), s[1].toInt(), s[2], s[3])
+    }
+
+    /**
+     * Evicts idle models, least recently used first, until at most
+     * [limitBytes] stay cached.
+     *
+     * @return bytes still cached
+     */
+    fun trim(limitBytes: Long = 0L): Long = WhisperLib.modelCacheTrim(limitBytes.coerceAtLeast(0L))
+
+    /**
+     * Maps a [ComponentCallbacks2] trim level to an eviction target:
+     * - RUNNING_LOW / UI_HIDDEN: keep at most half the budget
+     * - RUNNING_CRITICAL / BACKGROUND and above: drop every idle model
+     */
+    @Suppress("DEPRECATION")
+    fun onTrimMemory(level: Int) {
+        val limit = when {
+            level == ComponentCallbacks2.TRIM_MEMORY_RUNNING_CRITICAL -> 0L
+            level >= ComponentCallbacks2.TRIM_MEMORY_BACKGROUND -> 0L
+            level >= ComponentCallbacks2.TRIM_MEMORY_RUNNING_LOW -> budgetBytes / 2
+            else -> return
+        }
+        val left = trim(limit)
+        Log.i(LOG_TAG, "onTrimMemory(level=$level) → ${left / 1024} KB cached")
+    }
+
+    /**
+     * Registers memory-pressure callbacks on the application context and,
+     * unless [budgetBytes] is given, sizes the budget to 1/8 of device RAM
+     * (clamped to 128 MB…1 GB). Idempotent.
+     */
+    fun install(context: Context, budgetBytes: Long? = null) {
+        if (!installed.compareAndSet(false, true)) return
+        val app = context.applicationContext
+        this.budgetBytes = budgetBytes ?: defaultBudget(app)
+        app.registerComponentCallbacks(object : ComponentCallbacks2 {
+            override fun onTrimMemory(level: Int) = this@WhisperModelCache.onTrimMemory(level)
+            override fun onConfigurationChanged(newConfig: Configuration) = Unit
+            @Deprecated("Deprecated in Java")
+            override fun onLowMemory() { trim(0L) }
+        })
+        Log.i(LOG_TAG, "Installed: budget=${this.budgetBytes / (1024 * 1024)} MB")
+    }
+
+    private fun defaultBudget(context: Context): Long {
+        val total = try {
+            val am = context.getSystemService(Context.ACTIVITY_SERVICE) as ActivityManager
+            ActivityManager.MemoryInfo().also { am.getMemoryInfo(it) }.totalMem
+        } catch (e: Exception) {
+            Log.w(LOG_TAG, "Could not query device memory", e)
+            0L
+        }
+        return (total / 8).coerceIn(128L shl 20, 1L shl 30)
+    }
+}
@@ -0,0 +1,244 @@
+// file: com/whispercpp/whisper/WhisperModelStore.kt
+// ============================================================
+// ✅ WhisperModelStore — One-time APK → filesystem model extraction
+// ------------------------------------------------------------
+// • Copies a bundled model to noBackupFilesDir once (background, atomic rename)
+// • SHA-256 computed while copying; optional expected hash is enforced
+// • Recorded hash re-checked once before the copy's first load (verifiedFile)
+// • Metadata sidecar written last = commit marker (crash-safe)
+// • Stale after an app update (APK lastUpdateTime) or size mismatch
+// • Later launches load the file through the mmap path (createContextFromFileCached)
+// ============================================================
+
+package com.whispercpp.whisper
+
+import android.content.Context
+import android.content.res.AssetManager
+import android.util.Log
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.sync.Mutex
+import kotlinx.coroutines.sync.withLock
+import kotlinx.coroutines.withContext
+import java.io.File
+import java.io.FileOutputStream
+import java.io.IOException
+import java.security.MessageDigest
+import java.util.Properties
+import java.util.concurrent.ConcurrentHashMap
+
+private const val LOG_TAG = "WhisperModelStore"
+
+/**
+ * Extracted copies of models shipped as APK assets.
+ *
+ * Typical use (model load at startup):
+ * ```
+ * val file = WhisperModelStore.verifiedFile(context, "models/ggml-base.bin")
+ * val ctx = if (file != null) WhisperContext.createContextFromFileCached(file.path)
+ *           else WhisperContext.createContextFromAssetCached(assets, "models/ggml-base.bin")
+ * if (file == null) scope.launch { WhisperModelStore.extract(context, "models/ggml-base.bin") }
+ * ```
+ *
+ * The copy keeps the ggml byte layout unchanged: whisper.cpp parses the
+ * file sequentially and copies each tensor into its own buffers, so the
+ * win over the asset path is the plain mmap()ed read (no zip inflate, no
+ * AAsset layer), not in-place tensor mapping.
+ */
+object WhisperModelStore {
+
+    private const val DIR = "whisper-models"
+    private const val COPY_BUFFER = 1 shl 20
+
+    private const val KEY_SHA256 = "sha256"
+    private const val KEY_BYTES = "bytes"
+    private const val KEY_SOURCE = "source"
+    private const val KEY_VERIFIED = "verified"
+
+    /** One extraction per asset at a time. */
+    private val locks = ConcurrentHashMap<String, Mutex>()
+
+    /**
+     * The extracted copy of [assetPath] if it is complete and was written
+     * by the installed APK, else null. Cheap: a stat and a tiny sidecar read.
+     */
+    fun extractedFile(context: Context, assetPath: String): File? {
+        val file = target(context, assetPath)
+        val meta = readMeta(metaFile(file)) ?: return null
+        val ok = file.isFile &&
+            meta.getProperty(KEY_BYTES)?.toLongOrNull() == file.length() &&
+            meta.getProperty(KEY_SOURCE) == sourceStamp(context)
+        return if (ok) file else null
+    }
+
+    /**
+     * [extractedFile], with its recorded SHA-256 checked before the first load.
+     *
+     * The first call after an extraction re-reads the copy once (see
+     * [verify]) and records the result in the sidecar; later calls cost what
+     * [extractedFile] costs. Checking on every launch is not needed: the copy
+     * is never written after its rename, and an extraction cut short by a
+     * crash or power loss has no sidecar, so it is never returned at all.
+     * Runs on [Dispatchers.IO].
+     *
+     * @return the verified copy, or null if there is none or it was corrupt (then deleted)
+     */
+    suspend fun verifiedFile(context: Context, assetPath: String): File? = withContext(Dispatchers.IO) {
+        val file = extractedFile(context, assetPath) ?: return@withContext null
+        if (readMeta(metaFile(file))?.getProperty(KEY_VERIFIED) == "true") return@withContext file
+        if (verify(context, assetPath)) file else null
+    }
+
+    /**
+     * Copies [assetPath] to app storage unless a valid copy exists.
+     *
+     * The data goes to a temporary file that is fsync()ed and renamed into
+     * place; the metadata sidecar (size, SHA-256, APK stamp) is written
+     * last, so an interrupted extraction is never mistaken for a good one.
+     * Runs on [Dispatchers.IO].
+     *
+     * @param expectedSha256 lowercase hex digest the asset must have (optional)
+     * @return the extracted file
+     * @throws IOException on read / write failure or digest mismatch (nothing is kept)
+     */
+    @Throws(IOException::class)
+    suspend fun extract(context: Context, assetPath: String, expectedSha256: String? = null): File =
+        withContext(Dispatchers.IO) {
+            locks.getOrPut(assetPath) { Mutex() }.withLock {
+                extractedFile(context, assetPath)?.let { return@withLock it }
+
+                val file = target(context, assetPath)
+                val meta = metaFile(file)
+                val tmp = File(file.path + ".tmp")
+                file.parentFile?.mkdirs()
+                meta.delete()  // invalidate first: data is about to change
+
+                val start = System.currentTimeMillis()
+                val (bytes, sha) = try {
+                    copyAsset(context.assets, assetPath, tmp)
+                } catch (e: IOException) {
+                    tmp.delete()
+                    throw e
+                }
+                if (expectedSha256 != null && !sha.equals(expectedSha256, ignoreCase = true)) {
+                    tmp.delete()
+                    throw IOException("Checksum mismatch for $assetPath: $sha != $expectedSha256")
+                }
+                if (!tmp.renameTo(file)) {
+                    tmp.delete()
+                    throw IOException("Cannot move extracted model into place: ${file.path}")
+                }
+                writeMeta(meta, Properties().apply {
+                    setProperty(KEY_SHA256, sha)
+                    setProperty(KEY_BYTES, bytes.toString())
+                    setProperty(KEY_SOURCE, sourceStamp(context))
+                })
+                Log.i(
+                    LOG_TAG,
+                    "Extracted $assetPath → ${file.path}: ${bytes / 1024} KB in " +
+                        "${System.currentTimeMillis() - start} ms (sha256=$sha)"
+                )
+                file
+            }
+        }
+
+    /**
+     * Re-reads the extracted copy and compares it with the recorded SHA-256
+     * (e.g. once after an unclean shutdown). A match is recorded for
+     * [verifiedFile]; a corrupt copy is deleted.
+     *
+     * @return true if the copy exists and matches
+     */
+    suspend fun verify(context: Context, assetPath: String): Boolean = withContext(Dispatchers.IO) {
+        locks.getOrPut(assetPath) { Mutex() }.withLock {
+            val file = extractedFile(context, assetPath) ?: return@withLock false
+            val meta = readMeta(metaFile(file))
+            val expected = meta?.getProperty(KEY_SHA256)
+            val actual = runCatching { sha256(file) }.getOrNull()
+            (expected != null && expected == actual).also { ok ->
+                if (ok) {
+                    meta?.setProperty(KEY_VERIFIED, "true")
+                    meta?.let { runCatching { writeMeta(metaFile(file), it) } }
+                } else {
+                    Log.w(LOG_TAG, "Extracted $assetPath is corrupt ($actual != $expected); deleting")
+                    delete(file)
+                }
+            }
+        }
+    }
+
+    /** Deletes the extracted copy of [assetPath] (e.g. to reclaim storage). */
+    fun delete(context: Context, assetPath: String) = delete(target(context, assetPath))
+
+    // ------------------------------------------------------------
+    // Internals
+    // ------------------------------------------------------------
+
+    private fun target(context: Context, assetPath: String): File =
+        File(File(context.noBackupFilesDir, DIR), assetPath.replace('/', '_'))
+
+    private fun metaFile(file: File) = File(file.path + ".meta")
+
+    private fun delete(file: File) {
+        metaFile(file).delete()
+        file.delete()
+    }
+
+    /** Changes whenever the APK (and thus its assets) is replaced. */
+    @Suppress("DEPRECATION")
+    private fun sourceStamp(context: Context): String {
+        val info = context.packageManager.getPackageInfo(context.packageName, 0)
+        return "${info.lastUpdateTime}:${info.versionCode}"
+    }
+
+    /** Streams the asset into [dst] while hashing it; fsync()s before returning. */
+    private fun copyAsset(assets: AssetManager, assetPath: String, dst: File): Pair<Long, String> {
+        val digest = MessageDigest.getInstance("SHA-256")
+        val buf = ByteArray(COPY_BUFFER)
+        var total = 0L
+        assets.open(assetPath, AssetManager.ACCESS_STREAMING).use { input ->
+            FileOutputStream(dst).use { out ->
+                while (true) {
+                    val n = input.read(buf)
+                    if (n < 0) break
+                    digest.update(buf, 0, n)
+                    out.write(buf, 0, n)
+                    total += n
+                }
+                out.fd.sync()
+            }
+        }
+        return total to digest.digest().toHex()
+    }
+
+    private fun sha256(file: File): String {
+        val digest = MessageDigest.getInstance("SHA-256")
+        val buf = ByteArray(COPY_BUFFER)
+        file.inputStream().use { input ->
+            while (true) {
+                val n = input.read(buf)
+                if (n < 0) break
+                digest.update(buf, 0, n)
+            }
+        }
+        return digest.digest().toHex()
+    }
+
+    private fun readMeta(meta: File): Properties? = runCatching {
+        if (!meta.isFile) null else Properties().apply { meta.inputStream().use { load(it) } }
+    }.getOrNull()
+
+    /** Atomic sidecar write (tmp + fsync + rename). */
+    private fun writeMeta(meta: File, props: Properties) {
+        val tmp = File(meta.path + ".tmp")
+        FileOutputStream(tmp).use { out ->
+            props.store(out, null)
+            out.fd.sync()
+        }
+        if (!tmp.renameTo(meta)) {
+            tmp.delete()
+            throw IOException("Cannot write model metadata: ${meta.path}")
+        }
+    }
+
+    private fun ByteArray.toHex(): String = joinToString("") { "%02x".format(it) }
+}
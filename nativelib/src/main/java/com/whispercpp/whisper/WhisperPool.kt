@@ -0,0 +1,208 @@
+// file: com/whispercpp/whisper/WhisperPool.kt
+// ============================================================
+// ✅ WhisperPool — Concurrent transcription over shared weights
+// ------------------------------------------------------------
+// • One model (WhisperContext) + N whisper_state workers
+// • Each worker owns a JNI thread; jobs go to the first free worker
+// • Performance cores split into disjoint per-worker sets (shared set as fallback)
+// • Cancellation aborts only the job's own native run
+// • transcribeLong(): hour-long clips chunked at pauses, decoded in parallel, stitched
+// • "auto" resolved once per long clip, not once per chunk
+// ============================================================
+
+package com.whispercpp.whisper
+
+import android.util.Log
+import kotlinx.coroutines.async
+import kotlinx.coroutines.awaitAll
+import kotlinx.coroutines.channels.Channel
+import kotlinx.coroutines.coroutineScope
+import kotlinx.coroutines.flow.Flow
+import kotlinx.coroutines.flow.emitAll
+import kotlinx.coroutines.flow.flow
+import java.nio.FloatBuffer
+
+private const val LOG_TAG = "WhisperPool"
+
+/**
+ * Runs up to [size] transcriptions at once without loading the model again.
+ *
+ * Typical use (re-transcribing a backlog):
+ * ```
+ * val pool = WhisperPool.create(ctx)          // ctx keeps the weights
+ * files.map { f -> async { pool.transcribeData(decode(f), "en", false) } }.awaitAll()
+ * pool.release()                              // before ctx.release()
+ * ```
+ *
+ * Memory: every worker adds one `whisper_state` (KV cache + compute buffers)
+ * on top of the shared weights, so size the pool for the device RAM.
+ *
+ * Each job needs its own PCM buffer; direct buffers must not be shared
+ * between jobs that run concurrently.
+ */
+class WhisperPool private constructor(
+    val base: WhisperContext,
+    private val workers: List<WhisperContext>
+) {
+    /** Free workers; receive() suspends until one is available. */
+    private val free = Channel<WhisperContext>(Channel.UNLIMITED).apply {
+        workers.forEach { trySend(it) }
+    }
+
+    /** Number of concurrent jobs this pool can run. */
+    val size: Int get() = workers.size
+
+    /** Runs [block] on a free worker, suspending until one is available. */
+    suspend fun <T> withWorker(block: suspend (WhisperContext) -> T): T {
+        val w = free.receive()
+        try {
+            return block(w)
+        } finally {
+            free.trySend(w)
+        }
+    }
+
+    /** Pooled [WhisperContext.transcribeData] over a direct buffer. */
+    suspend fun transcribeData(
+        buffer: FloatBuffer,
+        lang: String,
+        translate: Boolean,
+        printTimestamp: Boolean = true,
+        params: WhisperDecodeParams? = null
+    ): String = withWorker { it.transcribeData(buffer, lang, translate, printTimestamp, params) }
+
+    /** Pooled [WhisperContext.transcribeData] over a heap array. */
+    suspend fun transcribeData(
+        data: FloatArray,
+        lang: String,
+        translate: Boolean,
+        printTimestamp: Boolean = true,
+        params: WhisperDecodeParams? = null
+    ): String = withWorker { it.transcribeData(data, lang, translate, printTimestamp, params) }
+
+    /** Pooled [WhisperContext.transcribeFlow]; the worker is held until the flow completes. */
+    fun transcribeFlow(
+        buffer: FloatBuffer,
+        lang: String,
+        translate: Boolean,
+        params: WhisperDecodeParams? = null,
+        onProgress: ((Int) -> Unit)? = null
+    ): Flow<WhisperSegment> = flow {
+        withWorker { emitAll(it.transcribeFlow(buffer, lang, translate, params, onProgress)) }
+    }
+
+    /**
+     * Long-form transcription for meetings / archive backfill.
+     *
+     * The clip is split natively into chunks of ~[chunkMs] cut inside pauses;
+     * chunks are decoded concurrently, one per free worker, and their
+     * segments stitched onto the clip's timeline. Where no pause exists near
+     * a cut, chunks overlap by [overlapMs] and the seam is de-duplicated (see
+     * [WhisperLongForm.stitch]). Clips shorter than ~2 chunks run as one job.
+     *
+     * Chunks are decoded independently (no text context across a cut).
+     * With "auto" the language is detected once on the clip's first seconds
+     * (see [WhisperContext.resolveLanguage]) and passed to every chunk.
+     *
+     * @param buffer Direct buffer; only read, so jobs share it safely
+     * @param chunkMs nominal chunk length; default ≈ two chunks per worker (1…10 min)
+     * @param overlapMs audio shared across a cut inside speech
+     * @param onChunk called after each chunk with (done, total)
+     * @return segments in clip time, ordered
+     */
+    suspend fun transcribeLong(
+        buffer: FloatBuffer,
+        lang: String,
+        translate: Boolean,
+        params: WhisperDecodeParams? = null,
+        chunkMs: Int? = null,
+        overlapMs: Int = 2_000,
+        onChunk: ((done: Int, total: Int) -> Unit)? = null
+    ): List<WhisperSegment> = coroutineScope {
+        require(buffer.isDirect) { "transcribeLong requires a direct buffer" }
+        val n = buffer.remaining()
+        if (n == 0) return@coroutineScope emptyList()
+        val target = chunkMs?.let { it * 16 } ?: WhisperLongForm.chunkSamples(n, size)
+        val chunks = WhisperLongForm.plan(buffer, target, overlapMs * 16)
+        val language = if (chunks.size > 1) withWorker { it.resolveLanguage(lang, buffer) } else lang
+        Log.i(LOG_TAG, "Long-form: samples=$n chunks=${chunks.size} workers=$size lang=$language")
+
+        val done = java.util.concurrent.atomic.AtomicInteger()
+        val results = chunks.map { chunk ->
+            async {
+                withWorker { w ->
+                    w.transcribeData(WhisperLongForm.slice(buffer, chunk), language, translate, false, params)
+                    w.getSegments()
+                }.also { onChunk?.invoke(done.incrementAndGet(), chunks.size) }
+            }
+        }.awaitAll()
+        WhisperLongForm.stitch(chunks, results)
+    }
+
+    /** Applies [config] to every worker (waits for running jobs). */
+    suspend fun setVad(config: WhisperVadConfig) {
+        repeat(size) { withWorker { it.setVad(config) } }
+    }
+
+    /**
+     * Waits for running jobs, then frees all worker states. The [base]
+     * context stays alive and must be released separately.
+     */
+    suspend fun release() {
+        repeat(size) { free.receive() }
+        free.close()
+        workers.forEach { runCatching { it.release() } }
+        Log.i(LOG_TAG, "Pool released ($size states)")
+    }
+
+    companion object {
+
+        /**
+         * Suggested pool size: one job per 3 performance cores, 1…3.
+         * Fewer, wider jobs beat many narrow ones once memory bandwidth saturates.
+         */
+        fun recommendedSize(): Int =
+            (WhisperCpuConfig.preferredThreadCount / 3).coerceIn(1, 3)
+
+        /**
+         * Splits [cores] into [parts] contiguous, disjoint sets (sizes differ
+         * by at most one), or null if there are fewer cores than parts.
+         */
+        internal fun coreSlices(cores: IntArray, parts: Int): List<List<Int>>? {
+            if (parts < 2 || cores.size < parts) return null
+            val sorted = cores.sorted()
+            return (0 until parts).map { i ->
+                sorted.subList(i * sorted.size / parts, (i + 1) * sorted.size / parts)
+            }
+        }
+
+        /**
+         * Creates [size] states over [base]'s weights and gives each its own
+         * slice of the performance cores, with one thread per core: workers
+         * never compete for a core and memory-bound phases overlap. With fewer
+         * performance cores than workers, all share the set and split
+         * [base]'s thread budget instead.
+         */
+        suspend fun create(base: WhisperContext, size: Int = recommendedSize()): WhisperPool {
+            require(size >= 1) { "size must be >= 1" }
+            val perWorker = (base.threadCount / size).coerceAtLeast(1)
+            val slices = coreSlices(WhisperCpuConfig.performanceCores, size)
+            val workers = ArrayList<WhisperContext>(size)
+            try {
+                repeat(size) { i ->
+                    val w = base.createStateContext()
+                    workers += w
+                    w.setThreadPolicy(
+                        slices?.let { WhisperThreadPolicy(cpus = it[i], threads = it[i].size) }
+                            ?: WhisperThreadPolicy(threads = perWorker)
+                    )
+                }
+            } catch (t: Throwable) {
+                workers.forEach { runCatching { it.release() } }
+                throw t
+            }
+            Log.i(LOG_TAG, "Pool created: states=$size cores/state=${slices?.map { it.size } ?: "shared×$perWorker"}")
+            return WhisperPool(base, workers)
+        }
+    }
+}
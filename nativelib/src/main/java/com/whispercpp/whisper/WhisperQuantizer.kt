@@ -0,0 +1,98 @@
+// file: com/whispercpp/whisper/WhisperQuantizer.kt
+// ============================================================
+// ✅ WhisperQuantizer — On-device model re-quantization
+// ------------------------------------------------------------
+// • Download one f16 master, derive the per-device variant locally
+// • q4_0 / q4_1 / q5_0 / q5_1 / q8_0 / q2_K…q6_K (ggml_common_quantize_0)
+// • Optional mixed precision: keep the encoder at source precision
+// • forDevice(): type picked from the detected CPU features
+// ============================================================
+
+package com.whispercpp.whisper
+
+import android.util.Log
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.withContext
+import java.io.File
+import java.io.IOException
+
+private const val LOG_TAG = "WhisperQuantizer"
+
+/**
+ * Converts a ggml whisper model into another quantization type.
+ *
+ * Typical use (first launch after downloading `ggml-base.bin`):
+ * ```
+ * val dst = File(filesDir, "models/ggml-base-${WhisperQuantizer.forDevice().suffix}.bin")
+ * if (!dst.exists()) WhisperQuantizer.quantize(master, dst)
+ * val ctx = WhisperContext.createContextFromFile(dst.path)
+ * ```
+ */
+object WhisperQuantizer {
+
+    /** Target types; [native] matches `enum ggml_ftype`. */
+    enum class Type(internal val native: Int, val suffix: String) {
+        Q4_0(2, "q4_0"),
+        Q4_1(3, "q4_1"),
+        Q8_0(7, "q8_0"),
+        Q5_0(8, "q5_0"),
+        Q5_1(9, "q5_1"),
+        Q2_K(10, "q2_k"),
+        Q3_K(11, "q3_k"),
+        Q4_K(12, "q4_k"),
+        Q5_K(13, "q5_k"),
+        Q6_K(14, "q6_k")
+    }
+
+    /**
+     * Default type for this CPU:
+     * - i8mm: [Q8_0] — 8-bit matmuls run on SMMLA, near-f16 accuracy
+     * - dotprod: [Q5_1] — SDOT kernels, good size / accuracy balance
+     * - otherwise: [Q4_0] — least memory bandwidth on older cores
+     */
+    fun forDevice(): Type {
+        val f = WhisperCpuFeatures.features
+        return when {
+            f.i8mm -> Type.Q8_0
+            f.dotprod -> Type.Q5_1
+            else -> Type.Q4_0
+        }
+    }
+
+    /**
+     * Writes [src] re-quantized to [type] into [dst] (atomically: a partial
+     * file never appears under [dst]). Runs on [Dispatchers.IO].
+     *
+     * @param keepEncoder keep encoder weights at source precision and
+     *   quantize only the decoder (mixed precision, larger but more accurate)
+     * @throws IOException if the model cannot be read, converted or written
+     */
+    @Throws(IOException::class)
+    suspend fun quantize(
+        src: File,
+        dst: File,
+        type: Type = forDevice(),
+        keepEncoder: Boolean = false
+    ) = withContext(Dispatchers.IO) {
+        if (!src.isFile) throw IOException("Model not found: ${src.path}")
+        dst.parentFile?.mkdirs()
+        val start = System.currentTimeMillis()
+        val rc = WhisperLib.quantizeModel(src.path, dst.path, type.native, keepEncoder)
+        if (rc != 0) throw IOException("Quantization of ${src.name} to ${type.suffix} failed: ${describe(rc)}")
+        Log.i(
+            LOG_TAG,
+            "Quantized ${src.name} → ${dst.name} (${type.suffix}, keepEncoder=$keepEncoder): " +
+                "${src.length() / 1024} KB → ${dst.length() / 1024} KB in ${System.currentTimeMillis() - start} ms"
+        )
+    }
+
+    /** Human-readable `enum quantize_status` (whisperQuantize.h). */
+    private fun describe(rc: Int): String = when (rc) {
+        -1 -> "I/O error"
+        -2 -> "not a ggml whisper model"
+        -3 -> "unsupported type"
+        -4 -> "tensor quantization failed"
+        -5 -> "native library built without WHISPER_QUANTIZE"
+        else -> "error $rc"
+    }
+}
@@ -0,0 +1,117 @@
+// file: com/whispercpp/whisper/WhisperRunStats.kt
+// ============================================================
+// ✅ WhisperRunStats — Structured telemetry of the last transcription
+// ------------------------------------------------------------
+// • Decodes the flat double[] returned by native getLastRunStats()
+// • Per-stage timings, sampling / fallback counts, peak RSS, buffer sizes
+// • Thread count and the .so variant that was loaded
+// • toMap(): flat keys for analytics / fleet dashboards
+// ============================================================
+
+package com.whispercpp.whisper
+
+/**
+ * Load and run telemetry of one [WhisperContext] ([WhisperContext.getLastRunStats]).
+ *
+ * Times are milliseconds; `-1` means not available.
+ *
+ * @property loadMs model load (or cache lookup / state creation) of this context
+ * @property totalMs all whisper_full() attempts of the last run
+ * @property vadMs energy-VAD pre-pass (0 when off)
+ * @property melMs start → first encoder pass: log-mel, plus language detection for "auto"
+ * @property encodeMs all encoder passes
+ * @property decodeMs per single-token decoder call (average)
+ * @property batchdMs per batched decoder call, i.e. beam / best-of steps (average)
+ * @property promptMs per prompt decoder call (average)
+ * @property sampleMs per token-sampling call (average)
+ * @property encodePasses encoder passes (30 s windows, incl. retries)
+ * @property samples sampling steps over all decoders
+ * @property fallbacks temperature fallbacks (windows re-decoded)
+ * @property audioCtxRetries full-context retries after a reduced audio_ctx
+ * @property peakRssDeltaBytes how far the resident-set peak rose during the run
+ * @property peakIsPerRun the kernel let us reset the peak first and no other
+ *   run overlapped this one; otherwise the peak is process-wide (growth beyond
+ *   the lifetime peak, or including concurrent [WhisperPool] runs)
+ * @property computeBufferBytes compute buffers of this context's state
+ * @property kvCacheBytes KV caches of this context's state
+ * @property threads ggml threads used
+ * @property audioSamples 16 kHz samples decoded (after VAD compaction)
+ * @property audioCtx encoder context of the kept result
+ * @property variant native library loaded (e.g. `whisper_v86_i8mm`)
+ */
+data class WhisperRunStats(
+    val loadMs: Double,
+    val totalMs: Double,
+    val vadMs: Double,
+    val melMs: Double,
+    val encodeMs: Double,
+    val decodeMs: Double,
+    val batchdMs: Double,
+    val promptMs: Double,
+    val sampleMs: Double,
+    val encodePasses: Int,
+    val samples: Int,
+    val fallbacks: Int,
+    val audioCtxRetries: Int,
+    val peakRssDeltaBytes: Long,
+    val peakIsPerRun: Boolean,
+    val computeBufferBytes: Long,
+    val kvCacheBytes: Long,
+    val threads: Int,
+    val audioSamples: Int,
+    val audioCtx: WhisperAudioCtx,
+    val variant: String
+) {
+    /** Audio duration of the run in ms. */
+    val audioMs: Double get() = audioSamples / 16.0
+
+    /** Real-time factor (processing / audio time); 0 when nothing was decoded. */
+    val realTimeFactor: Double get() = if (audioSamples > 0) totalMs / audioMs else 0.0
+
+    /** Flat key → value view, e.g. for analytics events. */
+    fun toMap(): Map<String, Any> = linkedMapOf(
+        "load_ms" to loadMs, "total_ms" to totalMs, "vad_ms" to vadMs, "mel_ms" to melMs,
+        "encode_ms" to encodeMs, "decode_ms" to decodeMs, "batchd_ms" to batchdMs,
+        "prompt_ms" to promptMs, "sample_ms" to sampleMs,
+        "encode_passes" to encodePasses, "samples" to samples, "fallbacks" to fallbacks,
+        "audio_ctx_retries" to audioCtxRetries,
+        "peak_rss_delta_bytes" to peakRssDeltaBytes, "peak_is_per_run" to peakIsPerRun,
+        "compute_buffer_bytes" to computeBufferBytes, "kv_cache_bytes" to kvCacheBytes,
+        "threads" to threads, "audio_samples" to audioSamples, "rtf" to realTimeFactor,
+        "audio_ctx" to audioCtx.used, "audio_ctx_initial" to audioCtx.initial,
+        "variant" to variant
+    )
+
+    companion object {
+        /** Must match RUN_STATS_FIELDS in whisperLib.c. */
+        private const val FIELDS = 21
+
+        /** Decodes the native record; null if it is missing or truncated. */
+        internal fun decode(r: DoubleArray?, variant: String): WhisperRunStats? {
+            if (r == null || r.size < FIELDS) return null
+            return WhisperRunStats(
+                loadMs = r[0],
+                totalMs = r[1],
+                vadMs = r[2],
+                melMs = r[3],
+                encodeMs = r[4],
+                decodeMs = r[5],
+                batchdMs = r[6],
+                promptMs = r[7],
+                sampleMs = r[8],
+                encodePasses = r[9].toInt(),
+                samples = r[10].toInt(),
+                fallbacks = r[11].toInt(),
+                audioCtxRetries = r[12].toInt(),
+                peakRssDeltaBytes = r[13].toLong(),
+                peakIsPerRun = r[14] != 0.0,
+                computeBufferBytes = r[15].toLong(),
+                kvCacheBytes = r[16].toLong(),
+                threads = r[17].toInt(),
+                audioSamples = r[18].toInt(),
+                audioCtx = WhisperAudioCtx(r[19].toInt(), r[20].toInt()),
+                variant = variant
+            )
+        }
+    }
+}
@@ -0,0 +1,110 @@
+// file: com/whispercpp/whisper/WhisperSegment.kt
+// ============================================================
+// ✅ WhisperSegment — Immutable decoded segment value
+// ------------------------------------------------------------
+// • Shared by one-shot and streaming transcription results
+// • Timestamps are whisper ticks (10 ms per unit)
+// • Decoder for the packed getAllSegments() native layout
+// • toTranscript(): transcribeData-style text for stitched / collected lists
+// ============================================================
+
+package com.whispercpp.whisper
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * One decoded text segment.
+ *
+ * @property text Segment text as produced by whisper.cpp (leading space preserved)
+ * @property t0 Start time in 10 ms ticks
+ * @property t1 End time in 10 ms ticks
+ * @property tokenProbs Per-token probabilities, when requested (null otherwise);
+ *   compared by content in [equals] / [hashCode]
+ */
+data class WhisperSegment(
+    val text: String,
+    val t0: Long,
+    val t1: Long,
+    val tokenProbs: FloatArray? = null
+) {
+    /** Start time in milliseconds. */
+    val startMs: Long get() = t0 * 10
+
+    /** End time in milliseconds. */
+    val endMs: Long get() = t1 * 10
+
+    // Data-class equality would compare the array by identity.
+    override fun equals(other: Any?): Boolean =
+        this === other || other is WhisperSegment &&
+            text == other.text && t0 == other.t0 && t1 == other.t1 &&
+            tokenProbs.contentEquals(other.tokenProbs)
+
+    override fun hashCode(): Int =
+        ((text.hashCode() * 31 + t0.hashCode()) * 31 + t1.hashCode()) * 31 + tokenProbs.contentHashCode()
+}
+
+/** Header flag mirrored from PACKED_FLAG_TOKEN_PROBS in whisperLib.c. */
+private const val PACKED_FLAG_TOKEN_PROBS = 1
+
+/** Record size mirrored from PACKED_SEGMENT_RECORD in whisperLib.c. */
+private const val PACKED_SEGMENT_RECORD = 32
+
+/** Decodes the packed byte[] returned by `WhisperLib.getAllSegments`. */
+internal fun decodePackedSegments(packed: ByteArray?): List<WhisperSegment> =
+    if (packed == null) emptyList() else decodePackedSegments(ByteBuffer.wrap(packed))
+
+/**
+ * Decodes a packed result (`WhisperLib.getAllSegments` / `getAllSegmentsArena`)
+ * starting at index 0 of [packed]; the buffer's position / order are not used.
+ *
+ * Layout (little-endian): header `[n:i32][flags:i32]`, then n records
+ * `[t0:i64][t1:i64][textOff:i32][textLen:i32][tokOff:i32][tokCount:i32]`,
+ * then optional `f32` token probabilities, then the UTF-8 text blob.
+ */
+internal fun decodePackedSegments(packed: ByteBuffer): List<WhisperSegment> {
+    if (packed.capacity() < 8) return emptyList()
+    val bb = packed.duplicate().order(ByteOrder.LITTLE_ENDIAN)
+    val n = bb.getInt(0)
+    val flags = bb.getInt(4)
+    val recordsStart = 8
+    val probsStart = recordsStart + n * PACKED_SEGMENT_RECORD
+
+    // Token table size is implied by the last record (tokOff + tokCount).
+    val totalTokens = if (n > 0 && flags and PACKED_FLAG_TOKEN_PROBS != 0) {
+        val last = recordsStart + (n - 1) * PACKED_SEGMENT_RECORD
+        bb.getInt(last + 24) + bb.getInt(last + 28)
+    } else 0
+    val textStart = probsStart + totalTokens * 4
+
+    // Whole text blob in one copy (direct buffers have no backing array).
+    val textBytes = if (n > 0) {
+        val last = recordsStart + (n - 1) * PACKED_SEGMENT_RECORD
+        bb.getInt(last + 16) + bb.getInt(last + 20)
+    } else 0
+    val blob = if (bb.hasArray()) bb.array() else ByteArray(textBytes).also {
+        bb.position(textStart)
+        bb.get(it)
+    }
+    val blobStart = if (bb.hasArray()) bb.arrayOffset() + textStart else 0
+
+    return List(n) { i ->
+        val r = recordsStart + i * PACKED_SEGMENT_RECORD
+        val textOff = bb.getInt(r + 16)
+        val textLen = bb.getInt(r + 20)
+        val probs = if (flags and PACKED_FLAG_TOKEN_PROBS != 0) {
+            val tokOff = bb.getInt(r + 24)
+            FloatArray(bb.getInt(r + 28)) { j -> bb.getFloat(probsStart + (tokOff + j) * 4) }
+        } else null
+        WhisperSegment(
+            text = String(blob, blobStart + textOff, textLen, Charsets.UTF_8),
+            t0 = bb.getLong(r),
+            t1 = bb.getLong(r + 8),
+            tokenProbs = probs
+        )
+    }
+}
+
+/** Formats segments like [WhisperContext.transcribeData] (e.g. [WhisperPool.transcribeLong] results). */
+fun List<WhisperSegment>.toTranscript(printTimestamp: Boolean = true): String =
+    formatTranscript(this, printTimestamp)
@@ -0,0 +1,99 @@
+// file: com/whispercpp/whisper/WhisperStream.kt
+// ============================================================
+// ✅ WhisperStream — Live transcription over a native ring buffer
+// ------------------------------------------------------------
+// • push() is thread-safe and cheap (copies into the native ring)
+// • poll() decodes a sliding window on the owning context's JNI thread
+// • Emits only newly stable segments + the current unstable tail
+// • Prompt tokens of the last committed segment carry forward natively
+// ============================================================
+
+package com.whispercpp.whisper
+
+import android.util.Log
+
+private const val LOG_TAG = "WhisperStream"
+
+/**
+ * Streaming session bound to a [WhisperContext].
+ *
+ * Typical loop (live captions):
+ * ```
+ * val stream = ctx.createStream(lang = "en")
+ * recorder feeds → stream.push(pcm)
+ * every ~step → val update = stream.poll(); render(update)
+ * on stop → stream.poll(flush = true); stream.release()
+ * ```
+ *
+ * Threading:
+ * - [push] may be called from any thread (e.g. the recorder thread).
+ * - [poll] and [release] hop onto the owner's dedicated JNI thread and share
+ *   its re-entrancy guard, so they never overlap with [WhisperContext.transcribeData].
+ *
+ * Lifetime: the session must be released before its owning context.
+ */
+class WhisperStream internal constructor(
+    private val owner: WhisperContext,
+    @Volatile private var handle: Long
+) {
+
+    /**
+     * Result of one [poll].
+     *
+     * @property committed Segments that became stable in this poll (absolute timestamps)
+     * @property partial Text of the tail that may still change on the next poll
+     */
+    data class Update(
+        val committed: List<WhisperSegment>,
+        val partial: String
+    )
+
+    /**
+     * Appends 16 kHz mono PCM samples normalized to [-1.0, 1.0].
+     * No-op after [release].
+     */
+    fun push(samples: FloatArray, offset: Int = 0, length: Int = samples.size - offset) {
+        val h = handle
+        if (h == 0L || length <= 0) return
+        WhisperLib.streamPush(h, samples, offset, length)
+    }
+
+    /**
+     * Decodes the current window if at least one step of new audio arrived.
+     * Cancelling the caller aborts the in-flight native decode.
+     *
+     * @param flush If true, decodes whatever is buffered and commits everything
+     *              (use once after the last [push]).
+     */
+    suspend fun poll(flush: Boolean = false): Update = owner.withAbortOnCancel {
+        owner.withNative {
+            val h = handle
+            check(h != 0L) { "WhisperStream: already released" }
+            val n = WhisperLib.streamPoll(h, flush)
+            if (n < 0) {
+                Log.w(LOG_TAG, "streamPoll failed")
+                return@withNative Update(emptyList(), "")
+            }
+            val committed = List(n) { i ->
+                WhisperSegment(
+                    text = WhisperLib.streamGetSegment(h, i),
+                    t0 = WhisperLib.streamGetSegmentT0(h, i),
+                    t1 = WhisperLib.streamGetSegmentT1(h, i)
+                )
+            }
+            Update(committed, WhisperLib.streamGetPartial(h))
+        }
+    }
+
+    /** Frees the native session. Safe to call multiple times. */
+    suspend fun release() {
+        owner.withNative(exclusive = false) {
+            val h = handle
+            handle = 0L
+            if (h != 0L) {
+                WhisperLib.streamClose(h)
+                Log.d(LOG_TAG, "Released stream session")
+            }
+        }
+    }
+}
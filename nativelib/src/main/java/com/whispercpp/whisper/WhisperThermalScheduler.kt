@@ -0,0 +1,233 @@
+// file: com/whispercpp/whisper/WhisperThermalScheduler.kt
+// ============================================================
+// ✅ WhisperThermalScheduler — Sustained-throughput thread / model policy
+// ------------------------------------------------------------
+// • Inputs: PowerManager thermal status + headroom, power-save / battery,
+//   measured encoder ms per pass (WhisperRunStats) vs this session's best
+//   at the same level and audio_ctx bucket
+// • Levels: all performance cores → no prime core → half the threads → 2 threads
+// • Escalates at once, relaxes one level per cool-down period (no oscillation)
+// • Highest level also recommends a smaller model / quant between jobs
+// ============================================================
+
+package com.whispercpp.whisper
+
+import android.content.Context
+import android.content.Intent
+import android.content.IntentFilter
+import android.os.BatteryManager
+import android.os.Build
+import android.os.PowerManager
+import android.os.SystemClock
+import android.util.Log
+import java.util.WeakHashMap
+
+private const val LOG_TAG = "WhisperThermal"
+
+/**
+ * Chooses a [WhisperThreadPolicy] before each job so that throughput stays
+ * flat over a long session instead of collapsing once the SoC throttles.
+ *
+ * Typical use (one scheduler per session, jobs on [ctx]):
+ * ```
+ * val decision = scheduler.apply(ctx)          // before the job
+ * if (decision.downgrade) switchToSmallerModel()
+ * ctx.transcribeData(pcm, "en", false)
+ * ctx.getLastRunStats()?.let(scheduler::record) // after the job
+ * ```
+ *
+ * Measured slowdown catches throttling before the OS reports it: once runs
+ * at a level encode [SLOWDOWN_ESCALATE]× slower than the best run at that
+ * level this session, the level rises. Runs are only compared within one
+ * audio_ctx bucket: encoder cost is not linear in audio_ctx (fixed
+ * overhead, attention terms), so a short autoAudioCtx clip cannot be
+ * rescaled onto a 30 s window's baseline. Fewer threads on the cooler
+ * cores keep the package inside its power budget, which sustains more
+ * throughput than all cores at throttled clocks.
+ *
+ * Not thread-safe; call from one coroutine (e.g. the job launcher).
+ *
+ * @param cores performance cores to schedule on
+ */
+class WhisperThermalScheduler(
+    context: Context,
+    private val cores: IntArray = WhisperCpuConfig.performanceCores
+) {
+    /** Policy for the next job and why it was chosen. */
+    data class Decision(
+        val level: Int,
+        val policy: WhisperThreadPolicy,
+        val downgrade: Boolean,
+        val reason: String
+    )
+
+    private val app = context.applicationContext
+    private val power = app.getSystemService(Context.POWER_SERVICE) as? PowerManager
+    private val prime = WhisperCpuConfig.primeCores
+
+    /** Current level, 0 (nominal) … [MAX_LEVEL]. */
+    var level: Int = 0
+        private set
+    private var levelSinceMs = SystemClock.elapsedRealtime()
+
+    /** Best encoder ms per pass, per (level, audio_ctx bucket) (this session). */
+    private val baselineMs = HashMap<Pair<Int, Int>, Double>()
+    /** Smoothed recent encoder ms per pass, per (level, audio_ctx bucket). */
+    private val recentMs = HashMap<Pair<Int, Int>, Double>()
+    /** audio_ctx bucket of the last recorded run; [slowdown] judges that bucket. */
+    private var lastBucket = -1
+    /** Last policy applied per context, to skip redundant native calls. */
+    private val applied = WeakHashMap<WhisperContext, WhisperThreadPolicy>()
+
+    private var headroom = Float.NaN
+    private var headroomAtMs = 0L
+
+    /**
+     * Picks the policy for the next job from the current signals.
+     * Cheap; the headroom query is rate-limited internally.
+     */
+    fun decide(): Decision {
+        val now = SystemClock.elapsedRealtime()
+        val status = thermalStatus()
+        val room = thermalHeadroom(now)
+        val slowdown = slowdown()
+        val battery = batteryConstrained()
+
+        val target = maxOf(
+            when {
+                status >= PowerManager.THERMAL_STATUS_SEVERE -> 3
+                status >= PowerManager.THERMAL_STATUS_MODERATE -> 2
+                status >= PowerManager.THERMAL_STATUS_LIGHT -> 1
+                else -> 0
+            },
+            when {
+                room.isNaN() -> 0
+                room >= 1.0f -> 3
+                room >= HEADROOM_HOT -> 2
+                room >= HEADROOM_WARM -> 1
+                else -> 0
+            },
+            if (battery) 2 else 0,
+            if (slowdown >= SLOWDOWN_ESCALATE) (level + 1).coerceAtMost(MAX_LEVEL) else 0
+        )
+        when {
+            target > level -> setLevel(target, now)
+            target < level && now - levelSinceMs >= COOL_DOWN_MS -> setLevel(level - 1, now)
+        }
+
+        val reason = "status=$status headroom=${"%.2f".format(room)} " +
+            "slowdown=${"%.2f".format(slowdown)} battery=$battery"
+        return Decision(level, policyFor(level), level >= MAX_LEVEL, reason)
+    }
+
+    /** [decide]s and applies the policy to [ctx] (thread count + affinity). */
+    suspend fun apply(ctx: WhisperContext): Decision {
+        val d = decide()
+        if (d.policy != applied[ctx]) {
+            ctx.setThreadPolicy(d.policy)
+            applied[ctx] = d.policy
+            Log.i(LOG_TAG, "Level ${d.level}: threads=${d.policy.threads} cpus=${d.policy.cpus} (${d.reason})")
+        }
+        return d
+    }
+
+    /**
+     * Feeds back the encoder timing of a run made under the current level.
+     * Runs without an encoder pass (retained mel, empty clip) are ignored.
+     */
+    fun record(stats: WhisperRunStats) {
+        if (stats.encodePasses <= 0 || stats.encodeMs <= 0.0) return
+        // Per pass, kept apart per audio_ctx bucket (autoAudioCtx shrinks short clips).
+        val ctx = stats.audioCtx.used.takeIf { it > 0 } ?: FULL_AUDIO_CTX
+        lastBucket = (ctx + AUDIO_CTX_BUCKET - 1) / AUDIO_CTX_BUCKET
+        val key = level to lastBucket
+        val ms = stats.encodeMs / stats.encodePasses
+        baselineMs[key] = minOf(baselineMs[key] ?: ms, ms)
+        recentMs[key] = recentMs[key]?.let { it + EWMA_ALPHA * (ms - it) } ?: ms
+    }
+
+    /** Recent / best encoder time at the current level, last run's bucket (1.0 = no slowdown). */
+    private fun slowdown(): Double {
+        val key = level to lastBucket
+        val best = baselineMs[key] ?: return 1.0
+        val recent = recentMs[key] ?: return 1.0
+        return recent / best
+    }
+
+    private fun setLevel(next: Int, now: Long) {
+        Log.i(LOG_TAG, "Thermal level $level → $next")
+        level = next
+        levelSinceMs = now
+        recentMs.keys.removeAll { it.first == next }  // judge the new configuration on fresh runs only
+    }
+
+    /** Thread policy for a level; explicit cores so that the mask follows the level too. */
+    private fun policyFor(level: Int): WhisperThreadPolicy {
+        val all = cores.sorted()
+        if (all.isEmpty()) {
+            val n = WhisperCpuConfig.preferredThreadCount
+            return WhisperThreadPolicy(threads = threadsFor(level, n))
+        }
+        val set = when (level) {
+            0 -> all
+            // Prime cores throttle first and hardest; keep the rest busy.
+            else -> all.filterNot { it in prime }.takeIf { it.size >= 2 } ?: all
+        }
+        val n = threadsFor(level, set.size)
+        return WhisperThreadPolicy(cpus = set.take(n), threads = n)
+    }
+
+    private fun threadsFor(level: Int, available: Int): Int = when (level) {
+        0, 1 -> available
+        2 -> (available / 2).coerceAtLeast(2)
+        else -> 2
+    }.coerceIn(1, available.coerceAtLeast(1))
+
+    private fun thermalStatus(): Int =
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.Q) power?.currentThermalStatus ?: 0 else 0
+
+    /** Forecast headroom 10 s ahead (1.0 = throttling); NaN if unsupported. */
+    private fun thermalHeadroom(now: Long): Float {
+        if (Build.VERSION.SDK_INT < Build.VERSION_CODES.R) return Float.NaN
+        // The platform returns NaN when polled more often than about once a second.
+        if (now - headroomAtMs >= HEADROOM_POLL_MS) {
+            headroom = power?.getThermalHeadroom(HEADROOM_FORECAST_S) ?: Float.NaN
+            headroomAtMs = now
+        }
+        return headroom
+    }
+
+    /** Power-save mode, or discharging below [LOW_BATTERY_PERCENT]. */
+    private fun batteryConstrained(): Boolean {
+        if (power?.isPowerSaveMode == true) return true
+        val battery = app.registerReceiver(null, IntentFilter(Intent.ACTION_BATTERY_CHANGED)) ?: return false
+        val plugged = battery.getIntExtra(BatteryManager.EXTRA_PLUGGED, 0) != 0
+        val level = battery.getIntExtra(BatteryManager.EXTRA_LEVEL, -1)
+        val scale = battery.getIntExtra(BatteryManager.EXTRA_SCALE, 100)
+        return !plugged && level >= 0 && scale > 0 && level * 100 / scale < LOW_BATTERY_PERCENT
+    }
+
+    companion object {
+        const val MAX_LEVEL = 3
+
+        /** Relax one level no sooner than this after the last change. */
+        const val COOL_DOWN_MS = 60_000L
+        private const val HEADROOM_POLL_MS = 5_000L
+        private const val HEADROOM_FORECAST_S = 10
+        private const val HEADROOM_WARM = 0.8f
+        private const val HEADROOM_HOT = 0.95f
+        private const val SLOWDOWN_ESCALATE = 1.35
+        private const val EWMA_ALPHA = 0.5
+        private const val LOW_BATTERY_PERCENT = 15
+        private const val FULL_AUDIO_CTX = 1500
+        /** audio_ctx frames per baseline bucket (≈ 5 s of audio). */
+        private const val AUDIO_CTX_BUCKET = 256
+
+        /**
+         * Next smaller entry of [ladder] (largest first) after [current], or
+         * null if [current] is already the smallest or not on the ladder.
+         */
+        fun smallerModel(current: String, ladder: List<String>): String? =
+            ladder.indexOf(current).takeIf { it >= 0 }?.let { ladder.getOrNull(it + 1) }
+    }
+}
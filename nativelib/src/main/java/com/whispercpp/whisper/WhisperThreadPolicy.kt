@@ -0,0 +1,59 @@
+// file: com/whispercpp/whisper/WhisperThreadPolicy.kt
+// ============================================================
+// ✅ WhisperThreadPolicy — Core pinning + priority for ggml workers
+// ------------------------------------------------------------
+// • Affinity built from the same /sys frequency data as thread counts
+// • Applied natively to the context thread before every whisper_full()
+// • ggml workers are spawned from that thread and inherit mask + nice
+// ============================================================
+
+package com.whispercpp.whisper
+
+/**
+ * Where and how a [WhisperContext] runs its compute threads.
+ *
+ * Keep [threads] ≤ the pinned core count: oversubscribing a pinned set makes
+ * workers time-slice on the same cores and re-creates the straggler effect.
+ *
+ * @property affinity core selection for the JNI thread and its ggml workers
+ * @property threads ggml worker count per run (defaults to the pinned set size)
+ * @property nice Linux nice value (−20…19); null leaves the priority unchanged
+ * @property cpus explicit core indices (overrides [affinity]), e.g. one
+ *   [WhisperPool] worker's slice of the performance cores
+ */
+data class WhisperThreadPolicy(
+    val affinity: Affinity = Affinity.PERFORMANCE,
+    val threads: Int? = null,
+    val nice: Int? = null,
+    val cpus: List<Int>? = null
+) {
+    /** Core sets derived from [WhisperCpuConfig]. */
+    enum class Affinity {
+        /** No pinning; the scheduler may migrate workers onto LITTLE cores. */
+        ALL,
+        /** Cores faster than the slowest cluster (big + prime). */
+        PERFORMANCE,
+        /** Only the highest-frequency cluster. */
+        PRIME
+    }
+
+    /** Core indices for [cpus] / [affinity]; empty means all online CPUs. */
+    internal fun cores(): IntArray = cpus?.toIntArray() ?: when (affinity) {
+        Affinity.ALL -> IntArray(0)
+        Affinity.PERFORMANCE -> WhisperCpuConfig.performanceCores
+        Affinity.PRIME -> WhisperCpuConfig.primeCores.takeIf { it.size >= 2 }
+            ?: WhisperCpuConfig.performanceCores
+    }
+
+    /** Worker count implied by this policy (≥ 1). */
+    internal fun threadCount(pinned: IntArray): Int = when {
+        threads != null -> threads.coerceAtLeast(1)
+        pinned.isNotEmpty() -> pinned.size
+        else -> WhisperCpuConfig.preferredThreadCount
+    }
+
+    companion object {
+        /** Default: pin to performance cores, one worker per pinned core. */
+        val DEFAULT = WhisperThreadPolicy()
+    }
+}
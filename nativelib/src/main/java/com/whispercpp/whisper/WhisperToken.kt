@@ -0,0 +1,167 @@
+// file: com/whispercpp/whisper/WhisperToken.kt
+// ============================================================
+// ✅ WhisperToken — Token / word timing from the same whisper_full() run
+// ------------------------------------------------------------
+// • Decoder for the packed getAllTokens() native layout
+// • Per token: id, text, p, t0 / t1 (token timestamps), t_dtw (DTW alignment)
+// • toWords(): tokens merged at leading spaces, timed by DTW when available
+// • WhisperAlignmentHeads: DTW head preset per model, chosen before loading
+// ============================================================
+
+package com.whispercpp.whisper
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * One decoded token of [WhisperContext.getTokens]. Times are whisper ticks
+ * (10 ms per unit) on the clip's timeline, or -1 when not computed.
+ *
+ * @property segment index of the segment the token belongs to
+ * @property id vocabulary id (≥ EOT for timestamp / control tokens)
+ * @property text token text (BPE piece; a leading space starts a word)
+ * @property p token probability
+ * @property t0 start from whisper's token timestamps ([WhisperDecodeParams.tokenTimestamps])
+ * @property t1 end from whisper's token timestamps
+ * @property tDtw DTW-aligned time (model loaded with [WhisperAlignmentHeads])
+ */
+data class WhisperToken(
+    val segment: Int,
+    val id: Int,
+    val text: String,
+    val p: Float,
+    val t0: Long,
+    val t1: Long,
+    val tDtw: Long
+) {
+    /** Best available start: the DTW time, else [t0] (ticks, -1 if neither). */
+    val start: Long get() = if (tDtw >= 0) tDtw else t0
+}
+
+/**
+ * One word of [toWords]: consecutive tokens of a segment up to the
+ * next token with a leading space.
+ *
+ * @property t0 start in 10 ms ticks
+ * @property t1 end in 10 ms ticks
+ * @property p mean probability of the word's tokens
+ */
+data class WhisperWord(
+    val text: String,
+    val t0: Long,
+    val t1: Long,
+    val p: Float
+) {
+    /** Start time in milliseconds. */
+    val startMs: Long get() = t0 * 10
+
+    /** End time in milliseconds. */
+    val endMs: Long get() = t1 * 10
+}
+
+/**
+ * Alignment-head presets for DTW token timestamps; values match
+ * `enum whisper_alignment_heads_preset`. Heads are fixed when a model is
+ * loaded: set them with [WhisperContext.setAlignmentHeads] first.
+ */
+enum class WhisperAlignmentHeads(internal val native: Int) {
+    NONE(0),
+    /** Heads of the top text layers; works for any model, less precise. */
+    N_TOP_MOST(1),
+    TINY_EN(3), TINY(4), BASE_EN(5), BASE(6), SMALL_EN(7), SMALL(8),
+    MEDIUM_EN(9), MEDIUM(10), LARGE_V1(11), LARGE_V2(12), LARGE_V3(13), LARGE_V3_TURBO(14);
+
+    companion object {
+        /**
+         * Preset for a ggml model file name ("ggml-base.en-q5_1.bin" →
+         * [BASE_EN]); [N_TOP_MOST] when the size is not recognized.
+         */
+        fun forModel(fileName: String): WhisperAlignmentHeads {
+            val name = fileName.substringAfterLast('/').lowercase()
+            val english = ".en" in name
+            return when {
+                "large-v3-turbo" in name -> LARGE_V3_TURBO
+                "large-v3" in name -> LARGE_V3
+                "large-v2" in name -> LARGE_V2
+                "large-v1" in name -> LARGE_V1
+                "medium" in name -> if (english) MEDIUM_EN else MEDIUM
+                "small" in name -> if (english) SMALL_EN else SMALL
+                "base" in name -> if (english) BASE_EN else BASE
+                "tiny" in name -> if (english) TINY_EN else TINY
+                else -> N_TOP_MOST
+            }
+        }
+    }
+}
+
+/** Record size mirrored from PACKED_TOKEN_RECORD in whisperLib.c. */
+private const val PACKED_TOKEN_RECORD = 44
+
+/**
+ * Decodes the packed byte[] returned by `WhisperLib.getAllTokens`.
+ *
+ * Layout (little-endian): header `[n:i32][flags:i32]`, then n records
+ * `[t0:i64][t1:i64][tDtw:i64][segment:i32][id:i32][p:f32][textOff:i32][textLen:i32]`,
+ * then the UTF-8 text blob.
+ */
+internal fun decodePackedTokens(packed: ByteArray?): List<WhisperToken> {
+    if (packed == null || packed.size < 8) return emptyList()
+    val bb = ByteBuffer.wrap(packed).order(ByteOrder.LITTLE_ENDIAN)
+    val n = bb.getInt(0)
+    val textStart = 8 + n * PACKED_TOKEN_RECORD
+    return List(n) { i ->
+        val r = 8 + i * PACKED_TOKEN_RECORD
+        WhisperToken(
+            segment = bb.getInt(r + 24),
+            id = bb.getInt(r + 28),
+            text = String(packed, textStart + bb.getInt(r + 36), bb.getInt(r + 40), Charsets.UTF_8),
+            p = bb.getFloat(r + 32),
+            t0 = bb.getLong(r),
+            t1 = bb.getLong(r + 8),
+            tDtw = bb.getLong(r + 16)
+        )
+    }
+}
+
+/**
+ * Groups text tokens (as from `getTokens(includeSpecial = false)`) into
+ * words: a token with a leading space, or the first token of a segment,
+ * starts a new word.
+ *
+ * With DTW times a word runs from its first token's alignment to the next
+ * word's; otherwise from its first token's t0 to its last token's t1.
+ * Scripts written without spaces (ja, zh) yield one word per segment;
+ * use the tokens themselves there.
+ */
+fun List<WhisperToken>.toWords(): List<WhisperWord> {
+    val groups = ArrayList<List<WhisperToken>>()
+    var current = ArrayList<WhisperToken>()
+    for (tok in this) {
+        val boundary = current.isNotEmpty() &&
+            (tok.segment != current.last().segment || tok.text.startsWith(" "))
+        if (boundary) {
+            groups.add(current)
+            current = ArrayList()
+        }
+        current += tok
+    }
+    if (current.isNotEmpty()) groups.add(current)
+
+    return groups.mapIndexed { gi, g ->
+        val first = g.first()
+        val last = g.last()
+        val next = groups.getOrNull(gi + 1)?.first()?.takeIf { it.segment == first.segment }
+        val t0 = first.start
+        val t1 = when {
+            last.tDtw >= 0 && next != null && next.tDtw >= 0 -> next.tDtw
+            last.t1 >= 0 -> last.t1
+            else -> last.start
+        }
+        WhisperWord(
+            text = g.joinToString("") { it.text }.trim(),
+            t0 = t0,
+            t1 = maxOf(t0, t1),
+            p = g.map { it.p }.average().toFloat()
+        )
+    }
+}
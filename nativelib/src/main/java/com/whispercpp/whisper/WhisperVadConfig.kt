@@ -0,0 +1,41 @@
+// file: com/whispercpp/whisper/WhisperVadConfig.kt
+// ============================================================
+// ✅ WhisperVadConfig — Silence skipping before whisper_full()
+// ------------------------------------------------------------
+// • ENERGY: native RMS + zero-crossing detector (NEON), no model needed
+// • MODEL : whisper.cpp built-in VAD with a ggml Silero model file
+// • Only speech regions reach the encoder; timestamps stay on the
+//   original timeline
+// ============================================================
+
+package com.whispercpp.whisper
+
+/**
+ * Voice-activity pre-pass applied by [WhisperContext.transcribeData].
+ *
+ * @property mode detector to use
+ * @property modelPath Silero VAD model (e.g. `ggml-silero-v5.1.2.bin`) for
+ *   [Mode.MODEL]; without it MODEL falls back to [Mode.ENERGY]
+ * @property thresholdDb ENERGY: speech margin above the clip's noise floor
+ * @property speechProbability MODEL: speech probability threshold
+ * @property minSpeechMs detections shorter than this are dropped
+ * @property minSilenceMs pauses shorter than this are bridged
+ * @property padMs context kept before/after each speech region
+ */
+data class WhisperVadConfig(
+    val mode: Mode = Mode.ENERGY,
+    val modelPath: String? = null,
+    val thresholdDb: Float = 12f,
+    val speechProbability: Float = 0.5f,
+    val minSpeechMs: Int = 200,
+    val minSilenceMs: Int = 400,
+    val padMs: Int = 200
+) {
+    /** Native values match `enum jni_vad_mode` in whisperLib.c. */
+    enum class Mode(internal val native: Int) { OFF(0), ENERGY(1), MODEL(2) }
+
+    companion object {
+        /** Disables the pre-pass (every sample goes through the encoder). */
+        val OFF = WhisperVadConfig(mode = Mode.OFF)
+    }
+}
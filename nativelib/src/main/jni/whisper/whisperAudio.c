@@ -0,0 +1,794 @@
+// file: whisperAudio.c
+// ============================================================
+// ✅ whisperAudio — Native PCM decode / downmix / resample
+// ------------------------------------------------------------
+// • mmap()-based WAV reader (no Java-heap copy of the file)
+// • NEON downmix for mono/stereo PCM16 and float32
+// • Rational polyphase windowed-sinc resampler:
+//     L/M = dst/src reduced by gcd, Kaiser(β=8.6) window,
+//     12 zero crossings per side, unity DC gain per phase
+// • Streaming form of the same filter for chunked decoders (bounded memory)
+// • Energy / ZCR VAD and long-form chunk planning at pauses
+// ============================================================
+
+#include "whisperAudio.h"
+
+#include <android/log.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AUDIO_HAVE_NEON 1
+#endif
+
+#define TAG "JNI-WhisperAudio"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN,  TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+/** Zero crossings of the sinc kernel on each side (at the filter cutoff). */
+#define RESAMPLER_ZERO_CROSSINGS 12
+/**
+ * Cutoff as a share of the lower Nyquist. The Kaiser transition band is
+ * centred on the cutoff, so 8% of headroom keeps its upper half from
+ * aliasing back below Nyquist (16 kHz output: passband to ~7.4 kHz).
+ */
+#define RESAMPLER_CUTOFF 0.92
+/** Kaiser window shape (≈ 80 dB stop-band attenuation). */
+#define RESAMPLER_KAISER_BETA 8.6
+/** Upper bound on stored phases; larger L values are phase-quantized. */
+#define RESAMPLER_MAX_PHASES 1024
+
+/* ============================================================
+ * File mapping + RIFF parsing
+ * ============================================================ */
+
+int audio_map_file(const char *path, struct mapped_file *out) {
+    memset(out, 0, sizeof(*out));
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) { LOGE("open() failed: %s", path); return AUDIO_ERR_IO; }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        LOGE("fstat() failed or empty file: %s", path);
+        close(fd);
+        return AUDIO_ERR_IO;
+    }
+
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // mapping keeps its own reference
+    if (p == MAP_FAILED) { LOGE("mmap() failed: %s", path); return AUDIO_ERR_IO; }
+    madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    out->bytes = (const uint8_t *)p;
+    out->len = (size_t)st.st_size;
+    return AUDIO_OK;
+}
+
+void audio_unmap_file(struct mapped_file *m) {
+    if (m && m->bytes) munmap((void *)m->bytes, m->len);
+    if (m) { m->bytes = NULL; m->len = 0; }
+}
+
+static inline uint16_t rd_u16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static inline uint32_t rd_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+int wav_parse(const uint8_t *bytes, size_t len, struct wav_info *out) {
+    memset(out, 0, sizeof(*out));
+    if (!bytes || len < 44) return AUDIO_ERR_MALFORMED;
+    if (memcmp(bytes, "RIFF", 4) != 0 || memcmp(bytes + 8, "WAVE", 4) != 0) return AUDIO_ERR_MALFORMED;
+
+    bool have_fmt = false;
+    size_t pos = 12;
+    while (pos + 8 <= len) {
+        const uint8_t *id = bytes + pos;
+        const size_t size = rd_u32(bytes + pos + 4);
+        const size_t start = pos + 8;
+        const size_t end = (size > len - start) ? len : start + size;
+
+        if (memcmp(id, "fmt ", 4) == 0) {
+            if (end - start < 16) return AUDIO_ERR_MALFORMED;
+            const uint8_t *f = bytes + start;
+            out->format      = rd_u16(f);
+            out->channels    = rd_u16(f + 2);
+            out->sample_rate = (int)rd_u32(f + 4);
+            out->bits        = rd_u16(f + 14);
+            // WAVE_FORMAT_EXTENSIBLE: the sub-format GUID starts with the real tag.
+            if (out->format == WAV_FORMAT_EXTENSIBLE && end - start >= 26) out->format = rd_u16(f + 24);
+            have_fmt = true;
+        } else if (memcmp(id, "data", 4) == 0) {
+            out->data = bytes + start;
+            out->data_size = end - start;
+            if (have_fmt) break;
+        }
+
+        // Chunks are padded to even sizes.
+        const size_t padded = size + (size & 1);
+        if (padded > len - start) break;
+        pos = start + padded;
+    }
+
+    if (!have_fmt || !out->data || out->data_size == 0) return AUDIO_ERR_MALFORMED;
+    if (out->channels <= 0 || out->sample_rate <= 0) return AUDIO_ERR_MALFORMED;
+    if (!(out->format == WAV_FORMAT_PCM && out->bits == 16) &&
+        !(out->format == WAV_FORMAT_IEEE_FLOAT && out->bits == 32)) {
+        LOGW("Unsupported WAV encoding: format=%d bits=%d", out->format, out->bits);
+        return AUDIO_ERR_FORMAT;
+    }
+    out->frames = out->data_size / ((size_t)(out->bits / 8) * (size_t)out->channels);
+    return out->frames > 0 ? AUDIO_OK : AUDIO_ERR_MALFORMED;
+}
+
+/* ============================================================
+ * Downmix to mono float
+ * ============================================================ */
+
+void audio_pcm16_to_mono(const uint8_t *in, size_t frames, int channels, float *out) {
+    const float scale = 1.0f / 32768.0f;
+    size_t i = 0;
+#ifdef AUDIO_HAVE_NEON
+    if (channels == 1) {
+        const float32x4_t k = vdupq_n_f32(scale);
+        for (; i + 8 <= frames; i += 8) {
+            const int16x8_t s = vreinterpretq_s16_u8(vld1q_u8(in + i * 2));
+            vst1q_f32(out + i,     vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))),  k));
+            vst1q_f32(out + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))), k));
+        }
+    } else if (channels == 2) {
+        const float32x4_t k = vdupq_n_f32(scale * 0.5f);
+        for (; i + 8 <= frames; i += 8) {
+            int16x8x2_t s;
+            s.val[0] = vreinterpretq_s16_u8(vld1q_u8(in + i * 4));
+            s.val[1] = vreinterpretq_s16_u8(vld1q_u8(in + i * 4 + 16));
+            const int16x8x2_t lr = vuzpq_s16(s.val[0], s.val[1]);  // de-interleave L/R
+            const int32x4_t lo = vaddl_s16(vget_low_s16(lr.val[0]),  vget_low_s16(lr.val[1]));
+            const int32x4_t hi = vaddl_s16(vget_high_s16(lr.val[0]), vget_high_s16(lr.val[1]));
+            vst1q_f32(out + i,     vmulq_f32(vcvtq_f32_s32(lo), k));
+            vst1q_f32(out + i + 4, vmulq_f32(vcvtq_f32_s32(hi), k));
+        }
+    }
+#endif
+    const float norm = scale / (float)channels;
+    for (; i < frames; ++i) {
+        const uint8_t *f = in + i * 2 * (size_t)channels;
+        int32_t acc = 0;
+        for (int c = 0; c < channels; ++c) acc += (int16_t)rd_u16(f + 2 * c);
+        out[i] = (float)acc * norm;
+    }
+}
+
+static inline float clampf(float v) { return v < -1.0f ? -1.0f : (v > 1.0f ? 1.0f : v); }
+
+void audio_f32_to_mono(const uint8_t *in, size_t frames, int channels, float *out) {
+    size_t i = 0;
+#ifdef AUDIO_HAVE_NEON
+    const float32x4_t lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(1.0f);
+    if (channels == 1) {
+        for (; i + 4 <= frames; i += 4) {
+            const float32x4_t v = vreinterpretq_f32_u8(vld1q_u8(in + i * 4));
+            vst1q_f32(out + i, vminq_f32(vmaxq_f32(v, lo), hi));
+        }
+    } else if (channels == 2) {
+        const float32x4_t half = vdupq_n_f32(0.5f);
+        for (; i + 4 <= frames; i += 4) {
+            const float32x4_t a = vreinterpretq_f32_u8(vld1q_u8(in + i * 8));
+            const float32x4_t b = vreinterpretq_f32_u8(vld1q_u8(in + i * 8 + 16));
+            const float32x4x2_t lr = vuzpq_f32(a, b);
+            const float32x4_t m = vmulq_f32(vaddq_f32(lr.val[0], lr.val[1]), half);
+            vst1q_f32(out + i, vminq_f32(vmaxq_f32(m, lo), hi));
+        }
+    }
+#endif
+    for (; i < frames; ++i) {
+        const uint8_t *f = in + i * 4 * (size_t)channels;
+        float acc = 0.0f;
+        for (int c = 0; c < channels; ++c) {
+            float v;
+            memcpy(&v, f + 4 * c, 4);
+            acc += v;
+        }
+        out[i] = clampf(acc / (float)channels);
+    }
+}
+
+/* ============================================================
+ * Polyphase windowed-sinc resampler
+ * ============================================================ */
+
+/**
+ * Filter bank for output/input ratio L/M.
+ *
+ * Output sample n sits at input position t = n·M/L = ip + phase/L; it is
+ * the dot product of `taps` contiguous input samples starting at
+ * ip - half + 1 with row `phase` of `bank`.
+ */
+struct audio_resampler {
+    int64_t L;
+    int64_t M;
+    int     phases;   // rows stored (== L unless quantized)
+    int     taps;     // coefficients per row (even)
+    int     half;     // taps / 2
+    float  *bank;     // phases × taps
+};
+
+static int64_t gcd64(int64_t a, int64_t b) {
+    while (b) { const int64_t t = a % b; a = b; b = t; }
+    return a;
+}
+
+/** Zeroth-order modified Bessel function (series; converges fast for β ≤ 10). */
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    const double q = x * x / 4.0;
+    for (int k = 1; k < 64; ++k) {
+        term *= q / ((double)k * (double)k);
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+size_t audio_resampled_length(size_t frames, int src_rate, int dst_rate) {
+    if (frames == 0 || src_rate <= 0 || dst_rate <= 0) return frames;
+    if (src_rate == dst_rate) return frames;
+    const size_t n = (size_t)(((uint64_t)frames * (uint64_t)dst_rate) / (uint64_t)src_rate);
+    return n > 0 ? n : 1;
+}
+
+struct audio_resampler* audio_resampler_create(int src_rate, int dst_rate) {
+    if (src_rate <= 0 || dst_rate <= 0) return NULL;
+
+    struct audio_resampler *r = calloc(1, sizeof(*r));
+    if (!r) return NULL;
+
+    const int64_t g = gcd64(src_rate, dst_rate);
+    r->L = dst_rate / g;
+    r->M = src_rate / g;
+    r->phases = (r->L > RESAMPLER_MAX_PHASES) ? RESAMPLER_MAX_PHASES : (int)r->L;
+
+    // Cutoff relative to the input Nyquist: the lower of both Nyquists
+    // (1 when upsampling, L/M when downsampling), less the transition headroom.
+    const double fc = RESAMPLER_CUTOFF * ((r->L >= r->M) ? 1.0 : (double)r->L / (double)r->M);
+    r->half = (int)ceil(RESAMPLER_ZERO_CROSSINGS / fc);
+    r->taps = 2 * r->half;
+
+    r->bank = malloc((size_t)r->phases * (size_t)r->taps * sizeof(float));
+    if (!r->bank) { free(r); return NULL; }
+
+    const double i0_beta = bessel_i0(RESAMPLER_KAISER_BETA);
+    const double width = (double)r->half;
+    for (int p = 0; p < r->phases; ++p) {
+        const double frac = (double)p / (double)r->phases;
+        float *row = r->bank + (size_t)p * (size_t)r->taps;
+        double sum = 0.0;
+        for (int k = 0; k < r->taps; ++k) {
+            // Distance from the output position to input sample (ip - half + 1 + k).
+            const double d = frac + (double)(r->half - 1 - k);
+            const double x = d * fc;
+            const double sinc = (fabs(x) < 1e-9) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+            const double u = d / width;
+            const double w = (fabs(u) >= 1.0) ? 0.0 : bessel_i0(RESAMPLER_KAISER_BETA * sqrt(1.0 - u * u)) / i0_beta;
+            const double c = fc * sinc * w;
+            row[k] = (float)c;
+            sum += c;
+        }
+        // Unity DC gain per phase removes ripple from truncation.
+        if (sum != 0.0) for (int k = 0; k < r->taps; ++k) row[k] = (float)(row[k] / sum);
+    }
+
+    LOGD("Resampler %d→%d Hz: L=%lld M=%lld phases=%d taps=%d",
+         src_rate, dst_rate, (long long)r->L, (long long)r->M, r->phases, r->taps);
+    return r;
+}
+
+int audio_resampler_padding(const struct audio_resampler *r) {
+    return r ? r->half : 0;
+}
+
+/** Dot product of two float vectors of even length n. */
+static inline float dot_f32(const float *a, const float *b, int n) {
+    int k = 0;
+#ifdef AUDIO_HAVE_NEON
+    float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f);
+    for (; k + 8 <= n; k += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + k),     vld1q_f32(b + k));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + k + 4), vld1q_f32(b + k + 4));
+    }
+    const float32x4_t acc = vaddq_f32(acc0, acc1);
+    float sum = vgetq_lane_f32(acc, 0) + vgetq_lane_f32(acc, 1) +
+                vgetq_lane_f32(acc, 2) + vgetq_lane_f32(acc, 3);
+#else
+    float sum = 0.0f;
+#endif
+    for (; k < n; ++k) sum += a[k] * b[k];
+    return sum;
+}
+
+/** Output sample i; `in` is indexed by absolute input position (ip - half + 1 … ip + half). */
+static inline float resample_at(const struct audio_resampler *r, const float *in, int64_t i) {
+    const int64_t pos = i * r->M;
+    const int64_t ip = pos / r->L;
+    const int64_t rem = pos % r->L;
+    const int phase = (r->phases == r->L) ? (int)rem : (int)((rem * r->phases) / r->L);
+    const float *row = r->bank + (size_t)phase * (size_t)r->taps;
+    return clampf(dot_f32(in + ip - r->half + 1, row, r->taps));
+}
+
+void audio_resampler_run(const struct audio_resampler *r, const float *in, size_t frames, float *out) {
+    const size_t n_out = (size_t)(((uint64_t)frames * (uint64_t)r->L) / (uint64_t)r->M);
+    const size_t n = n_out > 0 ? n_out : 1;
+    for (size_t i = 0; i < n; ++i) out[i] = resample_at(r, in, (int64_t)i);
+}
+
+void audio_resampler_free(struct audio_resampler *r) {
+    if (!r) return;
+    free(r->bank);
+    free(r);
+}
+
+/* ============================================================
+ * Streaming resampler (chunked input, e.g. AMediaCodec output)
+ * ============================================================ */
+
+/**
+ * Window over the input: buf[k] is input sample base + k. Starts with
+ * `half` zeros (base = -half) so the first outputs see the same zero
+ * padding as audio_resampler_run(); consumed history is shifted out after
+ * every push, so the window stays ≈ one input chunk + taps.
+ */
+struct audio_stream_resampler {
+    struct audio_resampler *r;    // NULL when src == dst (copy through)
+    float   *buf;
+    size_t   len;
+    size_t   cap;
+    int64_t  base;
+    int64_t  n_in;                // real samples pushed
+    int64_t  n_out;               // samples emitted
+};
+
+struct audio_stream_resampler* audio_stream_resampler_create(int src_rate, int dst_rate) {
+    if (src_rate <= 0 || dst_rate <= 0) return NULL;
+    struct audio_stream_resampler *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    if (src_rate == dst_rate) return s;
+
+    s->r = audio_resampler_create(src_rate, dst_rate);
+    if (!s->r) { free(s); return NULL; }
+    const int half = s->r->half;
+    s->cap = 4 * (size_t)s->r->taps;
+    s->buf = calloc(s->cap, sizeof(float));
+    if (!s->buf) { audio_resampler_free(s->r); free(s); return NULL; }
+    s->len = (size_t)half;
+    s->base = -half;
+    return s;
+}
+
+/** Appends n samples (NULL: zeros) to the window, growing it if needed. */
+static bool stream_append(struct audio_stream_resampler *s, const float *in, size_t n) {
+    if (s->len + n > s->cap) {
+        size_t cap = s->cap;
+        while (cap < s->len + n) cap *= 2;
+        float *nb = realloc(s->buf, cap * sizeof(float));
+        if (!nb) return false;
+        s->buf = nb;
+        s->cap = cap;
+    }
+    if (in) memcpy(s->buf + s->len, in, n * sizeof(float));
+    else memset(s->buf + s->len, 0, n * sizeof(float));
+    s->len += n;
+    return true;
+}
+
+/**
+ * Emits every output whose filter support lies inside the window, up to
+ * `limit` outputs in total (INT64_MAX while streaming), then drops the
+ * history no later output needs.
+ */
+static size_t stream_drain(struct audio_stream_resampler *s, int64_t limit, float *out, size_t cap) {
+    const struct audio_resampler *r = s->r;
+    const int64_t end = s->base + (int64_t)s->len;  // one past the last buffered input
+    const float *abs_in = s->buf - s->base;         // abs_in[t] == input sample t
+    size_t w = 0;
+    while (w < cap && s->n_out < limit) {
+        const int64_t ip = (s->n_out * r->M) / r->L;
+        if (ip + r->half >= end) break;
+        out[w++] = resample_at(r, abs_in, s->n_out++);
+    }
+
+    const int64_t keep_from = (s->n_out * r->M) / r->L - r->half + 1;
+    if (keep_from > s->base) {
+        const size_t drop = (size_t)(keep_from - s->base);
+        if (drop < s->len) {
+            memmove(s->buf, s->buf + drop, (s->len - drop) * sizeof(float));
+            s->len -= drop;
+        } else {
+            s->len = 0;
+        }
+        s->base = keep_from;
+    }
+    return w;
+}
+
+int audio_stream_resampler_push(struct audio_stream_resampler *s, const float *in, size_t n,
+                                float *out, size_t cap, size_t *written) {
+    *written = 0;
+    if (!s->r) {
+        if (n > cap) return AUDIO_ERR_CAPACITY;
+        memcpy(out, in, n * sizeof(float));
+        s->n_in += (int64_t)n;
+        s->n_out += (int64_t)n;
+        *written = n;
+        return AUDIO_OK;
+    }
+    if (!stream_append(s, in, n)) return AUDIO_ERR_NOMEM;
+    s->n_in += (int64_t)n;
+    *written = stream_drain(s, INT64_MAX, out, cap);
+    // Outputs left in the window because `out` was full would be lost.
+    const int64_t ip = (s->n_out * s->r->M) / s->r->L;
+    return (ip + s->r->half < s->base + (int64_t)s->len) ? AUDIO_ERR_CAPACITY : AUDIO_OK;
+}
+
+int audio_stream_resampler_finish(struct audio_stream_resampler *s, float *out, size_t cap, size_t *written) {
+    *written = 0;
+    if (!s->r || s->n_in == 0) return AUDIO_OK;
+    if (!stream_append(s, NULL, (size_t)s->r->half + 1)) return AUDIO_ERR_NOMEM;
+    const int64_t total = (int64_t)audio_resampled_length((size_t)s->n_in,
+                                                          (int)s->r->M, (int)s->r->L);
+    *written = stream_drain(s, total, out, cap);
+    return (s->n_out < total) ? AUDIO_ERR_CAPACITY : AUDIO_OK;
+}
+
+void audio_stream_resampler_free(struct audio_stream_resampler *s) {
+    if (!s) return;
+    audio_resampler_free(s->r);
+    free(s->buf);
+    free(s);
+}
+
+/* ============================================================
+ * WAV file → mono float at target rate
+ * ============================================================ */
+
+/** Decodes all frames of wav into out (mono float). */
+static void wav_to_mono(const void *arg, float *out) {
+    const struct wav_info *wav = (const struct wav_info *)arg;
+    if (wav->format == WAV_FORMAT_PCM) audio_pcm16_to_mono(wav->data, wav->frames, wav->channels, out);
+    else audio_f32_to_mono(wav->data, wav->frames, wav->channels, out);
+}
+
+/**
+ * Produces `frames` mono samples via fill(arg, ·) and resamples them to out.
+ *
+ * Decodes directly into out when the rates match; otherwise through one
+ * zero-padded scratch buffer sized for the filter support.
+ */
+static int fill_and_resample(void (*fill)(const void *, float *), const void *arg,
+                             size_t frames, int src_rate, int dst_rate, float *out) {
+    if (src_rate == dst_rate) {
+        fill(arg, out);
+        return AUDIO_OK;
+    }
+
+    struct audio_resampler *r = audio_resampler_create(src_rate, dst_rate);
+    if (!r) return AUDIO_ERR_NOMEM;
+
+    const size_t pad = (size_t)audio_resampler_padding(r);
+    float *scratch = calloc(frames + 2 * pad, sizeof(float));
+    if (!scratch) { audio_resampler_free(r); return AUDIO_ERR_NOMEM; }
+
+    fill(arg, scratch + pad);
+    audio_resampler_run(r, scratch + pad, frames, out);
+
+    free(scratch);
+    audio_resampler_free(r);
+    return AUDIO_OK;
+}
+
+int audio_decode_wav_file(const char *path, int dst_rate, float *out, size_t out_cap, size_t *out_len) {
+    if (out_len) *out_len = 0;
+    if (!path || dst_rate <= 0) return AUDIO_ERR_MALFORMED;
+
+    struct mapped_file m;
+    int rc = audio_map_file(path, &m);
+    if (rc != AUDIO_OK) return rc;
+
+    struct wav_info wav;
+    rc = wav_parse(m.bytes, m.len, &wav);
+    if (rc != AUDIO_OK) { audio_unmap_file(&m); return rc; }
+
+    const size_t n_out = audio_resampled_length(wav.frames, wav.sample_rate, dst_rate);
+    if (out_len) *out_len = n_out;
+    if (!out) { audio_unmap_file(&m); return AUDIO_OK; }
+    if (out_cap < n_out) { audio_unmap_file(&m); return AUDIO_ERR_CAPACITY; }
+
+    rc = fill_and_resample(wav_to_mono, &wav, wav.frames, wav.sample_rate, dst_rate, out);
+    audio_unmap_file(&m);
+
+    if (rc == AUDIO_OK) {
+        LOGD("Decoded %s: %dch %dHz %d-bit frames=%zu → %zu @ %dHz",
+             path, wav.channels, wav.sample_rate, wav.bits, wav.frames, n_out, dst_rate);
+    }
+    return rc;
+}
+
+/* ============================================================
+ * In-memory PCM16 capture helpers
+ * ============================================================ */
+
+/** fill() adapter for a mono int16 buffer. */
+struct pcm16_view {
+    const int16_t *pcm;
+    size_t         frames;
+};
+
+static void pcm16_view_to_mono(const void *arg, float *out) {
+    const struct pcm16_view *v = (const struct pcm16_view *)arg;
+    audio_pcm16_to_mono((const uint8_t *)v->pcm, v->frames, 1, out);
+}
+
+int audio_pcm16_to_rate(const int16_t *pcm, size_t frames, int src_rate, int dst_rate, float *out) {
+    if (!pcm || !out || src_rate <= 0 || dst_rate <= 0) return AUDIO_ERR_MALFORMED;
+    if (frames == 0) return AUDIO_OK;
+    const struct pcm16_view v = { pcm, frames };
+    return fill_and_resample(pcm16_view_to_mono, &v, frames, src_rate, dst_rate, out);
+}
+
+/** Writes all of buf to fd, retrying short writes. */
+static bool write_all(int fd, const void *buf, size_t len) {
+    const uint8_t *p = (const uint8_t *)buf;
+    while (len > 0) {
+        const ssize_t w = write(fd, p, len);
+        if (w <= 0) return false;
+        p += w;
+        len -= (size_t)w;
+    }
+    return true;
+}
+
+static inline void wr_u16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static inline void wr_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+int audio_write_wav_pcm16(const char *path, const int16_t *pcm, size_t frames, int sample_rate) {
+    if (!path || sample_rate <= 0) return AUDIO_ERR_MALFORMED;
+    const uint64_t data = (uint64_t)frames * 2;
+    if (data > 0xFFFFFFFFull - 36) return AUDIO_ERR_CAPACITY;
+
+    uint8_t h[44];
+    memcpy(h, "RIFF", 4);     wr_u32(h + 4, (uint32_t)(data + 36));
+    memcpy(h + 8, "WAVE", 4);
+    memcpy(h + 12, "fmt ", 4); wr_u32(h + 16, 16);
+    wr_u16(h + 20, WAV_FORMAT_PCM); wr_u16(h + 22, 1);
+    wr_u32(h + 24, (uint32_t)sample_rate); wr_u32(h + 28, (uint32_t)sample_rate * 2);
+    wr_u16(h + 32, 2); wr_u16(h + 34, 16);
+    memcpy(h + 36, "data", 4); wr_u32(h + 40, (uint32_t)data);
+
+    const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) { LOGE("open(%s) for write failed", path); return AUDIO_ERR_IO; }
+    const bool ok = write_all(fd, h, sizeof(h)) && (frames == 0 || write_all(fd, pcm, (size_t)data));
+    if (close(fd) != 0 || !ok) { LOGE("write(%s) failed", path); return AUDIO_ERR_IO; }
+    return AUDIO_OK;
+}
+
+/* ============================================================
+ * Energy / zero-crossing voice activity detection
+ * ============================================================ */
+
+/** Unvoiced speech (fricatives) is accepted this many dB below the threshold... */
+#define VAD_UNVOICED_MARGIN_DB 6.0f
+/** ...when at least this fraction of adjacent samples change sign. */
+#define VAD_UNVOICED_ZCR 0.25f
+/** Percentile of frame energies taken as the noise floor. */
+#define VAD_NOISE_PERCENTILE 10
+
+struct audio_vad_params audio_vad_default_params(void) {
+    struct audio_vad_params p = {
+        .frame_ms       = 20,
+        .threshold_db   = 12.0f,
+        .min_level_db   = -55.0f,
+        .min_speech_ms  = 200,
+        .min_silence_ms = 400,
+        .pad_ms         = 200,
+    };
+    return p;
+}
+
+/** Sum of squares and sign changes over x[0..n) (sign changes counted to x[n-1]). */
+static void frame_stats(const float *x, size_t n, float *sum_sq, size_t *crossings) {
+    float acc = 0.0f;
+    size_t zc = 0;
+    size_t i = 0;
+#ifdef AUDIO_HAVE_NEON
+    float32x4_t vacc = vdupq_n_f32(0.0f);
+    uint32x4_t vzc = vdupq_n_u32(0);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    for (; i + 5 <= n; i += 4) {
+        const float32x4_t a = vld1q_f32(x + i);
+        const float32x4_t b = vld1q_f32(x + i + 1);
+        vacc = vmlaq_f32(vacc, a, a);
+        vzc = vsubq_u32(vzc, vcltq_f32(vmulq_f32(a, b), zero));  // mask is all-ones (−1)
+    }
+    acc = vgetq_lane_f32(vacc, 0) + vgetq_lane_f32(vacc, 1) + vgetq_lane_f32(vacc, 2) + vgetq_lane_f32(vacc, 3);
+    zc = vgetq_lane_u32(vzc, 0) + vgetq_lane_u32(vzc, 1) + vgetq_lane_u32(vzc, 2) + vgetq_lane_u32(vzc, 3);
+#endif
+    for (; i < n; ++i) {
+        acc += x[i] * x[i];
+        if (i + 1 < n && x[i] * x[i + 1] < 0.0f) ++zc;
+    }
+    *sum_sq = acc;
+    *crossings = zc;
+}
+
+static int cmp_float(const void *a, const void *b) {
+    const float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+int audio_vad_energy(const float *pcm, size_t n, int sample_rate,
+                     const struct audio_vad_params *params, struct audio_span **out) {
+    *out = NULL;
+    if (!pcm || sample_rate <= 0 || n == 0) return 0;
+    const struct audio_vad_params p = params ? *params : audio_vad_default_params();
+
+    const size_t frame = (size_t)sample_rate * (size_t)(p.frame_ms > 0 ? p.frame_ms : 20) / 1000;
+    if (frame == 0) return 0;
+    const size_t nf = (n + frame - 1) / frame;
+
+    float *db = malloc(nf * sizeof(float));
+    float *zcr = malloc(nf * sizeof(float));
+    float *sorted = malloc(nf * sizeof(float));
+    uint8_t *speech = malloc(nf);
+    if (!db || !zcr || !sorted || !speech) {
+        free(db); free(zcr); free(sorted); free(speech);
+        return AUDIO_ERR_NOMEM;
+    }
+
+    // 1) Per-frame level (dBFS) and zero-crossing rate.
+    for (size_t f = 0; f < nf; ++f) {
+        const size_t off = f * frame;
+        const size_t len = (off + frame <= n) ? frame : n - off;
+        float sq; size_t zc;
+        frame_stats(pcm + off, len, &sq, &zc);
+        db[f] = 10.0f * log10f(sq / (float)len + 1e-10f);
+        zcr[f] = len > 1 ? (float)zc / (float)(len - 1) : 0.0f;
+    }
+
+    // 2) Adaptive threshold: noise floor (low percentile) + margin, never below min_level.
+    memcpy(sorted, db, nf * sizeof(float));
+    qsort(sorted, nf, sizeof(float), cmp_float);
+    const float floor_db = sorted[nf * VAD_NOISE_PERCENTILE / 100];
+    float thr = floor_db + p.threshold_db;
+    if (thr < p.min_level_db) thr = p.min_level_db;
+    free(sorted);
+
+    for (size_t f = 0; f < nf; ++f) {
+        speech[f] = db[f] > thr ||
+                    (db[f] > thr - VAD_UNVOICED_MARGIN_DB && zcr[f] > VAD_UNVOICED_ZCR);
+    }
+    free(db); free(zcr);
+
+    // 3) Drop short blips, then fill short pauses between what is left (in frames):
+    //    in the other order a click next to a pause would merge with the speech.
+    const size_t min_sil = (size_t)(p.min_silence_ms / (p.frame_ms > 0 ? p.frame_ms : 20));
+    const size_t min_sp  = (size_t)(p.min_speech_ms / (p.frame_ms > 0 ? p.frame_ms : 20));
+    for (size_t f = 0; f < nf;) {
+        if (!speech[f]) { ++f; continue; }
+        size_t g = f;
+        while (g < nf && speech[g]) ++g;
+        if (g - f < min_sp) memset(speech + f, 0, g - f);
+        f = g;
+    }
+    size_t last_end = 0;
+    bool seen = false;
+    for (size_t f = 0; f < nf; ++f) {
+        if (!speech[f]) continue;
+        if (seen && f > last_end && f - last_end <= min_sil) memset(speech + last_end, 1, f - last_end);
+        seen = true;
+        last_end = f + 1;
+    }
+
+    // 4) Emit padded spans (samples), merging overlaps after padding.
+    const size_t pad = (size_t)sample_rate * (size_t)(p.pad_ms > 0 ? p.pad_ms : 0) / 1000;
+    size_t cap = 16, count = 0;
+    struct audio_span *spans = malloc(cap * sizeof(*spans));
+    if (!spans) { free(speech); return AUDIO_ERR_NOMEM; }
+
+    for (size_t f = 0; f < nf;) {
+        if (!speech[f]) { ++f; continue; }
+        size_t g = f;
+        while (g < nf && speech[g]) ++g;
+        size_t s = f * frame > pad ? f * frame - pad : 0;
+        size_t e = g * frame + pad;
+        if (e > n) e = n;
+        if (count > 0 && s <= spans[count - 1].end) {
+            spans[count - 1].end = e;
+        } else {
+            if (count == cap) {
+                struct audio_span *grown = realloc(spans, cap * 2 * sizeof(*spans));
+                if (!grown) { free(spans); free(speech); return AUDIO_ERR_NOMEM; }
+                spans = grown;
+                cap *= 2;
+            }
+            spans[count].start = s;
+            spans[count].end = e;
+            ++count;
+        }
+        f = g;
+    }
+    free(speech);
+
+    if (count == 0) { free(spans); spans = NULL; }
+    *out = spans;
+    LOGD("VAD: frames=%zu floor=%.1f dB thr=%.1f dB spans=%zu", nf, floor_db, thr, count);
+    return (int)count;
+}
+
+/** Shortest pause a chunk may be cut in. */
+#define CHUNK_MIN_GAP_MS 200
+
+/** Largest pause overlapping [lo, hi), clipped to it; false if none ≥ min_gap. */
+static bool best_gap(const struct audio_span *spans, int n_spans, size_t n,
+                     size_t lo, size_t hi, size_t min_gap, size_t *cut) {
+    size_t best = 0;
+    // Pauses: before spans[0], between spans, after the last span.
+    for (int i = 0; i <= n_spans; ++i) {
+        size_t g0 = i == 0 ? 0 : spans[i - 1].end;
+        size_t g1 = i == n_spans ? n : spans[i].start;
+        if (g0 < lo) g0 = lo;
+        if (g1 > hi) g1 = hi;
+        if (g1 <= g0 || g1 - g0 < min_gap || g1 - g0 <= best) continue;
+        best = g1 - g0;
+        *cut = g0 + (g1 - g0) / 2;
+    }
+    return best > 0;
+}
+
+int audio_plan_chunks(const float *pcm, size_t n, int sample_rate,
+                      size_t target, size_t overlap, struct audio_span **out) {
+    *out = NULL;
+    if (!pcm || n == 0 || sample_rate <= 0 || target == 0 || overlap >= target / 2) return AUDIO_ERR_FORMAT;
+
+    struct audio_span *speech = NULL;
+    const int n_speech = audio_vad_energy(pcm, n, sample_rate, NULL, &speech);
+    if (n_speech < 0) return n_speech;
+
+    // Every step advances ≥ target / 2 (overlap < target / 2), which bounds the count.
+    const size_t cap = 2 * (n / target) + 2;
+    size_t count = 0;
+    struct audio_span *chunks = malloc(cap * sizeof(*chunks));
+    if (!chunks) { free(speech); return AUDIO_ERR_NOMEM; }
+
+    const size_t min_gap = (size_t)sample_rate * CHUNK_MIN_GAP_MS / 1000;
+    size_t pos = 0, n_hard = 0;
+    // Stop early enough that the tail is not a sliver (≥ 1/4 target).
+    while (n - pos > target + target / 4) {
+        size_t cut;
+        struct audio_span c = { pos, 0 };
+        if (best_gap(speech, n_speech, n, pos + target * 3 / 4, pos + target, min_gap, &cut)) {
+            c.end = cut;  // inside a pause: no overlap needed
+            pos = cut;
+        } else {
+            c.end = pos + target;  // no pause: overlap so words at the cut survive in one chunk
+            pos = c.end - overlap;
+            n_hard++;
+        }
+        chunks[count++] = c;
+    }
+    chunks[count].start = pos;
+    chunks[count].end = n;
+    count++;
+    free(speech);
+
+    *out = chunks;
+    LOGD("Chunk plan: samples=%zu target=%zu chunks=%zu (hard cuts=%zu)", n, target, count, n_hard);
+    return (int)count;
+}
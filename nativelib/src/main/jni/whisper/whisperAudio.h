@@ -0,0 +1,247 @@
+// file: whisperAudio.h
+// ============================================================
+// ✅ whisperAudio — Native PCM decode / downmix / resample helpers
+// ------------------------------------------------------------
+// • Pure C (no JNI): used by whisperLib.c entry points
+// • RIFF/WAVE parsing over a memory-mapped file
+// • PCM16 / float32 → mono float (NEON fast paths on arm)
+// • Rational polyphase windowed-sinc resampler (Kaiser window), whole-signal or streaming
+// • In-memory PCM16 capture → float / WAV archival
+// • Energy + zero-crossing voice activity detection
+// ============================================================
+
+#ifndef WHISPER_AUDIO_H
+#define WHISPER_AUDIO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Error codes shared with Kotlin (WhisperAudio.kt). */
+enum audio_status {
+    AUDIO_OK            =  0,
+    AUDIO_ERR_IO        = -1,  // open/stat/mmap failed
+    AUDIO_ERR_MALFORMED = -2,  // not RIFF/WAVE or missing chunks
+    AUDIO_ERR_FORMAT    = -3,  // unsupported encoding / bit depth
+    AUDIO_ERR_CAPACITY  = -4,  // destination buffer too small
+    AUDIO_ERR_NOMEM     = -5,  // allocation failed
+    AUDIO_ERR_CODEC     = -6,  // no audio track / decoder (whisperMedia.c)
+};
+
+/** WAVE encodings understood by the decoder. */
+#define WAV_FORMAT_PCM        1
+#define WAV_FORMAT_IEEE_FLOAT 3
+#define WAV_FORMAT_EXTENSIBLE 0xFFFE
+
+/**
+ * Parsed view of a WAV file (points into the caller's mapping).
+ *
+ * Fields:
+ * - format: WAV_FORMAT_PCM or WAV_FORMAT_IEEE_FLOAT (extensible resolved)
+ * - channels / sample_rate / bits: from the 'fmt ' chunk
+ * - data / data_size: 'data' payload clamped to the file length
+ * - frames: whole frames available in data
+ */
+struct wav_info {
+    int            format;
+    int            channels;
+    int            sample_rate;
+    int            bits;
+    const uint8_t *data;
+    size_t         data_size;
+    size_t         frames;
+};
+
+/**
+ * Read-only mapping of a whole file.
+ * Release with audio_unmap_file().
+ */
+struct mapped_file {
+    const uint8_t *bytes;
+    size_t         len;
+};
+
+/** Maps path read-only (MADV_SEQUENTIAL). Returns AUDIO_OK or AUDIO_ERR_IO. */
+int audio_map_file(const char *path, struct mapped_file *out);
+
+/** Unmaps a mapping created by audio_map_file(). NULL-safe. */
+void audio_unmap_file(struct mapped_file *m);
+
+/**
+ * Parses RIFF chunks until 'fmt ' and 'data' are found.
+ * Unknown chunks and odd-byte padding are skipped; a truncated 'data' chunk
+ * is clamped to the available bytes.
+ *
+ * @return AUDIO_OK, AUDIO_ERR_MALFORMED or AUDIO_ERR_FORMAT
+ */
+int wav_parse(const uint8_t *bytes, size_t len, struct wav_info *out);
+
+/**
+ * Converts interleaved PCM16 LE frames to mono float in [-1, 1].
+ * `in` need not be aligned.
+ */
+void audio_pcm16_to_mono(const uint8_t *in, size_t frames, int channels, float *out);
+
+/** Converts interleaved float32 LE frames to mono float clamped to [-1, 1]. */
+void audio_f32_to_mono(const uint8_t *in, size_t frames, int channels, float *out);
+
+/** Number of output samples produced when resampling `frames` from src to dst rate. */
+size_t audio_resampled_length(size_t frames, int src_rate, int dst_rate);
+
+/**
+ * Polyphase windowed-sinc resampler for a fixed rational ratio.
+ * Opaque; created by audio_resampler_create().
+ */
+struct audio_resampler;
+
+/** Creates a resampler src_rate → dst_rate, or NULL on invalid rates / OOM. */
+struct audio_resampler* audio_resampler_create(int src_rate, int dst_rate);
+
+/** Zero samples the caller must provide before and after the input (half filter length). */
+int audio_resampler_padding(const struct audio_resampler *r);
+
+/**
+ * Resamples a whole signal.
+ *
+ * `in` must point at the first real sample of a buffer that has
+ * audio_resampler_padding() zero samples before and after [0, frames).
+ * Writes audio_resampled_length(frames, ...) samples to out.
+ */
+void audio_resampler_run(const struct audio_resampler *r, const float *in, size_t frames, float *out);
+
+/** Frees a resampler. NULL-safe. */
+void audio_resampler_free(struct audio_resampler *r);
+
+/**
+ * Streaming form of the resampler for producers that deliver the signal in
+ * chunks (e.g. a MediaCodec decoder). Output is identical to running
+ * audio_resampler_run() over the concatenated input; memory stays at about
+ * one input chunk. src == dst copies through. Opaque.
+ */
+struct audio_stream_resampler;
+
+/** Creates a streaming resampler src_rate → dst_rate, or NULL on invalid rates / OOM. */
+struct audio_stream_resampler* audio_stream_resampler_create(int src_rate, int dst_rate);
+
+/**
+ * Feeds n mono samples and writes every output that is now complete
+ * (at most cap) to out.
+ *
+ * @param written receives the number of samples written
+ * @return AUDIO_OK, AUDIO_ERR_CAPACITY when out was too small (the excess
+ *         output is dropped) or AUDIO_ERR_NOMEM
+ */
+int audio_stream_resampler_push(struct audio_stream_resampler *s, const float *in, size_t n,
+                                float *out, size_t cap, size_t *written);
+
+/**
+ * Flushes the filter tail after the last push; in total exactly
+ * audio_resampled_length(pushed, src, dst) samples are produced.
+ *
+ * @return AUDIO_OK, AUDIO_ERR_CAPACITY or AUDIO_ERR_NOMEM (see push)
+ */
+int audio_stream_resampler_finish(struct audio_stream_resampler *s, float *out, size_t cap, size_t *written);
+
+/** Frees a streaming resampler. NULL-safe. */
+void audio_stream_resampler_free(struct audio_stream_resampler *s);
+
+/**
+ * Decodes a WAV file to mono float at dst_rate.
+ *
+ * With out == NULL only the required output length is computed (header
+ * parse only). Otherwise decodes directly into out when no resampling is
+ * needed, or through one padded scratch buffer when it is.
+ *
+ * @param path file path
+ * @param dst_rate target sample rate (e.g. 16000)
+ * @param out destination (may be NULL to query the length)
+ * @param out_cap capacity of out in samples
+ * @param out_len receives the output length in samples
+ * @return AUDIO_OK or a negative audio_status
+ */
+int audio_decode_wav_file(const char *path, int dst_rate, float *out, size_t out_cap, size_t *out_len);
+
+/**
+ * Converts mono PCM16 (native order) at src_rate to float at dst_rate.
+ * Writes audio_resampled_length(frames, src_rate, dst_rate) samples to out.
+ *
+ * @return AUDIO_OK or a negative audio_status
+ */
+int audio_pcm16_to_rate(const int16_t *pcm, size_t frames, int src_rate, int dst_rate, float *out);
+
+/**
+ * Writes mono PCM16 as a canonical 44-byte-header RIFF/WAVE file.
+ *
+ * @return AUDIO_OK or a negative audio_status
+ */
+int audio_write_wav_pcm16(const char *path, const int16_t *pcm, size_t frames, int sample_rate);
+
+/** Half-open sample range [start, end). */
+struct audio_span {
+    size_t start;
+    size_t end;
+};
+
+/**
+ * Energy / zero-crossing VAD tuning.
+ *
+ * Fields:
+ * - frame_ms: analysis frame length
+ * - threshold_db: speech margin above the adaptive noise floor
+ * - min_level_db: absolute floor for the threshold (dBFS)
+ * - min_speech_ms: shorter detections are dropped
+ * - min_silence_ms: shorter pauses are bridged
+ * - pad_ms: context kept before/after each region
+ */
+struct audio_vad_params {
+    int   frame_ms;
+    float threshold_db;
+    float min_level_db;
+    int   min_speech_ms;
+    int   min_silence_ms;
+    int   pad_ms;
+};
+
+/** Defaults tuned for handheld voice memos (20 ms frames, +12 dB, 200 ms pad). */
+struct audio_vad_params audio_vad_default_params(void);
+
+/**
+ * Segments mono PCM into speech regions.
+ *
+ * Per-frame RMS level and zero-crossing rate (NEON on arm) are compared to a
+ * threshold derived from the recording's own noise floor; high-ZCR frames
+ * slightly below it count as unvoiced speech.
+ *
+ * @param params tuning, or NULL for audio_vad_default_params()
+ * @param out receives a malloc()ed span array (NULL when none); caller frees
+ * @return number of spans (≥ 0) or a negative audio_status
+ */
+int audio_vad_energy(const float *pcm, size_t n, int sample_rate,
+                     const struct audio_vad_params *params, struct audio_span **out);
+
+/**
+ * Plans long-form chunks for independent (parallel) transcription.
+ *
+ * Chunks are about target samples long. Each cut is placed in the longest
+ * pause (audio_vad_energy) within the last quarter of the chunk; such
+ * chunks abut. Where no pause ≥ 0.2 s exists the chunk is cut at target
+ * and the next one starts overlap samples earlier, so the caller has to
+ * de-duplicate segments in [next.start, prev.end).
+ *
+ * @param target nominal chunk length (samples, > 0)
+ * @param overlap samples shared across a hard cut (< target / 2)
+ * @param out receives a malloc()ed array of chunk spans; caller frees
+ * @return number of chunks (≥ 1) or a negative audio_status
+ */
+int audio_plan_chunks(const float *pcm, size_t n, int sample_rate,
+                      size_t target, size_t overlap, struct audio_span **out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WHISPER_AUDIO_H
@@ -0,0 +1,44 @@
+// file: whisperCpu.c
+// ============================================================
+// ✅ whisperCpu — Tiny CPU feature probe (loaded before libwhisper_*.so)
+// ------------------------------------------------------------
+// • Built without any -march flags so it loads on every device
+// • Exposes getauxval(AT_HWCAP / AT_HWCAP2) to Kotlin
+// • Lets the loader pick the fastest whisper variant without parsing
+//   /proc/cpuinfo text
+// ============================================================
+
+#include <jni.h>
+#include <android/log.h>
+#include <stddef.h>
+#include <sys/auxv.h>
+
+#define TAG "JNI-WhisperCpu"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, TAG, __VA_ARGS__)
+
+#ifndef AT_HWCAP2
+#define AT_HWCAP2 26
+#endif
+
+/**
+ * Returns the kernel-reported hardware capability words.
+ *
+ * Bit meanings are architecture-specific (asm/hwcap.h); decoding lives in
+ * WhisperCpuFeatures.kt so the mapping stays next to the variant table.
+ *
+ * @return long[2] = { AT_HWCAP, AT_HWCAP2 }, or NULL on allocation failure
+ */
+JNIEXPORT jlongArray JNICALL
+Java_com_whispercpp_whisper_WhisperCpuFeatures_nativeHwcaps(JNIEnv *env, jclass clazz) {
+    (void)clazz;
+    const jlong caps[2] = {
+        (jlong)getauxval(AT_HWCAP),
+        (jlong)getauxval(AT_HWCAP2),
+    };
+    LOGI("hwcap=0x%llx hwcap2=0x%llx", (unsigned long long)caps[0], (unsigned long long)caps[1]);
+
+    jlongArray out = (*env)->NewLongArray(env, 2);
+    if (!out) return NULL;
+    (*env)->SetLongArrayRegion(env, out, 0, 2, caps);
+    return out;
+}
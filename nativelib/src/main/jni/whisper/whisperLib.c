@@ -3,21 +3,65 @@
 // ✅ whisper.cpp JNI Bridge — Safe Loader + Transcriber (Technical Commented Final C Edition)
 // ------------------------------------------------------------
 // • Three unified model loading paths: File / Asset / InputStream
+// • InputStream models: native read-ahead thread, 1–8 MB blocks, critical-region copy
+// • Asset fast path: mmap uncompressed APK entries via AAsset file descriptor
 // • Thread-safe JNIEnv attach/detach via cached JavaVM pointer
 // • Exception-safe JNI operations (GlobalRef lifecycle guarded)
 // • Defensive handling of AAsset_read() (error vs EOF) and NULL pointers
+// • Streaming sessions: PCM ring buffer + sliding-window whisper_full()
+// • Cooperative cancellation via per-call abort tokens (a request stops only its own run)
+// • Per-context thread policy: CPU affinity + nice inherited by ggml workers
+// • VAD pre-pass (energy/ZCR or whisper VAD model) with timestamp remapping
+// • Pool states: N whisper_state handles sharing one model's weights
+// • Process-wide model cache: sampled content hash (asset = its extracted file), byte budget, LRU eviction
+// • File models (e.g. extracted from the APK) loaded through the same mmap reader
+// • Decoding params object: beam / best-of / temperature fallback / token limits / audio_ctx
+// • Short-clip fast path: audio_ctx sized to the clip, full-context retry on degenerate output
+// • Retained log-mel: re-decode the last clip (other language / task) without its PCM
+// • Packed segment retrieval (one JNI crossing per result)
+// • Packed token dump (id / text / p / t0 / t1 / DTW time) and DTW alignment heads per load
+// • Per-context arena: VAD / result buffers grow to a high-water mark, reused per run
+// • Live results: new-segment / progress callbacks to a Kotlin listener
+// • Native WAV decode + polyphase resample into direct buffers (whisperAudio.c)
+// • Compressed audio (AAC / Opus / …) via AMediaCodec, streamed into the same buffers (whisperMedia.c)
+// • Long-form chunk planning at pauses, for parallel transcription over pool states
+// • In-memory capture buffer: AudioRecord PCM → native, no temp file
+// • Model benchmark: mel / encode / decode / batchd / prompt timings per thread count
+// • Run telemetry: per-stage timings, sample / fallback counts, peak RSS, buffer sizes
+// • Last run's language (requested or detected): draft → target model hand-off
+// • Language detection on a clip's first seconds: top-k probabilities, no transcription
+// • whisper.cpp log → logcat; ATrace sections around load / VAD / whisper_full()
+// • Warm-up pass on silence: first utterance runs at steady-state latency
+// • On-device model re-quantization (whisperQuantize.cpp, WHISPER_QUANTIZE build)
 // • Segment index bounds checking + Bench API guards
 // • Technical doc comments (KDoc-like) per function
 // ============================================================
 
+#define _GNU_SOURCE  // cpu_set_t / CPU_SET for thread affinity
 #include <jni.h>
 #include <android/asset_manager.h>
 #include <android/asset_manager_jni.h>
 #include <android/log.h>
+#include <android/trace.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
 #include "whisper.h"
+#include "whisperAudio.h"
+#include "whisperMedia.h"
+#include "whisperQuantize.h"
+#include "whisperShim.h"
 
 #define TAG "JNI-Whisper"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO,  TAG, __VA_ARGS__)
@@ -48,76 +92,950 @@ static inline JNIEnv* get_env_from_jvm(JavaVM* jvm, int* attached_by_us) {
     return env;
 }
 
+/* ============================================================
+ * Native context handle
+ * ============================================================ */
+
+/** VAD modes for setVad(); mirrored in WhisperVadConfig.kt. */
+enum jni_vad_mode {
+    JNI_VAD_OFF    = 0,
+    JNI_VAD_ENERGY = 1,  // audio_vad_energy() + compaction in this file
+    JNI_VAD_MODEL  = 2,  // whisper.cpp's built-in VAD (params.vad)
+};
+
+/** One speech region copied into the compacted buffer (samples). */
+struct vad_map_entry {
+    int64_t compact0;  // start in the compacted buffer
+    int64_t orig0;     // start in the caller's PCM
+    int64_t len;
+};
+
+/** Monotonic wall clock in milliseconds. */
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec * 1e-6;
+}
+
 /**
- * Data structure for streaming whisper models from Java InputStream.
+ * Load telemetry of one handle.
+ *
+ * whisper.cpp reports its KV cache and compute buffer sizes only in the
+ * log lines of whisper_init_state(); jni_whisper_log() adds them up while
+ * a probe is armed on the loading thread (see jni_load_begin).
  *
  * Fields:
- * - jvm: Cached JavaVM pointer
- * - input_stream: GlobalRef to Java InputStream
- * - mid_read: Cached method ID for InputStream.read(byte[], int, int)
- * - buffer_gl: GlobalRef to reusable byte[] buffer (64 KB)
- * - buf_len: buffer length
- * - eof: end-of-stream flag
- * - attached_by_us: set if current thread attached by native side
+ * - t0 / ms: start and duration of the load (model or state)
+ * - kv_bytes: kv self + cross + pad caches of the handle's state
+ * - compute_bytes: conv / encode / cross / decode compute buffers
  */
-struct input_stream_context {
-    JavaVM   *jvm;
-    jobject   input_stream;
-    jmethodID mid_read;
-    jobject   buffer_gl;
-    jint      buf_len;
-    int       eof;
-    int       attached_by_us;
+struct jni_load_probe {
+    double  t0;
+    double  ms;
+    int64_t kv_bytes;
+    int64_t compute_bytes;
 };
 
 /**
- * Reads a block from the Java InputStream into native memory.
+ * Telemetry of the last fullTranscribe*() run on a handle.
  *
- * Handles Java exceptions, EOF detection, and buffer copying.
+ * Counters are atomics: whisper.cpp samples its decoders on worker threads
+ * and calls the logits-filter hook from each of them.
  *
- * @param ctx Pointer to input_stream_context
- * @param output Native destination buffer
- * @param read_size Maximum bytes to read
- * @return Number of bytes read or 0 if EOF or error
+ * Fields:
+ * - active: a fullTranscribe*() run is recording (streams are not)
+ * - t_start: now_ms() when the first whisper_full() attempt started
+ * - total_ms: all whisper_full() attempts; vad_ms: energy-VAD pre-pass
+ * - mel_ms: start → first encoder pass (log-mel, plus language detection
+ *   when lang is "auto")
+ * - n_encode: encoder passes (one per 30 s window and attempt)
+ * - n_sample: token sampling steps over all decoders (logits-filter calls)
+ * - n_attempts: decode attempts; each temperature fallback adds one
+ * - step0: the previous sampling step was a first token (attempt tracking)
+ * - n_retry: full-context retries after a reduced audio_ctx
+ * - encode_ms / decode_ms / batchd_ms / prompt_ms / sample_ms: per-call
+ *   averages from whisper_get_timings() (default state only, else -1)
+ * - rss_before_kb / peak_base_kb / peak_delta_kb / peak_reset: RSS at the
+ *   start and how far VmHWM rose above peak_base_kb. With the peak cleared
+ *   (clear_refs) the base is the starting RSS; where that is denied, only
+ *   growth beyond the process-lifetime peak is visible. VmHWM is process
+ *   wide, so it is cleared only when no other run is in flight, and
+ *   peak_reset ends up false if runs overlapped (e.g. WhisperPool workers)
+ * - run_seq: g_run_seq when this run started (overlap detection)
+ * - n_threads / n_samples: as passed to whisper_full()
  */
-static size_t is_read(void *ctx, void *output, size_t read_size) {
-    struct input_stream_context* is = (struct input_stream_context*)ctx;
-    if (!is || !is->jvm) return 0;
-    JNIEnv* env = get_env_from_jvm(is->jvm, &is->attached_by_us);
-    if (!env) return 0;
+struct jni_run_stats {
+    bool        active;
+    double      t_start;
+    double      total_ms;
+    double      vad_ms;
+    double      mel_ms;
+    atomic_int  n_encode;
+    atomic_int  n_sample;
+    atomic_int  n_attempts;
+    atomic_bool step0;
+    int         n_retry;
+    float       encode_ms, decode_ms, batchd_ms, prompt_ms, sample_ms;
+    int64_t     rss_before_kb;
+    int64_t     peak_base_kb;
+    int64_t     peak_delta_kb;
+    bool        peak_reset;
+    unsigned    run_seq;
+    int         n_threads;
+    int         n_samples;
+};
+
+/**
+ * Per-context scratch reused across runs. Each buffer only grows (to the
+ * largest request seen, plus headroom) and is freed with the context, so
+ * back-to-back transcriptions of similar length allocate nothing.
+ *
+ * PCM input is not kept here: Kotlin hands out a reusable direct buffer it
+ * owns (WhisperContext.audioBuffer), which can never dangle.
+ *
+ * Fields (capacities in elements):
+ * - vad / map: energy-VAD compacted speech and its timeline mapping
+ * - out: packed segment results (getAllSegmentsArena)
+ */
+struct jni_arena {
+    float                *vad;
+    size_t                vad_cap;
+    struct vad_map_entry *map;
+    size_t                map_cap;
+    uint8_t              *out;
+    size_t                out_cap;
+};
+
+/**
+ * Native handle handed to Kotlin as the context `ptr`.
+ *
+ * Wraps the whisper_context together with per-context JNI state so that
+ * auxiliary calls (abort, sessions) never need global tables.
+ *
+ * Fields:
+ * - ctx: owned whisper_context (freed in freeContext)
+ * - abort_token: token of the Kotlin call currently running on the JNI
+ *   thread (0 = none; see setAbortToken)
+ * - abort_target: token named by the last requestAbort() from any thread;
+ *   the encoder-begin hook and the ggml compute abort callback stop the run
+ *   while it equals abort_token. Tokens are never reused, so a request can
+ *   only ever stop the call it was issued for
+ * - affinity / has_affinity / nice: thread policy applied to the calling
+ *   thread before each whisper_full() (see setThreadPolicy)
+ * - vad_mode / vad / vad_model_path / vad_model: VAD pre-pass configuration
+ *   (see setVad)
+ * - vad_map / n_vad_map: compacted → original sample mapping of the last
+ *   energy-VAD run (empty when the run used the original timeline)
+ * - result_empty: last run found no speech; segment getters report none
+ * - state: NULL for the context's default state; otherwise a pool state
+ *   created by stateCreate() that shares ctx (owned by `parent`), or a
+ *   private state of a shared model cache entry
+ * - cache: model cache entry that owns ctx (NULL when the handle owns it)
+ * - listener: Kotlin callbacks for new segments / progress (see setListener)
+ * - audio_ctx_initial / audio_ctx_used: encoder context of the last run's
+ *   first attempt and of the result actually kept (differ after a
+ *   reduced-context fallback; see JNI_PARAM_AUTO_AUDIO_CTX)
+ * - mel_valid / mel_n: the state's log-mel is that of the last run's input
+ *   of mel_n samples, as encoded (after any energy-VAD compaction)
+ * - mel_n_vad_map: vad_map entries of that input (0 = uncompacted); the map
+ *   itself stays in arena.map, which only a run with new PCM rewrites
+ * - mel_key: caller's key for that log-mel (see melRetain), or NULL
+ * - load: how this handle's model / state was obtained (see jni_load_probe)
+ * - run: telemetry of the last run (see getLastRunStats)
+ * - arena: reusable run buffers (see jni_arena); vad_map points into it
+ */
+struct whisper_jni_context {
+    struct whisper_context *ctx;
+    atomic_uint             abort_token;
+    atomic_uint             abort_target;
+    cpu_set_t               affinity;
+    bool                    has_affinity;
+    int                     nice;
+    int                     vad_mode;
+    struct audio_vad_params vad;
+    char                   *vad_model_path;
+    whisper_vad_params      vad_model;
+    struct vad_map_entry   *vad_map;
+    int                     n_vad_map;
+    bool                    result_empty;
+    struct whisper_state   *state;
+    struct whisper_jni_context *parent;
+    struct model_cache_entry   *cache;
+    struct jni_listener        *listener;
+    int                     audio_ctx_initial;
+    int                     audio_ctx_used;
+    bool                    mel_valid;
+    int                     mel_n;
+    int                     mel_n_vad_map;
+    char                   *mel_key;
+    struct jni_load_probe   load;
+    struct jni_run_stats    run;
+    struct jni_arena        arena;
+};
+
+/**
+ * Allocates a handle over ctx with default per-context settings.
+ * Ownership of ctx is not taken; the caller decides who frees it.
+ *
+ * @return new handle, or NULL if allocation failed
+ */
+static struct whisper_jni_context* jni_context_alloc(struct whisper_context *ctx) {
+    struct whisper_jni_context *jc = calloc(1, sizeof(*jc));
+    if (!jc) { LOGE("calloc() failed for context handle"); return NULL; }
+    jc->ctx = ctx;
+    atomic_init(&jc->abort_token, 0);
+    atomic_init(&jc->abort_target, 0);
+    jc->nice = INT32_MIN;  // leave thread priority untouched
+    jc->vad = audio_vad_default_params();
+    jc->vad_model = whisper_vad_default_params();
+    return jc;
+}
+
+/**
+ * Wraps a freshly created whisper_context into a JNI handle and records
+ * the load telemetry of probe (may be NULL).
+ * Frees the context if the wrapper cannot be allocated.
+ *
+ * @return handle as jlong, or 0 if ctx is NULL / allocation failed
+ */
+static jlong jni_context_wrap(struct whisper_context *ctx, const struct jni_load_probe *probe) {
+    if (!ctx) return 0;
+    struct whisper_jni_context *jc = jni_context_alloc(ctx);
+    if (!jc) {
+        whisper_free(ctx);
+        return 0;
+    }
+    if (probe) jc->load = *probe;
+    return (jlong)jc;
+}
+
+/** Probe armed by jni_load_begin() on this thread, or NULL. */
+static __thread struct jni_load_probe *tl_load_probe;
+
+/** Parses the "= %7.2f MB" tail of a whisper.cpp size log line. */
+static int64_t jni_log_mb(const char *text) {
+    const char *eq = strchr(text, '=');
+    double mb = 0.0;
+    if (!eq || sscanf(eq + 1, "%lf", &mb) != 1 || mb < 0.0) return 0;
+    return (int64_t)(mb * 1e6);  // whisper.cpp prints bytes / 1e6
+}
+
+/**
+ * whisper.cpp / ggml log sink (installed in JNI_OnLoad).
+ *
+ * Forwards to logcat (info and below at DEBUG priority) and feeds the
+ * armed load probe from the "kv ... size" / "compute buffer" lines that
+ * whisper_init_state() prints.
+ */
+static void jni_whisper_log(enum ggml_log_level level, const char *text, void *user_data) {
+    (void)user_data;
+    if (!text) return;
+    struct jni_load_probe *probe = tl_load_probe;
+    if (probe) {
+        if (strstr(text, "compute buffer")) probe->compute_bytes += jni_log_mb(text);
+        else if (strstr(text, "kv ") && strstr(text, " size")) probe->kv_bytes += jni_log_mb(text);
+    }
+    int prio = ANDROID_LOG_DEBUG;
+    if (level == GGML_LOG_LEVEL_ERROR) prio = ANDROID_LOG_ERROR;
+    else if (level == GGML_LOG_LEVEL_WARN) prio = ANDROID_LOG_WARN;
+    __android_log_write(prio, "whisper.cpp", text);
+}
+
+/**
+ * Starts timing a model / state load on this thread and arms probe for
+ * the buffer sizes logged meanwhile. Pair with jni_load_end() directly
+ * around the whisper_init_*() call.
+ */
+static void jni_load_begin(struct jni_load_probe *probe) {
+    memset(probe, 0, sizeof(*probe));
+    probe->t0 = now_ms();
+    tl_load_probe = probe;
+    ATrace_beginSection("whisper:load");
+}
+
+/** Disarms the probe and records the load duration. */
+static void jni_load_end(struct jni_load_probe *probe) {
+    ATrace_endSection();
+    tl_load_probe = NULL;
+    probe->ms = now_ms() - probe->t0;
+}
+
+/** Returns the JNI handle for ptr (NULL-safe). */
+static inline struct whisper_jni_context* jni_context(jlong ptr) {
+    return (struct whisper_jni_context*)ptr;
+}
+
+/** Returns the whisper_context owned by ptr, or NULL. */
+static inline struct whisper_context* jni_whisper(jlong ptr) {
+    return ptr ? ((struct whisper_jni_context*)ptr)->ctx : NULL;
+}
+
+/** whisper timestamps are in 10 ms ticks → 160 samples per tick at 16 kHz. */
+#define SAMPLES_PER_TICK (WHISPER_SAMPLE_RATE / 100)
+
+/**
+ * Ensures *buf holds at least `need` elements of `elem` bytes. Contents are
+ * not preserved on growth (callers refill); grows by ≥ 1.5× so slowly
+ * increasing clip lengths do not reallocate every run.
+ *
+ * @return false on OOM (*buf is then NULL and *cap 0)
+ */
+static bool jni_arena_reserve(void **buf, size_t *cap, size_t need, size_t elem) {
+    if (*buf && *cap >= need) return true;
+    size_t n = *cap + *cap / 2;
+    if (n < need) n = need;
+    free(*buf);
+    *buf = malloc(n * elem);
+    *cap = *buf ? n : 0;
+    return *buf != NULL;
+}
+
+static void jni_arena_free(struct jni_arena *a) {
+    free(a->vad);
+    free(a->map);
+    free(a->out);
+    memset(a, 0, sizeof(*a));
+}
+
+/** Forgets the VAD mapping and audio_ctx record of the previous run. */
+static void jni_result_reset(struct whisper_jni_context *jc) {
+    jc->vad_map = NULL;  // arena storage
+    jc->n_vad_map = 0;
+    jc->result_empty = false;
+    jc->audio_ctx_initial = jc->audio_ctx_used = 0;  // 0 = nothing encoded
+}
+
+/** The state's log-mel is about to be overwritten: drop the retained key. */
+static void jni_mel_forget(struct whisper_jni_context *jc) {
+    free(jc->mel_key);
+    jc->mel_key = NULL;
+    jc->mel_valid = false;
+    jc->mel_n = 0;
+    jc->mel_n_vad_map = 0;
+}
+
+/* Result accessors: route to the pool state when the handle has one. */
+
+static int jni_full(struct whisper_jni_context *jc, struct whisper_full_params p, const float *pcm, int n) {
+    return jc->state ? whisper_full_with_state(jc->ctx, jc->state, p, pcm, n) : whisper_full(jc->ctx, p, pcm, n);
+}
+
+static const char *jni_seg_text(const struct whisper_jni_context *jc, int i) {
+    return jc->state ? whisper_full_get_segment_text_from_state(jc->state, i)
+                     : whisper_full_get_segment_text(jc->ctx, i);
+}
+
+static int64_t jni_seg_t0_raw(const struct whisper_jni_context *jc, int i) {
+    return jc->state ? whisper_full_get_segment_t0_from_state(jc->state, i)
+                     : whisper_full_get_segment_t0(jc->ctx, i);
+}
+
+static int64_t jni_seg_t1_raw(const struct whisper_jni_context *jc, int i) {
+    return jc->state ? whisper_full_get_segment_t1_from_state(jc->state, i)
+                     : whisper_full_get_segment_t1(jc->ctx, i);
+}
+
+static int jni_seg_n_tokens(const struct whisper_jni_context *jc, int i) {
+    return jc->state ? whisper_full_n_tokens_from_state(jc->state, i) : whisper_full_n_tokens(jc->ctx, i);
+}
+
+static whisper_token jni_token_id(const struct whisper_jni_context *jc, int i, int j) {
+    return jc->state ? whisper_full_get_token_id_from_state(jc->state, i, j)
+                     : whisper_full_get_token_id(jc->ctx, i, j);
+}
+
+static float jni_token_p(const struct whisper_jni_context *jc, int i, int j) {
+    return jc->state ? whisper_full_get_token_p_from_state(jc->state, i, j)
+                     : whisper_full_get_token_p(jc->ctx, i, j);
+}
+
+static whisper_token_data jni_token_data(const struct whisper_jni_context *jc, int i, int j) {
+    return jc->state ? whisper_full_get_token_data_from_state(jc->state, i, j)
+                     : whisper_full_get_token_data(jc->ctx, i, j);
+}
+
+static const char *jni_token_text(const struct whisper_jni_context *jc, int i, int j) {
+    return jc->state ? whisper_full_get_token_text_from_state(jc->ctx, jc->state, i, j)
+                     : whisper_full_get_token_text(jc->ctx, i, j);
+}
+
+/** Segment count of the last run, honouring an all-silence VAD result. */
+static int jni_n_segments(const struct whisper_jni_context *jc) {
+    if (!jc || jc->result_empty) return 0;
+    return jc->state ? whisper_full_n_segments_from_state(jc->state) : whisper_full_n_segments(jc->ctx);
+}
+
+/** Language id of the last run (requested or auto-detected), -1 if none. */
+static int jni_lang_id(const struct whisper_jni_context *jc) {
+    if (!jc || jc->result_empty || jc->run.total_ms <= 0.0) return -1;  // no run yet
+    return jc->state ? whisper_full_lang_id_from_state(jc->state) : whisper_full_lang_id(jc->ctx);
+}
+
+/** Maps a whisper timestamp (10 ms ticks) of the compacted run back to the original timeline. */
+static int64_t jni_remap_ticks(const struct whisper_jni_context *jc, int64_t t) {
+    if (!jc || jc->n_vad_map == 0) return t;
+    const int64_t s = t * SAMPLES_PER_TICK;
+    int lo = 0, hi = jc->n_vad_map - 1;
+    while (lo < hi) {  // last entry with compact0 <= s
+        const int mid = (lo + hi + 1) / 2;
+        if (jc->vad_map[mid].compact0 <= s) lo = mid; else hi = mid - 1;
+    }
+    const struct vad_map_entry *e = &jc->vad_map[lo];
+    int64_t d = s - e->compact0;
+    if (d < 0) d = 0;
+    if (d > e->len) d = e->len;  // inside the join gap → end of the region
+    return (e->orig0 + d) / SAMPLES_PER_TICK;
+}
+
+/** ggml abort hook: true once requestAbort() named the token of this run. */
+static bool jni_abort_callback(void *user_data) {
+    struct whisper_jni_context *jc = (struct whisper_jni_context*)user_data;
+    if (!jc) return false;
+    unsigned token = atomic_load_explicit(&jc->abort_token, memory_order_relaxed);
+    return token != 0 && atomic_load_explicit(&jc->abort_target, memory_order_relaxed) == token;
+}
+
+/** Encoder-begin hook: returning false skips the encoder (and the run). */
+static bool jni_encoder_begin_callback(struct whisper_context *ctx, struct whisper_state *state, void *user_data) {
+    (void)ctx; (void)state;
+    struct whisper_jni_context *jc = (struct whisper_jni_context*)user_data;
+    if (jc && jc->run.active) {
+        // The log-mel of the whole clip is computed before the first window.
+        if (atomic_fetch_add(&jc->run.n_encode, 1) == 0) jc->run.mel_ms = now_ms() - jc->run.t_start;
+        atomic_store(&jc->run.step0, false);
+    }
+    return !jni_abort_callback(user_data);
+}
+
+/**
+ * Installs both abort hooks on params; must be called right before each
+ * whisper_full() on this context. Nothing is cleared: a stale request names
+ * an older token and cannot match the current one.
+ */
+static void jni_prepare_abort(struct whisper_full_params *p, struct whisper_jni_context *jc) {
+    p->abort_callback = jni_abort_callback;
+    p->abort_callback_user_data = jc;
+    p->encoder_begin_callback = jni_encoder_begin_callback;
+    p->encoder_begin_callback_user_data = jc;
+}
+
+/**
+ * Applies the context's thread policy to the calling thread.
+ *
+ * ggml's CPU backend spawns its compute workers from the thread that calls
+ * whisper_full(); Linux threads inherit both the affinity mask and the nice
+ * value of their creator, so pinning the caller pins every worker too. Must
+ * be called right before each whisper_full() on this context.
+ */
+static void jni_apply_thread_policy(const struct whisper_jni_context *jc) {
+    if (jc->has_affinity && sched_setaffinity(0, sizeof(jc->affinity), &jc->affinity) != 0) {
+        LOGW("sched_setaffinity() failed");
+    }
+    if (jc->nice != INT32_MIN && setpriority(PRIO_PROCESS, 0, jc->nice) != 0) {
+        LOGW("setpriority(%d) failed", jc->nice);
+    }
+}
+
+/* ============================================================
+ * Run telemetry (see getLastRunStats)
+ * ============================================================ */
+
+/** Reads VmRSS / VmHWM (kB) from /proc/self/status; -1 when unavailable. */
+static void proc_mem_kb(int64_t *rss_kb, int64_t *hwm_kb) {
+    *rss_kb = *hwm_kb = -1;
+    FILE *f = fopen("/proc/self/status", "r");
+    if (!f) return;
+    char line[128];
+    long long v;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "VmRSS: %lld kB", &v) == 1) *rss_kb = v;
+        else if (sscanf(line, "VmHWM: %lld kB", &v) == 1) *hwm_kb = v;
+    }
+    fclose(f);
+}
+
+/** Runs between jni_prepare_stats() and jni_finish_stats(), over all handles. */
+static atomic_int g_active_runs;
+/** Bumped by every run start; a changed value at the end means another run overlapped. */
+static atomic_uint g_run_seq;
+
+/** Resets VmHWM to the current RSS (Linux ≥ 4.0). False where denied. */
+static bool proc_reset_peak(void) {
+    FILE *f = fopen("/proc/self/clear_refs", "w");
+    if (!f) return false;
+    const bool ok = fputs("5", f) >= 0;
+    return fclose(f) == 0 && ok;  // the write happens on flush
+}
+
+/**
+ * Logits-filter hook: counts sampling steps and decode attempts. Called
+ * once per decoder and step, possibly from several threads; all decoders
+ * take their first step (empty sequence) before any takes a second.
+ */
+static void jni_logits_filter_callback(
+        struct whisper_context *ctx, struct whisper_state *state,
+        const whisper_token_data *tokens, int n_tokens, float *logits, void *user_data) {
+    (void)ctx; (void)state; (void)tokens; (void)logits;
+    struct whisper_jni_context *jc = (struct whisper_jni_context*)user_data;
+    if (!jc || !jc->run.active) return;
+    atomic_fetch_add_explicit(&jc->run.n_sample, 1, memory_order_relaxed);
+    if (n_tokens > 0) {
+        atomic_store_explicit(&jc->run.step0, false, memory_order_relaxed);
+    } else if (!atomic_exchange(&jc->run.step0, true)) {
+        atomic_fetch_add_explicit(&jc->run.n_attempts, 1, memory_order_relaxed);
+    }
+}
+
+/**
+ * Resets the handle's run telemetry and installs the counting hook.
+ * Must be called right before each fullTranscribe*() run on this context.
+ */
+static void jni_prepare_stats(struct whisper_full_params *p, struct whisper_jni_context *jc) {
+    struct jni_run_stats *r = &jc->run;
+    r->t_start = 0.0;
+    r->total_ms = r->vad_ms = r->mel_ms = 0.0;
+    atomic_store(&r->n_encode, 0);
+    atomic_store(&r->n_sample, 0);
+    atomic_store(&r->n_attempts, 0);
+    atomic_store(&r->step0, false);
+    r->n_retry = 0;
+    r->encode_ms = r->decode_ms = r->batchd_ms = r->prompt_ms = r->sample_ms = -1.0f;
+    int64_t hwm_kb;
+    proc_mem_kb(&r->rss_before_kb, &hwm_kb);
+    // Clearing VmHWM under a concurrent run would wipe that run's peak.
+    const bool alone = atomic_fetch_add(&g_active_runs, 1) == 0;
+    r->run_seq = atomic_fetch_add(&g_run_seq, 1) + 1;
+    r->peak_reset = alone && proc_reset_peak();
+    r->peak_base_kb = r->peak_reset ? r->rss_before_kb : hwm_kb;
+    r->peak_delta_kb = 0;
+    r->n_threads = p->n_threads;
+    r->n_samples = 0;
+    r->active = true;
+    p->logits_filter_callback = jni_logits_filter_callback;
+    p->logits_filter_callback_user_data = jc;
+}
+
+/** One timed whisper_full() attempt (ATrace section "whisper:full"). */
+static int jni_full_timed(struct whisper_jni_context *jc, struct whisper_full_params p, const float *pcm, int n) {
+    ATrace_beginSection("whisper:full");
+    const double t0 = now_ms();
+    if (jc->run.t_start == 0.0) jc->run.t_start = t0;
+    const int rc = jni_full(jc, p, pcm, n);
+    jc->run.total_ms += now_ms() - t0;
+    ATrace_endSection();
+    return rc;
+}
+
+/** Stops recording and snapshots whisper's timings and the memory peak. */
+static void jni_finish_stats(struct whisper_jni_context *jc) {
+    struct jni_run_stats *r = &jc->run;
+    if (!r->active) return;
+    r->active = false;
+    atomic_fetch_sub(&g_active_runs, 1);
+    if (atomic_load(&g_run_seq) != r->run_seq) r->peak_reset = false;  // peak includes another run
+    struct whisper_timings *t = jc->state ? NULL : whisper_get_timings(jc->ctx);
+    if (t) {
+        r->sample_ms = t->sample_ms;
+        r->encode_ms = t->encode_ms;
+        r->decode_ms = t->decode_ms;
+        r->batchd_ms = t->batchd_ms;
+        r->prompt_ms = t->prompt_ms;
+        whisper_timings_free(t);  // C++ new in whisper.cpp: not free()
+    }
+    int64_t rss_kb, hwm_kb;
+    proc_mem_kb(&rss_kb, &hwm_kb);
+    if (hwm_kb >= 0 && r->peak_base_kb >= 0) {
+        r->peak_delta_kb = hwm_kb > r->peak_base_kb ? hwm_kb - r->peak_base_kb : 0;
+    }
+}
+
+/* ============================================================
+ * Result listener (new-segment / progress callbacks → Kotlin)
+ * ============================================================ */
+
+/**
+ * Kotlin listener installed with setListener().
+ *
+ * Fields:
+ * - jvm: cached JavaVM (callbacks fetch their JNIEnv via get_env_from_jvm)
+ * - obj: GlobalRef to the WhisperNativeListener
+ * - mid_segment / mid_progress: onSegment(int, long, long, byte[]) / onProgress(int)
+ * - last_progress: last value forwarded (duplicates are dropped)
+ */
+struct jni_listener {
+    JavaVM   *jvm;
+    jobject   obj;
+    jmethodID mid_segment;
+    jmethodID mid_progress;
+    int       last_progress;
+};
 
-    const jint chunk = (jint)((read_size > (size_t)is->buf_len) ? is->buf_len : read_size);
-    const jint n = (*env)->CallIntMethod(env, is->input_stream, is->mid_read, is->buffer_gl, 0, chunk);
+/** Releases the listener's GlobalRef and frees it. NULL-safe. */
+static void jni_listener_free(JNIEnv *env, struct jni_listener *l) {
+    if (!l) return;
+    if (l->obj) (*env)->DeleteGlobalRef(env, l->obj);
+    free(l);
+}
 
+/** Logs and clears a pending Java exception thrown by a listener method. */
+static void jni_listener_check(JNIEnv *env, const char *what) {
     if ((*env)->ExceptionCheck(env)) {
-        LOGE("Exception during InputStream.read(%d): marking EOF", (int)chunk);
+        LOGW("Listener %s threw; ignoring", what);
         (*env)->ExceptionDescribe(env);
         (*env)->ExceptionClear(env);
-        is->eof = 1;
-        return 0;
     }
-    if (n <= 0) { is->eof = 1; return 0; }
+}
 
-    jbyte* ptr = (*env)->GetByteArrayElements(env, (jbyteArray)is->buffer_gl, NULL);
-    if (!ptr) {
-        LOGE("GetByteArrayElements() returned NULL");
-        is->eof = 1;
-        return 0;
+/**
+ * whisper new_segment_callback: forwards the n_new newest segments.
+ *
+ * Runs on the thread inside whisper_full(). Text goes over as UTF-8 bytes
+ * (segment text can end inside a multi-byte character, which NewStringUTF
+ * rejects); timestamps are remapped to the caller's timeline like the
+ * segment getters.
+ */
+static void jni_on_new_segment(struct whisper_context *ctx, struct whisper_state *state, int n_new, void *user_data) {
+    (void)ctx; (void)state;  // == jc's own state; the jc accessors read the same result
+    const struct whisper_jni_context *jc = (const struct whisper_jni_context *)user_data;
+    struct jni_listener *l = jc->listener;
+    int attached = 0;
+    JNIEnv *env = get_env_from_jvm(l->jvm, &attached);
+    if (!env) return;
+
+    const int n = jni_n_segments(jc);
+    for (int i = n - n_new < 0 ? 0 : n - n_new; i < n; ++i) {
+        const char *text = jni_seg_text(jc, i);
+        const jsize len = text ? (jsize)strlen(text) : 0;
+        jbyteArray bytes = (*env)->NewByteArray(env, len);
+        if (!bytes) { jni_listener_check(env, "onSegment"); break; }
+        if (len > 0) (*env)->SetByteArrayRegion(env, bytes, 0, len, (const jbyte *)text);
+
+        const jlong t0 = jni_remap_ticks(jc, jni_seg_t0_raw(jc, i));
+        const jlong t1 = jni_remap_ticks(jc, jni_seg_t1_raw(jc, i));
+        (*env)->CallVoidMethod(env, l->obj, l->mid_segment, (jint)i, t0, t1, bytes);
+        (*env)->DeleteLocalRef(env, bytes);
+        jni_listener_check(env, "onSegment");
+    }
+    if (attached) (*l->jvm)->DetachCurrentThread(l->jvm);
+}
+
+/** whisper progress_callback: forwards 0…100 when the value changes. */
+static void jni_on_progress(struct whisper_context *ctx, struct whisper_state *state, int progress, void *user_data) {
+    (void)ctx; (void)state;
+    const struct whisper_jni_context *jc = (const struct whisper_jni_context *)user_data;
+    struct jni_listener *l = jc->listener;
+    if (progress == l->last_progress) return;
+    l->last_progress = progress;
+
+    int attached = 0;
+    JNIEnv *env = get_env_from_jvm(l->jvm, &attached);
+    if (!env) return;
+    (*env)->CallVoidMethod(env, l->obj, l->mid_progress, (jint)progress);
+    jni_listener_check(env, "onProgress");
+    if (attached) (*l->jvm)->DetachCurrentThread(l->jvm);
+}
+
+/** Installs the listener callbacks on p when the handle has one. */
+static void jni_prepare_listener(struct whisper_full_params *p, struct whisper_jni_context *jc) {
+    if (!jc->listener) return;
+    jc->listener->last_progress = -1;
+    p->new_segment_callback = jni_on_new_segment;
+    p->new_segment_callback_user_data = jc;
+    p->progress_callback = jni_on_progress;
+    p->progress_callback_user_data = jc;
+}
+
+/**
+ * Sets (or clears, with NULL) the listener notified during this handle's
+ * fullTranscribe*() runs.
+ *
+ * The listener must implement `onSegment(int index, long t0, long t1,
+ * byte[] utf8)` and `onProgress(int percent)`; both are called on the
+ * transcribing thread. Must not be called while a run is in progress.
+ *
+ * @return JNI_TRUE on success
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_whispercpp_whisper_WhisperLib_setListener(JNIEnv *env, jclass clazz, jlong ptr, jobject listener) {
+    (void)clazz;
+    struct whisper_jni_context *jc = jni_context(ptr);
+    if (!jc) return JNI_FALSE;
+    jni_listener_free(env, jc->listener);
+    jc->listener = NULL;
+    if (!listener) return JNI_TRUE;
+
+    struct jni_listener *l = calloc(1, sizeof(*l));
+    if (!l) { LOGE("calloc() failed for listener"); return JNI_FALSE; }
+    if ((*env)->GetJavaVM(env, &l->jvm) != 0) { LOGE("GetJavaVM() failed"); free(l); return JNI_FALSE; }
+
+    jclass cls = (*env)->GetObjectClass(env, listener);
+    if (!cls) { LOGE("GetObjectClass() failed"); free(l); return JNI_FALSE; }
+    l->mid_segment  = (*env)->GetMethodID(env, cls, "onSegment", "(IJJ[B)V");
+    l->mid_progress = (*env)->GetMethodID(env, cls, "onProgress", "(I)V");
+    (*env)->DeleteLocalRef(env, cls);
+    if (!l->mid_segment || !l->mid_progress) {
+        LOGE("setListener: onSegment/onProgress not found");
+        (*env)->ExceptionClear(env);  // NoSuchMethodError
+        free(l);
+        return JNI_FALSE;
+    }
+
+    l->obj = (*env)->NewGlobalRef(env, listener);
+    if (!l->obj) { LOGE("NewGlobalRef(listener) failed"); free(l); return JNI_FALSE; }
+    jc->listener = l;
+    return JNI_TRUE;
+}
+
+/* ============================================================
+ * Context parameters shared by every loader
+ * ============================================================ */
+
+/** Text layers whose heads align tokens for WHISPER_AHEADS_N_TOP_MOST. */
+#define DTW_N_TOP 2
+
+/**
+ * Alignment-head preset for models loaded from now on (setDtwPreset());
+ * WHISPER_AHEADS_NONE disables DTW token timestamps. DTW heads are fixed
+ * at whisper_init time, so the preset is part of the model cache key.
+ */
+static atomic_int g_dtw_preset = WHISPER_AHEADS_NONE;
+
+/** whisper_context_params for a load: defaults plus the DTW preset. */
+static struct whisper_context_params jni_context_params(void) {
+    struct whisper_context_params cp = whisper_context_default_params();
+    const int preset = atomic_load(&g_dtw_preset);
+    if (preset != WHISPER_AHEADS_NONE) {
+        cp.dtw_token_timestamps = true;
+        cp.dtw_aheads_preset = (enum whisper_alignment_heads_preset)preset;
+        cp.dtw_n_top = DTW_N_TOP;  // only read by WHISPER_AHEADS_N_TOP_MOST
+        cp.flash_attn = false;     // DTW needs the materialized cross-attention weights
+    }
+    return cp;
+}
+
+/**
+ * Selects the alignment heads for DTW token timestamps (t_dtw in
+ * getAllTokens()) of models loaded after this call; handles already
+ * loaded, and cache entries loaded with another preset, are unaffected.
+ *
+ * @param preset enum whisper_alignment_heads_preset value matching the
+ *               model (e.g. WHISPER_AHEADS_BASE), N_TOP_MOST for any
+ *               model, NONE to disable; CUSTOM is not supported
+ * @return JNI_FALSE for an unsupported preset (setting unchanged)
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_whispercpp_whisper_WhisperLib_setDtwPreset(JNIEnv *env, jclass clazz, jint preset) {
+    (void)env; (void)clazz;
+    if (preset < WHISPER_AHEADS_NONE || preset > WHISPER_AHEADS_LARGE_V3_TURBO || preset == WHISPER_AHEADS_CUSTOM) {
+        LOGW("setDtwPreset: unsupported preset %d", preset);
+        return JNI_FALSE;
+    }
+    atomic_store(&g_dtw_preset, preset);
+    LOGI("DTW alignment heads for new loads: preset %d", preset);
+    return JNI_TRUE;
+}
+
+/** Bytes per InputStream.read() call (one JNI round trip each; was 64 KB). */
+#define IS_JAVA_CHUNK (1 << 20)
+/** Read-ahead block sizes: small first so the header parses early, then doubling. */
+#define IS_SLOT_MIN ((size_t)1 << 20)
+#define IS_SLOT_MAX ((size_t)8 << 20)
+/** Double buffering: the reader fills one block while the loader drains the other. */
+#define IS_SLOTS 2
+
+/** One read-ahead block; owned by the reader while !full, by the loader while full. */
+struct is_slot {
+    uint8_t *data;
+    size_t   cap;
+    size_t   len;
+    size_t   pos;
+    bool     full;
+};
+
+/**
+ * Data structure for streaming whisper models from a Java InputStream.
+ *
+ * A native reader thread pulls the stream into IS_SLOTS blocks of up to
+ * IS_SLOT_MAX bytes while whisper parses / uploads the previous one, so
+ * Java I/O (network, decryption, inflate) overlaps tensor loading.
+ *
+ * Fields:
+ * - jvm: Cached JavaVM pointer (the reader attaches itself)
+ * - input_stream: GlobalRef to Java InputStream (read by the reader only)
+ * - mid_read: Cached method ID for InputStream.read(byte[], int, int)
+ * - buffer_gl: GlobalRef to the reader's byte[IS_JAVA_CHUNK] transfer array
+ * - mu / cv: guard slot[], head, done, failed
+ * - stop: close requested (checked by the reader between Java reads)
+ * - eof: loader side: a read came up short, the stream is exhausted
+ * - java_reads / wait_ms / total: load diagnostics
+ */
+struct input_stream_context {
+    JavaVM         *jvm;
+    jobject         input_stream;
+    jmethodID       mid_read;
+    jobject         buffer_gl;
+    jint            buf_len;
+
+    pthread_t       reader;
+    bool            reader_started;
+    pthread_mutex_t mu;
+    pthread_cond_t  cv;
+    struct is_slot  slot[IS_SLOTS];
+    int             head;
+    bool            done;
+    bool            failed;
+    atomic_bool     stop;
+
+    bool            eof;
+    int             java_reads;
+    double          wait_ms;
+    size_t          total;
+};
+
+/**
+ * Reader thread: fills up to [want] bytes of dst from the stream.
+ *
+ * Loops over InputStream.read() (which may return short counts) and copies
+ * each chunk out of the byte[] inside a critical region: one memcpy, no
+ * array copy by the VM.
+ *
+ * @return 0, or -1 on a Java exception / JNI failure
+ */
+static int is_fill(struct input_stream_context *is, JNIEnv *env,
+                   uint8_t *dst, size_t want, size_t *out_len, bool *eof) {
+    size_t len = 0;
+    int rc = 0;
+    while (len < want && !atomic_load(&is->stop)) {
+        const jint chunk = (jint)((want - len > (size_t)is->buf_len) ? (size_t)is->buf_len : want - len);
+        const jint n = (*env)->CallIntMethod(env, is->input_stream, is->mid_read, is->buffer_gl, 0, chunk);
+        is->java_reads++;
+        if ((*env)->ExceptionCheck(env)) {
+            LOGE("Exception during InputStream.read(%d)", (int)chunk);
+            (*env)->ExceptionDescribe(env);
+            (*env)->ExceptionClear(env);
+            rc = -1;
+            break;
+        }
+        if (n <= 0) { *eof = true; break; }
+
+        void *src = (*env)->GetPrimitiveArrayCritical(env, (jarray)is->buffer_gl, NULL);
+        if (!src) { LOGE("GetPrimitiveArrayCritical() returned NULL"); rc = -1; break; }
+        memcpy(dst + len, src, (size_t)n);
+        (*env)->ReleasePrimitiveArrayCritical(env, (jarray)is->buffer_gl, src, JNI_ABORT);
+        len += (size_t)n;
+    }
+    *out_len = len;
+    return rc;
+}
+
+/** Reader thread body: fills slots in order until EOF, error or stop. */
+static void *is_reader_main(void *arg) {
+    struct input_stream_context *is = (struct input_stream_context *)arg;
+    JNIEnv *env = NULL;
+    if ((*is->jvm)->AttachCurrentThread(is->jvm, &env, NULL) != 0) {
+        LOGE("InputStream reader: AttachCurrentThread() failed");
+        pthread_mutex_lock(&is->mu);
+        is->failed = is->done = true;
+        pthread_cond_broadcast(&is->cv);
+        pthread_mutex_unlock(&is->mu);
+        return NULL;
+    }
+
+    size_t want = IS_SLOT_MIN;
+    for (int tail = 0;; tail = (tail + 1) % IS_SLOTS) {
+        struct is_slot *s = &is->slot[tail];
+        pthread_mutex_lock(&is->mu);
+        while (s->full && !atomic_load(&is->stop)) pthread_cond_wait(&is->cv, &is->mu);
+        pthread_mutex_unlock(&is->mu);
+        if (atomic_load(&is->stop)) break;
+
+        // The slot is empty: only this thread touches it until it is marked full.
+        int rc = 0;
+        if (s->cap < want) {
+            free(s->data);
+            s->data = malloc(want);
+            s->cap = s->data ? want : 0;
+            if (!s->data) { LOGE("InputStream reader: malloc(%zu) failed", want); rc = -1; }
+        }
+        size_t len = 0;
+        bool eof = false;
+        if (rc == 0) rc = is_fill(is, env, s->data, want, &len, &eof);
+
+        pthread_mutex_lock(&is->mu);
+        s->len = len;
+        s->pos = 0;
+        s->full = len > 0;
+        if (rc != 0) is->failed = true;
+        if (rc != 0 || eof) is->done = true;
+        const bool finished = is->done;
+        pthread_cond_broadcast(&is->cv);
+        pthread_mutex_unlock(&is->mu);
+        if (finished) break;
+
+        if (want < IS_SLOT_MAX) want *= 2;
+    }
+    (*is->jvm)->DetachCurrentThread(is->jvm);
+    return NULL;
+}
+
+/**
+ * Loader callback: copies the next read_size bytes from the read-ahead
+ * blocks, waiting for the reader when it is behind.
+ *
+ * Always fills the request unless the stream ended or failed (whisper.cpp
+ * issues one read per tensor and does not retry short reads).
+ *
+ * @return bytes copied; less than read_size only at EOF / error
+ */
+static size_t is_read(void *ctx, void *output, size_t read_size) {
+    struct input_stream_context *is = (struct input_stream_context *)ctx;
+    if (!is || is->eof) return 0;
+
+    uint8_t *out = (uint8_t *)output;
+    size_t got = 0;
+    pthread_mutex_lock(&is->mu);
+    while (got < read_size) {
+        struct is_slot *s = &is->slot[is->head];
+        if (!s->full && !is->done) {
+            const double t0 = now_ms();
+            while (!s->full && !is->done) pthread_cond_wait(&is->cv, &is->mu);
+            is->wait_ms += now_ms() - t0;
+        }
+        if (!s->full) break;  // drained and the reader has finished
+
+        // A full slot is never touched by the reader: copy without the lock.
+        const size_t n = (read_size - got < s->len - s->pos) ? read_size - got : s->len - s->pos;
+        pthread_mutex_unlock(&is->mu);
+        memcpy(out + got, s->data + s->pos, n);
+        pthread_mutex_lock(&is->mu);
+
+        s->pos += n;
+        got += n;
+        if (s->pos == s->len) {
+            s->full = false;
+            is->head = (is->head + 1) % IS_SLOTS;
+            pthread_cond_broadcast(&is->cv);
+        }
     }
-    memcpy(output, ptr, (size_t)n);
-    (*env)->ReleaseByteArrayElements(env, (jbyteArray)is->buffer_gl, ptr, JNI_ABORT);
-    return (size_t)n;
+    if (got < read_size) {
+        is->eof = true;
+        if (is->failed) LOGE("InputStream read failed after %zu bytes", is->total + got);
+    }
+    is->total += got;
+    pthread_mutex_unlock(&is->mu);
+    return got;
 }
 
 /** Returns EOF flag for InputStream loader. */
 static bool is_eof(void *ctx) {
     struct input_stream_context* is = (struct input_stream_context*)ctx;
-    return is ? (is->eof != 0) : true;
+    return is ? is->eof : true;
 }
 
 /**
- * Closes the InputStream loader context, deletes global references,
- * detaches thread if self-attached, and frees the context.
+ * Closes the InputStream loader context: stops and joins the reader
+ * (after its current Java read returns), deletes global references and
+ * frees the blocks.
  *
  * @param ctx Pointer to input_stream_context
  */
@@ -125,27 +1043,33 @@ static void is_close(void *ctx) {
     struct input_stream_context* is = (struct input_stream_context*)ctx;
     if (!is) return;
 
+    if (is->reader_started) {
+        pthread_mutex_lock(&is->mu);
+        atomic_store(&is->stop, true);
+        pthread_cond_broadcast(&is->cv);
+        pthread_mutex_unlock(&is->mu);
+        pthread_join(is->reader, NULL);
+    }
+    LOGI("InputStream loader: %zu bytes, %d Java reads, loader waited %.0f ms on I/O",
+         is->total, is->java_reads, is->wait_ms);
+
     JNIEnv* env = get_env_from_jvm(is->jvm, NULL);
     if (env) {
-        if (is->input_stream) {
-            (*env)->DeleteGlobalRef(env, is->input_stream);
-            is->input_stream = NULL;
-        }
-        if (is->buffer_gl) {
-            (*env)->DeleteGlobalRef(env, is->buffer_gl);
-            is->buffer_gl = NULL;
-        }
-    }
-    if (is->jvm && is->attached_by_us) {
-        (*is->jvm)->DetachCurrentThread(is->jvm);
+        if (is->input_stream) (*env)->DeleteGlobalRef(env, is->input_stream);
+        if (is->buffer_gl) (*env)->DeleteGlobalRef(env, is->buffer_gl);
     }
+    for (int i = 0; i < IS_SLOTS; ++i) free(is->slot[i].data);
+    pthread_cond_destroy(&is->cv);
+    pthread_mutex_destroy(&is->mu);
     free(is);
 }
 
 /**
  * Initializes whisper_context by streaming model bytes from a Java InputStream.
  *
- * Thread-safe: yes, initialization runs synchronously.
+ * The stream is consumed on a native reader thread (read-ahead), so it
+ * must not be used by anyone else until this call returns. No extra
+ * buffering layer is needed on the Java side.
  *
  * @param env JNI environment
  * @param clazz Java class (unused)
@@ -160,15 +1084,18 @@ Java_com_whispercpp_whisper_WhisperLib_initContextFromInputStream(
 
     struct input_stream_context* inp = calloc(1, sizeof(*inp));
     if (!inp) { LOGE("calloc() failed"); return 0; }
+    pthread_mutex_init(&inp->mu, NULL);
+    pthread_cond_init(&inp->cv, NULL);
+    atomic_init(&inp->stop, false);
 
     if ((*env)->GetJavaVM(env, &inp->jvm) != 0) {
         LOGE("GetJavaVM() failed");
-        free(inp);
+        is_close(inp);
         return 0;
     }
 
     inp->input_stream = (*env)->NewGlobalRef(env, input_stream);
-    if (!inp->input_stream) { LOGE("NewGlobalRef(InputStream) failed"); free(inp); return 0; }
+    if (!inp->input_stream) { LOGE("NewGlobalRef(InputStream) failed"); is_close(inp); return 0; }
 
     jclass cls = (*env)->GetObjectClass(env, input_stream);
     if (!cls) { LOGE("GetObjectClass() failed"); is_close(inp); return 0; }
@@ -177,28 +1104,36 @@ Java_com_whispercpp_whisper_WhisperLib_initContextFromInputStream(
     (*env)->DeleteLocalRef(env, cls);
     if (!inp->mid_read) { LOGE("GetMethodID(read) failed"); is_close(inp); return 0; }
 
-    inp->buf_len = 64 * 1024;
+    inp->buf_len = IS_JAVA_CHUNK;
     jbyteArray buf_local = (*env)->NewByteArray(env, inp->buf_len);
-    if (!buf_local) { LOGE("NewByteArray() failed"); is_close(inp); return 0; }
+    if (!buf_local) { LOGE("NewByteArray() failed"); (*env)->ExceptionClear(env); is_close(inp); return 0; }
 
     inp->buffer_gl = (*env)->NewGlobalRef(env, buf_local);
     (*env)->DeleteLocalRef(env, buf_local);
     if (!inp->buffer_gl) { LOGE("NewGlobalRef(buffer) failed"); is_close(inp); return 0; }
 
-    inp->attached_by_us = 0;
+    if (pthread_create(&inp->reader, NULL, is_reader_main, inp) != 0) {
+        LOGE("pthread_create(InputStream reader) failed");
+        is_close(inp);
+        return 0;
+    }
+    inp->reader_started = true;
 
+    // whisper.cpp closes the loader itself (success or failure).
     struct whisper_model_loader loader = { inp, is_read, is_eof, is_close };
-    struct whisper_context_params cparams = whisper_context_default_params();
+    struct whisper_context_params cparams = jni_context_params();
+    struct jni_load_probe probe;
+    jni_load_begin(&probe);
     struct whisper_context *ctx = whisper_init_with_params(&loader, cparams);
+    jni_load_end(&probe);
 
     if (!ctx) {
         LOGE("whisper_init_with_params() failed (InputStream)");
-        is_close(inp);
         return 0;
     }
 
-    LOGI("✅ Whisper model successfully loaded from InputStream");
-    return (jlong)ctx;
+    LOGI("✅ Whisper model successfully loaded from InputStream (%.0f ms)", probe.ms);
+    return jni_context_wrap(ctx, &probe);
 }
 
 /* ============================================================
@@ -245,197 +1180,2579 @@ static struct whisper_context* whisper_init_from_asset(
     if (!asset) { LOGE("AAssetManager_open() failed for: %s", asset_path); return NULL; }
 
     struct whisper_model_loader loader = { asset, asset_read, asset_eof, asset_close };
-    struct whisper_context_params cparams = whisper_context_default_params();
+    struct whisper_context_params cparams = jni_context_params();
     struct whisper_context *ctx = whisper_init_with_params(&loader, cparams);
     if (!ctx) LOGE("whisper_init_with_params() failed (Asset)");
     return ctx;
 }
 
+/* ============================================================
+ * Mapped asset loading (uncompressed APK entries)
+ * ============================================================ */
+
 /**
- * JNI wrapper for initContextFromAsset().
+ * Read-only mapping of an uncompressed asset inside the APK.
  *
- * @param env JNI environment
- * @param clazz class ref
- * @param mgr AssetManager
+ * Fields:
+ * - map_base / map_len: page-aligned region returned by mmap()
+ * - data / len: start and size of the asset payload within the mapping
+ * - pos: current read cursor (bytes from data)
+ * - dropped: bytes (from map_base) already released with MADV_DONTNEED
+ */
+struct mapped_asset_context {
+    uint8_t       *map_base;
+    size_t         map_len;
+    const uint8_t *data;
+    size_t         len;
+    size_t         pos;
+    size_t         dropped;
+};
+
+/** Granularity at which consumed pages are handed back to the kernel (4 MB). */
+#define MAPPED_ASSET_DROP_CHUNK ((size_t)4 * 1024 * 1024)
+
+static struct mapped_asset_context* mapped_fd_open(int fd, off64_t start, off64_t length);
+
+/**
+ * Copies the next block straight from the mapped APK region.
+ *
+ * Pages already consumed are released with MADV_DONTNEED so the mapping
+ * never holds more than one drop chunk of the model in RSS.
+ */
+static size_t mapped_read(void *ctx, void *output, size_t read_size) {
+    struct mapped_asset_context *m = (struct mapped_asset_context *)ctx;
+    if (!m || m->pos >= m->len) return 0;
+
+    const size_t n = (read_size > m->len - m->pos) ? (m->len - m->pos) : read_size;
+    memcpy(output, m->data + m->pos, n);
+    m->pos += n;
+
+    const size_t consumed = (size_t)(m->data - m->map_base) + m->pos;
+    if (consumed - m->dropped >= MAPPED_ASSET_DROP_CHUNK) {
+        const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        const size_t upto = consumed & ~(page - 1);
+        if (upto > m->dropped) {
+            madvise(m->map_base + m->dropped, upto - m->dropped, MADV_DONTNEED);
+            m->dropped = upto;
+        }
+    }
+    return n;
+}
+
+/** EOF once the cursor reaches the payload end. */
+static bool mapped_eof(void *ctx) {
+    struct mapped_asset_context *m = (struct mapped_asset_context *)ctx;
+    return m ? (m->pos >= m->len) : true;
+}
+
+/** Unmaps the APK region and frees the loader context. */
+static void mapped_close(void *ctx) {
+    struct mapped_asset_context *m = (struct mapped_asset_context *)ctx;
+    if (!m) return;
+    if (m->map_base) munmap(m->map_base, m->map_len);
+    free(m);
+}
+
+/**
+ * Maps an asset directly from the APK file when it is stored uncompressed
+ * (see mapped_fd_open).
+ *
+ * AAsset_openFileDescriptor64() only succeeds for uncompressed entries
+ * (see `androidResources.noCompress` in the app module); for compressed
+ * entries this returns NULL and the caller falls back to streaming.
+ *
+ * @param asset opened AAsset (ownership stays with the caller)
+ * @return mapped loader context or NULL if mapping is not possible
+ */
+static struct mapped_asset_context* mapped_asset_open(AAsset *asset) {
+    off64_t start = 0, length = 0;
+    const int fd = AAsset_openFileDescriptor64(asset, &start, &length);
+    if (fd < 0) return NULL;
+    struct mapped_asset_context *m = mapped_fd_open(fd, start, length);
+    close(fd);  // mapping keeps its own reference to the file
+    return m;
+}
+
+/**
+ * Maps bytes [start, start + length) of fd read-only (any start offset;
+ * the mapping itself begins on the enclosing page). fd is not closed.
+ *
+ * @return mapped loader context or NULL if the range cannot be mapped
+ */
+static struct mapped_asset_context* mapped_fd_open(int fd, off64_t start, off64_t length) {
+    if (fd < 0 || length <= 0) return NULL;
+
+    const off64_t page = (off64_t)sysconf(_SC_PAGESIZE);
+    const off64_t aligned = start & ~(page - 1);
+    const size_t  delta = (size_t)(start - aligned);
+    const size_t  map_len = delta + (size_t)length;
+
+    void *base = mmap(NULL, map_len, PROT_READ, MAP_PRIVATE, fd, aligned);
+    if (base == MAP_FAILED) {
+        LOGW("mmap() failed (len=%zu)", map_len);
+        return NULL;
+    }
+    madvise(base, map_len, MADV_SEQUENTIAL);
+
+    struct mapped_asset_context *m = calloc(1, sizeof(*m));
+    if (!m) { munmap(base, map_len); return NULL; }
+    m->map_base = (uint8_t *)base;
+    m->map_len  = map_len;
+    m->data     = (const uint8_t *)base + delta;
+    m->len      = (size_t)length;
+    return m;
+}
+
+/**
+ * Initializes whisper context from an asset, preferring a direct mmap of the
+ * APK entry over the AAsset streaming reader.
+ *
+ * Falls back to [whisper_init_from_asset] when the entry is compressed or
+ * cannot be mapped.
+ *
+ * @param env JNI environment
+ * @param mgrObj AssetManager Java object
+ * @param asset_path asset filename within /assets
+ * @return whisper_context pointer or NULL
+ */
+static struct whisper_context* whisper_init_from_asset_mapped(
+        JNIEnv *env, jobject mgrObj, const char *asset_path) {
+    if (!mgrObj || !asset_path) { LOGW("Invalid asset arguments"); return NULL; }
+
+    AAssetManager *mgr = AAssetManager_fromJava(env, mgrObj);
+    if (!mgr) { LOGE("AAssetManager_fromJava() failed"); return NULL; }
+
+    AAsset *asset = AAssetManager_open(mgr, asset_path, AASSET_MODE_UNKNOWN);
+    if (!asset) { LOGE("AAssetManager_open() failed for: %s", asset_path); return NULL; }
+
+    struct mapped_asset_context *m = mapped_asset_open(asset);
+    AAsset_close(asset);
+    if (!m) {
+        LOGW("Asset is compressed or not mappable, streaming instead: %s", asset_path);
+        return whisper_init_from_asset(env, mgrObj, asset_path);
+    }
+
+    LOGI("Loading model from mapped asset: %s (%zu bytes)", asset_path, m->len);
+    struct whisper_model_loader loader = { m, mapped_read, mapped_eof, mapped_close };
+    struct whisper_context_params cparams = jni_context_params();
+    struct whisper_context *ctx = whisper_init_with_params(&loader, cparams);
+    if (!ctx) LOGE("whisper_init_with_params() failed (Mapped asset)");
+    return ctx;
+}
+
+/**
+ * JNI wrapper for initContextFromAsset().
+ *
+ * @param env JNI environment
+ * @param clazz class ref
+ * @param mgr AssetManager
+ * @param pathStr model asset filename
+ * @return whisper_context pointer
+ */
+JNIEXPORT jlong JNICALL
+Java_com_whispercpp_whisper_WhisperLib_initContextFromAsset(
+        JNIEnv *env, jclass clazz, jobject mgr, jstring pathStr) {
+    (void)clazz;
+    if (!pathStr) return 0;
+
+    const char *path = (*env)->GetStringUTFChars(env, pathStr, NULL);
+    if (!path) return 0;
+    struct jni_load_probe probe;
+    jni_load_begin(&probe);
+    struct whisper_context *ctx = whisper_init_from_asset(env, mgr, path);
+    jni_load_end(&probe);
+    (*env)->ReleaseStringUTFChars(env, pathStr, path);
+    return jni_context_wrap(ctx, &probe);
+}
+
+/**
+ * JNI wrapper for initContextFromAssetMapped().
+ *
+ * @param env JNI environment
+ * @param clazz class ref
+ * @param mgr AssetManager
  * @param pathStr model asset filename
  * @return whisper_context pointer
  */
 JNIEXPORT jlong JNICALL
-Java_com_whispercpp_whisper_WhisperLib_initContextFromAsset(
-        JNIEnv *env, jclass clazz, jobject mgr, jstring pathStr) {
+Java_com_whispercpp_whisper_WhisperLib_initContextFromAssetMapped(
+        JNIEnv *env, jclass clazz, jobject mgr, jstring pathStr) {
+    (void)clazz;
+    if (!pathStr) return 0;
+
+    const char *path = (*env)->GetStringUTFChars(env, pathStr, NULL);
+    if (!path) return 0;
+    struct jni_load_probe probe;
+    jni_load_begin(&probe);
+    struct whisper_context *ctx = whisper_init_from_asset_mapped(env, mgr, path);
+    jni_load_end(&probe);
+    (*env)->ReleaseStringUTFChars(env, pathStr, path);
+    return jni_context_wrap(ctx, &probe);
+}
+
+/**
+ * Loads a model file through the mapped reader (mmap + MADV_SEQUENTIAL,
+ * consumed pages dropped), like uncompressed assets. Falls back to
+ * whisper.cpp's buffered file reader when the file cannot be mapped.
+ */
+static struct whisper_context* whisper_init_from_file_mapped(const char *path) {
+    struct whisper_context_params cparams = jni_context_params();
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    struct mapped_asset_context *m = NULL;
+    if (fd >= 0 && fstat(fd, &st) == 0) m = mapped_fd_open(fd, 0, (off64_t)st.st_size);
+    if (fd >= 0) close(fd);
+    if (!m) {
+        LOGW("Model file not mappable, reading instead: %s", path);
+        return whisper_init_from_file_with_params(path, cparams);
+    }
+
+    LOGI("Loading model from mapped file: %s (%zu bytes)", path, m->len);
+    struct whisper_model_loader loader = { m, mapped_read, mapped_eof, mapped_close };
+    struct whisper_context *ctx = whisper_init_with_params(&loader, cparams);
+    if (!ctx) LOGE("whisper_init_with_params() failed (Mapped file)");
+    return ctx;
+}
+
+/**
+ * Initializes whisper_context from a direct file path on local storage.
+ *
+ * Fastest method: the file is mmap()ed and read sequentially
+ * (whisper_init_from_file_mapped); no APK / zip layer in between.
+ *
+ * @param env JNI environment
+ * @param clazz class reference
+ * @param pathStr Java string path
+ * @return whisper_context pointer or 0
+ */
+JNIEXPORT jlong JNICALL
+Java_com_whispercpp_whisper_WhisperLib_initContext(
+        JNIEnv *env, jclass clazz, jstring pathStr) {
+    (void)clazz;
+    if (!pathStr) { LOGW("pathStr is NULL"); return 0; }
+
+    const char *path = (*env)->GetStringUTFChars(env, pathStr, NULL);
+    if (!path) { LOGE("GetStringUTFChars() failed"); return 0; }
+
+    struct jni_load_probe probe;
+    jni_load_begin(&probe);
+    struct whisper_context *ctx = whisper_init_from_file_mapped(path);
+    jni_load_end(&probe);
+
+    if (!ctx) LOGE("Model load failed: %s", path);
+    else LOGI("✅ Whisper model loaded from file: %s (%.0f ms)", path, probe.ms);
+    (*env)->ReleaseStringUTFChars(env, pathStr, path);
+    return jni_context_wrap(ctx, &probe);
+}
+
+/* ============================================================
+ * Process-wide model cache
+ * ============================================================ */
+
+/**
+ * One cached model, keyed by content fingerprint and size. The path is
+ * not part of the key, so an asset and its extracted copy in app storage
+ * share one entry instead of both staying resident.
+ *
+ * Fields:
+ * - path: where the entry was first loaded from (logs only)
+ * - hash: cache key together with bytes (see asset_fingerprint)
+ * - bytes: asset size; charged against the cache budget together with the
+ *   default state (see model_cache_charge)
+ * - ctx: loaded weights; freed only on eviction
+ * - refs: live JNI handles over ctx (entries with refs > 0 are never evicted)
+ * - default_busy: one handle runs on ctx's default state; further handles
+ *   get a private whisper_state so they never share decoder buffers
+ * - last_use: g_model_cache_tick at the last acquire/release (LRU order)
+ * - kv_bytes / compute_bytes: default-state buffer sizes logged at load.
+ *   whisper.cpp keeps the default state until whisper_free(), so an idle
+ *   entry holds these buffers as well as its weights
+ */
+struct model_cache_entry {
+    struct model_cache_entry *next;
+    char                   *path;
+    uint64_t                hash;
+    int64_t                 bytes;
+    struct whisper_context *ctx;
+    int                     refs;
+    bool                    default_busy;
+    uint64_t                last_use;
+    int64_t                 kv_bytes;
+    int64_t                 compute_bytes;
+};
+
+static pthread_mutex_t           g_model_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct model_cache_entry *g_model_cache;
+static int64_t                   g_model_cache_bytes;
+static int64_t                   g_model_cache_budget = (int64_t)512 * 1024 * 1024;
+static uint64_t                  g_model_cache_tick;
+
+/** Bytes an entry holds while cached: weights plus its default state's KV / compute buffers. */
+static inline int64_t model_cache_charge(const struct model_cache_entry *e) {
+    return e->bytes + e->kv_bytes + e->compute_bytes;
+}
+
+/** Fingerprint block size and count (first / last block always included). */
+#define FINGERPRINT_BLOCK   4096
+#define FINGERPRINT_SAMPLES 32
+
+/** FNV-1a 64-bit over p[0..n). */
+static uint64_t fnv1a64(uint64_t h, const uint8_t *p, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/**
+ * Sampled content hash of an asset: its length plus FINGERPRINT_SAMPLES
+ * evenly spaced blocks (header, tensors, tail). Reads ~128 KB, so a cache
+ * lookup stays in the millisecond range even for large models, while a
+ * replaced model under the same path (app update) still gets a new key.
+ *
+ * @return true on success (hash / bytes filled)
+ */
+static bool asset_fingerprint(AAssetManager *mgr, const char *path, uint64_t *hash, int64_t *bytes) {
+    AAsset *asset = AAssetManager_open(mgr, path, AASSET_MODE_RANDOM);
+    if (!asset) return false;
+
+    const off64_t len = AAsset_getLength64(asset);
+    uint64_t h = fnv1a64(0xcbf29ce484222325ULL, (const uint8_t *)&len, sizeof(len));
+    uint8_t buf[FINGERPRINT_BLOCK];
+    bool ok = len > 0;
+
+    const off64_t block = len < FINGERPRINT_BLOCK ? len : FINGERPRINT_BLOCK;
+    for (int i = 0; ok && i < FINGERPRINT_SAMPLES; ++i) {
+        const off64_t off = (len - block) * i / (FINGERPRINT_SAMPLES - 1);
+        if (AAsset_seek64(asset, off, SEEK_SET) < 0) { ok = false; break; }
+        off64_t got = 0;
+        while (got < block) {
+            const int r = AAsset_read(asset, buf + got, (size_t)(block - got));
+            if (r <= 0) break;
+            got += r;
+        }
+        if (got != block) { ok = false; break; }
+        h = fnv1a64(h, buf, (size_t)block);
+    }
+    AAsset_close(asset);
+
+    if (!ok) { LOGW("asset_fingerprint: could not sample %s", path); return false; }
+    *hash = h;
+    *bytes = (int64_t)len;
+    return true;
+}
+
+/** Finds the entry for (hash, bytes), wherever it was loaded from. Lock held. */
+static struct model_cache_entry* model_cache_find_locked(uint64_t hash, int64_t bytes) {
+    for (struct model_cache_entry *e = g_model_cache; e; e = e->next)
+        if (e->hash == hash && e->bytes == bytes) return e;
+    return NULL;
+}
+
+/** Frees idle entries, least recently used first, until the total fits limit. Lock held. */
+static void model_cache_evict_locked(int64_t limit) {
+    while (g_model_cache_bytes > limit) {
+        struct model_cache_entry **victim = NULL;
+        for (struct model_cache_entry **pp = &g_model_cache; *pp; pp = &(*pp)->next) {
+            if ((*pp)->refs == 0 && (!victim || (*pp)->last_use < (*victim)->last_use)) victim = pp;
+        }
+        if (!victim) break;  // everything left is in use
+
+        struct model_cache_entry *e = *victim;
+        *victim = e->next;
+        g_model_cache_bytes -= model_cache_charge(e);
+        LOGI("Model cache: evicting %s (%lld bytes, %lld cached)",
+             e->path, (long long)model_cache_charge(e), (long long)g_model_cache_bytes);
+        whisper_free(e->ctx);
+        free(e->path);
+        free(e);
+    }
+}
+
+/**
+ * Drops one reference taken by initContextFromAssetCached().
+ *
+ * @param on_default the handle ran on ctx's default state
+ */
+static void model_cache_release(struct model_cache_entry *e, bool on_default) {
+    pthread_mutex_lock(&g_model_cache_lock);
+    e->refs--;
+    if (on_default) e->default_busy = false;
+    e->last_use = ++g_model_cache_tick;
+    model_cache_evict_locked(g_model_cache_budget);
+    pthread_mutex_unlock(&g_model_cache_lock);
+}
+
+/**
+ * Same sampled fingerprint as asset_fingerprint(), over a regular file
+ * (pread; the extracted-model copy in app storage).
+ */
+static bool file_fingerprint(const char *path, uint64_t *hash, int64_t *bytes) {
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    const off64_t len = (fstat(fd, &st) == 0) ? (off64_t)st.st_size : 0;
+    uint64_t h = fnv1a64(0xcbf29ce484222325ULL, (const uint8_t *)&len, sizeof(len));
+    uint8_t buf[FINGERPRINT_BLOCK];
+    bool ok = len > 0;
+
+    const off64_t block = len < FINGERPRINT_BLOCK ? len : FINGERPRINT_BLOCK;
+    for (int i = 0; ok && i < FINGERPRINT_SAMPLES; ++i) {
+        const off64_t off = (len - block) * i / (FINGERPRINT_SAMPLES - 1);
+        ok = pread64(fd, buf, (size_t)block, off) == (ssize_t)block;
+        if (ok) h = fnv1a64(h, buf, (size_t)block);
+    }
+    close(fd);
+
+    if (!ok) { LOGW("file_fingerprint: could not sample %s", path); return false; }
+    *hash = h;
+    *bytes = (int64_t)len;
+    return true;
+}
+
+/** Where a cache miss loads the model from: an asset (env / mgr set) or a file. */
+struct model_source {
+    JNIEnv     *env;
+    jobject     mgr;
+    const char *path;
+};
+
+static struct whisper_context* model_source_load(const struct model_source *src) {
+    return src->mgr ? whisper_init_from_asset_mapped(src->env, src->mgr, src->path)
+                    : whisper_init_from_file_mapped(src->path);
+}
+
+/**
+ * Returns a handle over the cached model for (src->path, hash), loading it
+ * on a miss. The first concurrent user of an entry runs on the model's
+ * default state, later ones get a private whisper_state.
+ *
+ * @param t0 start of the request (load.ms covers the fingerprint as well)
+ * @return context handle, or 0 on failure
+ */
+static jlong model_cache_acquire(const struct model_source *src, uint64_t hash, int64_t bytes, double t0) {
+    const char *path = src->path;
+    struct jni_load_probe probe = {0};
+    // Same weights with other DTW heads are a different whisper_context.
+    const int dtw = atomic_load(&g_dtw_preset);
+    hash = fnv1a64(hash, (const uint8_t *)&dtw, sizeof(dtw));
+
+    pthread_mutex_lock(&g_model_cache_lock);
+    struct model_cache_entry *e = model_cache_find_locked(hash, bytes);
+    if (e) e->refs++;  // pin before unlocking
+    pthread_mutex_unlock(&g_model_cache_lock);
+
+    if (e) {
+        LOGI("Model cache hit: %s (loaded from %s)", path, e->path);
+    } else {
+        // Load outside the lock; another thread may race us to the same key.
+        jni_load_begin(&probe);
+        struct whisper_context *ctx = model_source_load(src);
+        jni_load_end(&probe);
+        if (!ctx) return 0;
+
+        pthread_mutex_lock(&g_model_cache_lock);
+        e = model_cache_find_locked(hash, bytes);
+        if (e) {
+            e->refs++;
+            whisper_free(ctx);
+        } else if ((e = calloc(1, sizeof(*e))) && (e->path = strdup(path))) {
+            e->hash = hash;
+            e->bytes = bytes;
+            e->ctx = ctx;
+            e->kv_bytes = probe.kv_bytes;
+            e->compute_bytes = probe.compute_bytes;
+            e->refs = 1;
+            e->next = g_model_cache;
+            g_model_cache = e;
+            g_model_cache_bytes += model_cache_charge(e);
+            LOGI("Model cache: added %s (%lld bytes incl. %lld state, %lld cached)",
+                 path, (long long)model_cache_charge(e), (long long)(e->kv_bytes + e->compute_bytes),
+                 (long long)g_model_cache_bytes);
+            model_cache_evict_locked(g_model_cache_budget);
+        } else {
+            free(e);
+            e = NULL;
+        }
+        pthread_mutex_unlock(&g_model_cache_lock);
+        if (!e) {
+            LOGE("Model cache: entry allocation failed");
+            return jni_context_wrap(ctx, &probe);
+        }
+    }
+
+    pthread_mutex_lock(&g_model_cache_lock);
+    const bool on_default = !e->default_busy;
+    e->default_busy = true;
+    e->last_use = ++g_model_cache_tick;
+    pthread_mutex_unlock(&g_model_cache_lock);
+
+    struct whisper_jni_context *jc = jni_context_alloc(e->ctx);
+    if (jc && !on_default) {
+        jni_load_begin(&probe);
+        jc->state = whisper_init_state(e->ctx);
+        jni_load_end(&probe);
+        if (!jc->state) { LOGE("whisper_init_state() failed"); free(jc); jc = NULL; }
+    }
+    if (!jc) { model_cache_release(e, on_default); return 0; }
+    jc->cache = e;
+    if (on_default) {  // the entry's default state: sizes seen when it was loaded
+        probe.kv_bytes = e->kv_bytes;
+        probe.compute_bytes = e->compute_bytes;
+    }
+    jc->load = probe;
+    jc->load.ms = now_ms() - t0;  // a hit costs the fingerprint only
+    return (jlong)jc;
+}
+
+/**
+ * Returns a handle over a cached model, loading it on a miss.
+ *
+ * The key is the asset path plus a sampled content hash. A hit only costs
+ * the fingerprint read and a handle allocation (see model_cache_acquire).
+ * freeContext() returns the reference; the weights stay resident until
+ * evicted (budget exceeded or modelCacheTrim()).
+ *
+ * Falls back to an uncached mapped load when the asset cannot be
+ * fingerprinted.
+ *
+ * @param env JNI environment
+ * @param clazz class ref
+ * @param mgr AssetManager
+ * @param pathStr model asset filename
+ * @return context handle, or 0 on failure
+ */
+JNIEXPORT jlong JNICALL
+Java_com_whispercpp_whisper_WhisperLib_initContextFromAssetCached(
+        JNIEnv *env, jclass clazz, jobject mgr, jstring pathStr) {
+    (void)clazz;
+    if (!mgr || !pathStr) return 0;
+    AAssetManager *amgr = AAssetManager_fromJava(env, mgr);
+    if (!amgr) { LOGE("AAssetManager_fromJava() failed"); return 0; }
+
+    const char *path = (*env)->GetStringUTFChars(env, pathStr, NULL);
+    if (!path) return 0;
+
+    const double t0 = now_ms();
+    uint64_t hash = 0;
+    int64_t bytes = 0;
+    jlong handle;
+    if (asset_fingerprint(amgr, path, &hash, &bytes)) {
+        const struct model_source src = { env, mgr, path };
+        handle = model_cache_acquire(&src, hash, bytes, t0);
+    } else {
+        struct jni_load_probe probe;
+        jni_load_begin(&probe);
+        struct whisper_context *ctx = whisper_init_from_asset_mapped(env, mgr, path);
+        jni_load_end(&probe);
+        handle = jni_context_wrap(ctx, &probe);
+    }
+    (*env)->ReleaseStringUTFChars(env, pathStr, path);
+    return handle;
+}
+
+/**
+ * initContextFromAssetCached() for a model file (e.g. one extracted from
+ * the APK to app storage): same sampled content hash as the asset, so the
+ * copy hits an entry loaded from its asset; mapped file reader on a miss.
+ *
+ * @param pathStr model file path
+ * @return context handle, or 0 on failure
+ */
+JNIEXPORT jlong JNICALL
+Java_com_whispercpp_whisper_WhisperLib_initContextFromFileCached(
+        JNIEnv *env, jclass clazz, jstring pathStr) {
+    (void)clazz;
+    if (!pathStr) return 0;
+    const char *path = (*env)->GetStringUTFChars(env, pathStr, NULL);
+    if (!path) return 0;
+
+    const double t0 = now_ms();
+    uint64_t hash = 0;
+    int64_t bytes = 0;
+    jlong handle;
+    if (file_fingerprint(path, &hash, &bytes)) {
+        const struct model_source src = { env, NULL, path };
+        handle = model_cache_acquire(&src, hash, bytes, t0);
+    } else {
+        struct jni_load_probe probe;
+        jni_load_begin(&probe);
+        struct whisper_context *ctx = whisper_init_from_file_mapped(path);
+        jni_load_end(&probe);
+        handle = jni_context_wrap(ctx, &probe);
+    }
+    (*env)->ReleaseStringUTFChars(env, pathStr, path);
+    return handle;
+}
+
+/**
+ * Sets the cache budget in bytes and evicts idle models beyond it.
+ * Models in use are never evicted, so the total may exceed the budget.
+ */
+JNIEXPORT void JNICALL
+Java_com_whispercpp_whisper_WhisperLib_modelCacheSetBudget(JNIEnv *env, jclass clazz, jlong bytes) {
+    (void)env; (void)clazz;
+    pthread_mutex_lock(&g_model_cache_lock);
+    g_model_cache_budget = bytes > 0 ? (int64_t)bytes : 0;
+    model_cache_evict_locked(g_model_cache_budget);
+    pthread_mutex_unlock(&g_model_cache_lock);
+}
+
+/**
+ * Evicts idle models (LRU first) until at most limitBytes stay cached.
+ * Used for memory-pressure callbacks; pass 0 to drop every idle model.
+ *
+ * @return bytes still cached
+ */
+JNIEXPORT jlong JNICALL
+Java_com_whispercpp_whisper_WhisperLib_modelCacheTrim(JNIEnv *env, jclass clazz, jlong limitBytes) {
+    (void)env; (void)clazz;
+    pthread_mutex_lock(&g_model_cache_lock);
+    model_cache_evict_locked(limitBytes > 0 ? (int64_t)limitBytes : 0);
+    const int64_t left = g_model_cache_bytes;
+    pthread_mutex_unlock(&g_model_cache_lock);
+    return (jlong)left;
+}
+
+/**
+ * Snapshot of the cache.
+ *
+ * @return long[4] = { entries, entries in use, cached bytes, budget bytes }
+ */
+JNIEXPORT jlongArray JNICALL
+Java_com_whispercpp_whisper_WhisperLib_modelCacheStats(JNIEnv *env, jclass clazz) {
+    (void)clazz;
+    jlong out[4] = { 0, 0, 0, 0 };
+    pthread_mutex_lock(&g_model_cache_lock);
+    for (struct model_cache_entry *e = g_model_cache; e; e = e->next) {
+        out[0]++;
+        if (e->refs > 0) out[1]++;
+    }
+    out[2] = g_model_cache_bytes;
+    out[3] = g_model_cache_budget;
+    pthread_mutex_unlock(&g_model_cache_lock);
+
+    jlongArray arr = (*env)->NewLongArray(env, 4);
+    if (!arr) return NULL;
+    (*env)->SetLongArrayRegion(env, arr, 0, 4, out);
+    return arr;
+}
+
+/**
+ * Frees a whisper_context and releases all native resources.
+ *
+ * Safe to call multiple times (idempotent).
+ *
+ * @param env JNI environment
+ * @param clazz class ref
+ * @param ptr native pointer to whisper_context
+ */
+JNIEXPORT void JNICALL
+Java_com_whispercpp_whisper_WhisperLib_freeContext(
+        JNIEnv *env, jclass clazz, jlong ptr) {
+    (void)clazz;
+    struct whisper_jni_context *jc = jni_context(ptr);
+    if (jc) {
+        const bool own_state = jc->state != NULL;
+        if (own_state) whisper_free_state(jc->state);  // pool / cache state: weights stay shared
+        if (jc->cache) model_cache_release(jc->cache, !own_state);  // weights stay cached
+        else if (!own_state) whisper_free(jc->ctx);
+        jni_result_reset(jc);
+        jni_mel_forget(jc);
+        jni_listener_free(env, jc->listener);
+        jni_arena_free(&jc->arena);
+        free(jc->vad_model_path);
+        LOGI("%s freed successfully", jc->parent ? "Whisper pool state" : "Whisper context");
+        free(jc);
+    }
+}
+
+/**
+ * Whether ptr runs on its model's default state. False for pool states and
+ * for a second concurrent handle on a cached model, which get a private
+ * state; streamCreate() and benchModel() need the default state.
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_whispercpp_whisper_WhisperLib_hasDefaultState(JNIEnv *env, jclass clazz, jlong ptr) {
+    (void)env; (void)clazz;
+    struct whisper_jni_context *jc = jni_context(ptr);
+    return (jc && !jc->state) ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Creates an additional decoding state over ctxPtr's model weights.
+ *
+ * The returned handle is accepted by every per-context entry point
+ * (fullTranscribe*, getAllSegments, getTextSegment*, requestAbort, setVad,
+ * setThreadPolicy, freeContext) and runs whisper_full_with_state(), so
+ * several handles can transcribe concurrently from different threads
+ * while the weights are loaded once. The VAD and thread policy of the
+ * parent are copied. Must be freed before the parent context.
+ *
+ * @param ctxPtr parent context handle (must not itself be a pool state)
+ * @return state handle, or 0 on failure
+ */
+JNIEXPORT jlong JNICALL
+Java_com_whispercpp_whisper_WhisperLib_stateCreate(JNIEnv *env, jclass clazz, jlong ctxPtr) {
+    (void)env; (void)clazz;
+    struct whisper_jni_context *parent = jni_context(ctxPtr);
+    if (!parent || parent->parent) { LOGW("stateCreate: invalid parent handle"); return 0; }
+
+    struct whisper_jni_context *jc = calloc(1, sizeof(*jc));
+    if (!jc) return 0;
+    jni_load_begin(&jc->load);
+    jc->state = whisper_init_state(parent->ctx);
+    jni_load_end(&jc->load);
+    if (!jc->state) { LOGE("whisper_init_state() failed"); free(jc); return 0; }
+
+    jc->ctx = parent->ctx;
+    jc->parent = parent;
+    atomic_init(&jc->abort_token, 0);
+    atomic_init(&jc->abort_target, 0);
+    jc->affinity = parent->affinity;
+    jc->has_affinity = parent->has_affinity;
+    jc->nice = parent->nice;
+    jc->vad_mode = parent->vad_mode;
+    jc->vad = parent->vad;
+    jc->vad_model = parent->vad_model;
+    jc->vad_model_path = parent->vad_model_path ? strdup(parent->vad_model_path) : NULL;
+    LOGI("Pool state created: %p (parent %p)", (void *)jc->state, (void *)parent);
+    return (jlong)jc;
+}
+
+/** Silence inserted between compacted speech regions (keeps utterances apart). */
+#define VAD_JOIN_GAP_SAMPLES (WHISPER_SAMPLE_RATE / 10)
+/** Skip compaction when speech already covers this share of the input. */
+#define VAD_MIN_SAVING 0.9
+
+/**
+ * Energy-VAD pre-pass: copies only the speech regions of pcm[0..n) into the
+ * context arena (joined by short silences) and records the mapping in jc.
+ *
+ * @param out receives the compacted buffer (arena-owned), or NULL to use pcm unchanged
+ * @param out_n receives the compacted length
+ * @return 0 on success, 1 if no speech was found, negative on failure
+ */
+static int vad_compact(struct whisper_jni_context *jc, const float *pcm, int n, float **out, int *out_n) {
+    *out = NULL;
+    *out_n = n;
+
+    struct audio_span *spans = NULL;
+    const int count = audio_vad_energy(pcm, (size_t)n, WHISPER_SAMPLE_RATE, &jc->vad, &spans);
+    if (count < 0) return count;
+    if (count == 0) return 1;
+
+    size_t speech = 0;
+    for (int i = 0; i < count; ++i) speech += spans[i].end - spans[i].start;
+    const size_t total = speech + (size_t)(count - 1) * VAD_JOIN_GAP_SAMPLES;
+    if ((double)total >= VAD_MIN_SAVING * (double)n) {
+        LOGI("VAD: speech covers %.0f%% → transcribing unmodified", 100.0 * (double)speech / n);
+        free(spans);
+        return 0;
+    }
+
+    struct jni_arena *a = &jc->arena;
+    if (!jni_arena_reserve((void **)&a->vad, &a->vad_cap, total, sizeof(float)) ||
+        !jni_arena_reserve((void **)&a->map, &a->map_cap, (size_t)count, sizeof(*a->map))) {
+        free(spans);
+        return AUDIO_ERR_NOMEM;
+    }
+    float *buf = a->vad;
+    struct vad_map_entry *map = a->map;
+
+    size_t pos = 0;
+    for (int i = 0; i < count; ++i) {
+        const size_t len = spans[i].end - spans[i].start;
+        memcpy(buf + pos, pcm + spans[i].start, len * sizeof(float));
+        map[i].compact0 = (int64_t)pos;
+        map[i].orig0 = (int64_t)spans[i].start;
+        map[i].len = (int64_t)len;
+        pos += len;
+        if (i + 1 < count) {
+            memset(buf + pos, 0, VAD_JOIN_GAP_SAMPLES * sizeof(float));
+            pos += VAD_JOIN_GAP_SAMPLES;
+        }
+    }
+    free(spans);
+
+    jc->vad_map = map;
+    jc->n_vad_map = count;
+    *out = buf;
+    *out_n = (int)total;
+    LOGI("VAD: %d regions, %d → %zu samples (%.0f%% skipped)",
+         count, n, total, 100.0 * (1.0 - (double)total / n));
+    return 0;
+}
+
+/* ============================================================
+ * Decoding parameters (paramsCreate / paramsSet* / paramsFree)
+ * ============================================================ */
+
+/** Keys for paramsSetInt/Float/String(); mirrored in WhisperDecodeParams.kt. */
+enum jni_param_key {
+    JNI_PARAM_BEAM_SIZE       = 0,   // int ≥ 1 (beam search only)
+    JNI_PARAM_BEST_OF         = 1,   // int ≥ 1 (sampled candidates on fallback)
+    JNI_PARAM_MAX_LEN         = 2,   // int ≥ 0 chars per segment (0 = off)
+    JNI_PARAM_MAX_TOKENS      = 3,   // int ≥ 0 tokens per segment (0 = off)
+    JNI_PARAM_AUDIO_CTX       = 4,   // int ≥ 0 encoder frames (0 = model default)
+    JNI_PARAM_NO_FALLBACK     = 5,   // bool: never re-decode at higher temperature
+    JNI_PARAM_SINGLE_SEGMENT  = 6,   // bool
+    JNI_PARAM_NO_TIMESTAMPS   = 7,   // bool
+    JNI_PARAM_SUPPRESS_BLANK  = 8,   // bool
+    JNI_PARAM_SPLIT_ON_WORD   = 9,   // bool (with MAX_LEN)
+    JNI_PARAM_NO_CONTEXT      = 10,  // bool
+    JNI_PARAM_AUTO_AUDIO_CTX  = 11,  // bool: audio_ctx from the clip length (see jni_pick_audio_ctx)
+    JNI_PARAM_TOKEN_TIMESTAMPS = 12, // bool: per-token t0 / t1 (see getAllTokens)
+    JNI_PARAM_TEMPERATURE     = 20,  // float ≥ 0
+    JNI_PARAM_TEMPERATURE_INC = 21,  // float ≥ 0 (0 disables fallback)
+    JNI_PARAM_ENTROPY_THOLD   = 22,  // float
+    JNI_PARAM_LOGPROB_THOLD   = 23,  // float
+    JNI_PARAM_NO_SPEECH_THOLD = 24,  // float
+    JNI_PARAM_INITIAL_PROMPT  = 30,  // string (NULL clears)
+};
+
+/**
+ * Native decoding parameter block handed to Kotlin as a `paramsPtr`.
+ *
+ * Fields:
+ * - base: whisper_full_params template; per-call fields (language,
+ *   threads, translate, print flags, abort hooks, VAD) are overwritten by
+ *   run_full_transcribe()
+ * - initial_prompt: owned copy referenced by base.initial_prompt
+ * - auto_audio_ctx: size the encoder context to each clip (when
+ *   base.audio_ctx is 0), with a full-context retry on degenerate output
+ * - token_timestamps: requested explicitly; base.token_timestamps is also
+ *   on while max_len splits segments
+ */
+struct jni_decode_params {
+    struct whisper_full_params base;
+    char                      *initial_prompt;
+    bool                       auto_audio_ctx;
+    bool                       token_timestamps;
+};
+
+/** Returns the parameter block for ptr (NULL-safe). */
+static inline struct jni_decode_params* jni_params(jlong ptr) {
+    return (struct jni_decode_params *)ptr;
+}
+
+/**
+ * Creates a parameter block for the given sampling strategy, starting from
+ * whisper_full_default_params() with independent runs (no_context).
+ *
+ * @param strategy 0 = greedy, 1 = beam search
+ * @return params handle, or 0 on invalid strategy / OOM
+ */
+JNIEXPORT jlong JNICALL
+Java_com_whispercpp_whisper_WhisperLib_paramsCreate(JNIEnv *env, jclass clazz, jint strategy) {
+    (void)env; (void)clazz;
+    if (strategy != WHISPER_SAMPLING_GREEDY && strategy != WHISPER_SAMPLING_BEAM_SEARCH) {
+        LOGW("paramsCreate: unknown strategy %d", strategy);
+        return 0;
+    }
+    struct jni_decode_params *dp = calloc(1, sizeof(*dp));
+    if (!dp) { LOGE("calloc() failed for params"); return 0; }
+    dp->base = whisper_full_default_params((enum whisper_sampling_strategy)strategy);
+    dp->base.no_context = true;
+    return (jlong)dp;
+}
+
+/**
+ * Sets an integer or boolean (0/1) parameter.
+ *
+ * @return JNI_FALSE for an unknown key or out-of-range value (block unchanged)
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_whispercpp_whisper_WhisperLib_paramsSetInt(JNIEnv *env, jclass clazz, jlong ptr, jint key, jint value) {
+    (void)env; (void)clazz;
+    struct jni_decode_params *dp = jni_params(ptr);
+    if (!dp) return JNI_FALSE;
+    struct whisper_full_params *p = &dp->base;
+    const bool on = value != 0;
+
+    switch (key) {
+        case JNI_PARAM_BEAM_SIZE:  if (value < 1) return JNI_FALSE; p->beam_search.beam_size = value; break;
+        case JNI_PARAM_BEST_OF:    if (value < 1) return JNI_FALSE; p->greedy.best_of = value; break;
+        case JNI_PARAM_MAX_LEN:
+            if (value < 0) return JNI_FALSE;
+            p->max_len = value;
+            p->token_timestamps = value > 0 || dp->token_timestamps;  // segment splitting needs token times
+            break;
+        case JNI_PARAM_MAX_TOKENS: if (value < 0) return JNI_FALSE; p->max_tokens = value; break;
+        case JNI_PARAM_AUDIO_CTX:  if (value < 0) return JNI_FALSE; p->audio_ctx = value; break;
+        case JNI_PARAM_NO_FALLBACK:
+            // whisper.cpp retries a segment at temperature + k·inc while inc > 0.
+            p->temperature_inc = on ? 0.0f : whisper_full_default_params(WHISPER_SAMPLING_GREEDY).temperature_inc;
+            break;
+        case JNI_PARAM_SINGLE_SEGMENT: p->single_segment = on; break;
+        case JNI_PARAM_NO_TIMESTAMPS:  p->no_timestamps = on; break;
+        case JNI_PARAM_SUPPRESS_BLANK: p->suppress_blank = on; break;
+        case JNI_PARAM_SPLIT_ON_WORD:  p->split_on_word = on; break;
+        case JNI_PARAM_NO_CONTEXT:     p->no_context = on; break;
+        case JNI_PARAM_AUTO_AUDIO_CTX: dp->auto_audio_ctx = on; break;
+        case JNI_PARAM_TOKEN_TIMESTAMPS:
+            dp->token_timestamps = on;
+            p->token_timestamps = on || p->max_len > 0;
+            break;
+        default: LOGW("paramsSetInt: unknown key %d", key); return JNI_FALSE;
+    }
+    return JNI_TRUE;
+}
+
+/**
+ * Sets a float parameter.
+ *
+ * @return JNI_FALSE for an unknown key or out-of-range value (block unchanged)
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_whispercpp_whisper_WhisperLib_paramsSetFloat(JNIEnv *env, jclass clazz, jlong ptr, jint key, jfloat value) {
+    (void)env; (void)clazz;
+    struct jni_decode_params *dp = jni_params(ptr);
+    if (!dp) return JNI_FALSE;
+    struct whisper_full_params *p = &dp->base;
+
+    switch (key) {
+        case JNI_PARAM_TEMPERATURE:     if (value < 0.0f) return JNI_FALSE; p->temperature = value; break;
+        case JNI_PARAM_TEMPERATURE_INC: if (value < 0.0f) return JNI_FALSE; p->temperature_inc = value; break;
+        case JNI_PARAM_ENTROPY_THOLD:   p->entropy_thold = value; break;
+        case JNI_PARAM_LOGPROB_THOLD:   p->logprob_thold = value; break;
+        case JNI_PARAM_NO_SPEECH_THOLD: p->no_speech_thold = value; break;
+        default: LOGW("paramsSetFloat: unknown key %d", key); return JNI_FALSE;
+    }
+    return JNI_TRUE;
+}
+
+/**
+ * Sets a string parameter (copied; NULL clears it).
+ *
+ * @return JNI_FALSE for an unknown key or OOM
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_whispercpp_whisper_WhisperLib_paramsSetString(JNIEnv *env, jclass clazz, jlong ptr, jint key, jstring value) {
+    (void)clazz;
+    struct jni_decode_params *dp = jni_params(ptr);
+    if (!dp) return JNI_FALSE;
+    if (key != JNI_PARAM_INITIAL_PROMPT) { LOGW("paramsSetString: unknown key %d", key); return JNI_FALSE; }
+
+    char *copy = NULL;
+    if (value) {
+        const char *s = (*env)->GetStringUTFChars(env, value, NULL);
+        if (!s) return JNI_FALSE;
+        copy = strdup(s);
+        (*env)->ReleaseStringUTFChars(env, value, s);
+        if (!copy) return JNI_FALSE;
+    }
+    free(dp->initial_prompt);
+    dp->initial_prompt = copy;
+    dp->base.initial_prompt = copy;
+    return JNI_TRUE;
+}
+
+/** Frees a parameter block. NULL-safe. */
+JNIEXPORT void JNICALL
+Java_com_whispercpp_whisper_WhisperLib_paramsFree(JNIEnv *env, jclass clazz, jlong ptr) {
+    (void)env; (void)clazz;
+    struct jni_decode_params *dp = jni_params(ptr);
+    if (!dp) return;
+    free(dp->initial_prompt);
+    free(dp);
+}
+
+/** Reduced encoder context: rounding step, safety margin and floor (frames; 50 per second). */
+#define AUDIO_CTX_GRANULARITY 64
+#define AUDIO_CTX_MARGIN      64   // ≈ 1.3 s beyond the last sample
+#define AUDIO_CTX_MIN         256  // ≈ 5 s; shorter windows degrade too easily
+/** Only reduce when it saves at least this share of the full window. */
+#define AUDIO_CTX_MAX_SHARE   0.9
+/** Degeneracy guard: text-token budget (base + per second) and minimum mean probability. */
+#define AUDIO_CTX_GUARD_TOKENS       8
+#define AUDIO_CTX_GUARD_TOKENS_PER_S 8.0
+#define AUDIO_CTX_GUARD_MIN_P        0.4
+
+/**
+ * Encoder context covering n samples: the clip's frame count plus a margin,
+ * rounded up to AUDIO_CTX_GRANULARITY and at least AUDIO_CTX_MIN.
+ * Encoder cost scales with the context, so a 4 s command encodes ~1/5 of
+ * the full 30 s window.
+ *
+ * @return audio_ctx to use, or 0 (full context) when the saving is small
+ *         or the clip does not fit a single window
+ */
+static int jni_pick_audio_ctx(int n_audio_ctx, int n) {
+    const int64_t window = (int64_t)WHISPER_SAMPLE_RATE * WHISPER_CHUNK_SIZE;
+    const int64_t frames = ((int64_t)n * n_audio_ctx + window - 1) / window;
+    int64_t ctx = frames + AUDIO_CTX_MARGIN;
+    ctx = (ctx + AUDIO_CTX_GRANULARITY - 1) / AUDIO_CTX_GRANULARITY * AUDIO_CTX_GRANULARITY;
+    if (ctx < AUDIO_CTX_MIN) ctx = AUDIO_CTX_MIN;
+    return ctx < (int64_t)(AUDIO_CTX_MAX_SHARE * n_audio_ctx) ? (int)ctx : 0;
+}
+
+/**
+ * Heuristic check of a reduced-context result for the usual failure modes:
+ * nothing decoded, a repetition loop (text-token rate far above speech
+ * rate), or uniformly low-confidence tokens.
+ */
+static bool jni_result_degenerate(const struct whisper_jni_context *jc, int n) {
+    const whisper_token eot = whisper_token_eot(jc->ctx);
+    const int n_seg = jni_n_segments(jc);
+    int n_text = 0;
+    double p_sum = 0.0;
+    for (int i = 0; i < n_seg; ++i) {
+        const int n_tok = jni_seg_n_tokens(jc, i);
+        for (int j = 0; j < n_tok; ++j) {
+            if (jni_token_id(jc, i, j) >= eot) continue;  // special / timestamp tokens
+            n_text++;
+            p_sum += jni_token_p(jc, i, j);
+        }
+    }
+    if (n_text == 0) return true;
+    const double secs = (double)n / WHISPER_SAMPLE_RATE;
+    if (n_text > AUDIO_CTX_GUARD_TOKENS + AUDIO_CTX_GUARD_TOKENS_PER_S * secs) return true;
+    return p_sum / n_text < AUDIO_CTX_GUARD_MIN_P;
+}
+
+/**
+ * Shared body of the fullTranscribe*() entry points.
+ *
+ * Starts from dp (or greedy defaults when NULL), applies the JNI arguments,
+ * installs the abort hooks and runs whisper_full() over pcm[0..n).
+ *
+ * With pcm == NULL the log-mel retained in the state (jc->mel_valid, n =
+ * jc->mel_n samples) is decoded again: whisper_full() computes the mel only
+ * when it is given samples, so the re-run skips the WAV decode and the
+ * mel and needs no PCM on the caller's side.
+ *
+ * @param dp decoding parameters from paramsCreate(), or NULL
+ * @return whisper_full() result (0 on success)
+ */
+static int run_full_transcribe(
+        JNIEnv *env, struct whisper_jni_context *jc, const struct jni_decode_params *dp,
+        jstring langStr, jint nthreads, jboolean translate, const float *pcm, int n) {
+    struct whisper_context *ctx = jc->ctx;
+
+    const char *lang = NULL;
+    if (langStr) lang = (*env)->GetStringUTFChars(env, langStr, NULL);
+
+    struct whisper_full_params p;
+    if (dp) {
+        p = dp->base;
+    } else {
+        p = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+        p.no_context = true;      // independent runs (no KV reuse)
+        p.single_segment = false;
+    }
+    p.n_threads = (nthreads > 0) ? nthreads : 1;
+    p.translate = (translate == JNI_TRUE);
+    if (p.audio_ctx > whisper_n_audio_ctx(ctx)) p.audio_ctx = 0;  // never exceed the model
+    p.print_realtime = false;
+    p.print_progress = false;
+    p.print_timestamps = false;
+    p.print_special = false;
+
+    // detect_language = true makes whisper_full() return right after the
+    // detection pass; "auto" detects and then transcribes.
+    p.language = (lang && lang[0]) ? lang : "auto";
+    p.detect_language = false;
+
+    jni_prepare_abort(&p, jc);
+    jni_apply_thread_policy(jc);
+    jni_result_reset(jc);
+    jni_prepare_listener(&p, jc);
+    jni_prepare_stats(&p, jc);
+    const bool reuse_mel = pcm == NULL;
+    if (!reuse_mel) jni_mel_forget(jc);
+
+    // Optional VAD pre-pass: whisper's model VAD remaps internally; the
+    // energy VAD compacts here and remaps in the segment getters.
+    float *compact = NULL;
+    int run_n = n;
+    if (reuse_mel) {
+        // A compacted mel still needs its region map for the timestamps.
+        if (jc->mel_n_vad_map > 0) {
+            jc->vad_map = jc->arena.map;
+            jc->n_vad_map = jc->mel_n_vad_map;
+        }
+    } else if (jc->vad_mode == JNI_VAD_MODEL && jc->vad_model_path) {
+        p.vad = true;
+        p.vad_model_path = jc->vad_model_path;
+        p.vad_params = jc->vad_model;
+    } else if (jc->vad_mode == JNI_VAD_ENERGY) {
+        ATrace_beginSection("whisper:vad");
+        const double t_vad = now_ms();
+        const int vrc = vad_compact(jc, pcm, n, &compact, &run_n);
+        jc->run.vad_ms = now_ms() - t_vad;
+        ATrace_endSection();
+        if (vrc == 1) {
+            LOGI("VAD: no speech in %d samples → skipping whisper_full()", n);
+            jc->result_empty = true;
+            jni_finish_stats(jc);
+            if (langStr && lang) (*env)->ReleaseStringUTFChars(env, langStr, lang);
+            return 0;
+        }
+        if (vrc < 0) LOGW("VAD failed (%d) → transcribing unmodified", vrc);
+    }
+
+    const int n_audio_ctx = whisper_n_audio_ctx(ctx);
+    const bool auto_ctx = dp && dp->auto_audio_ctx && p.audio_ctx == 0;
+    if (auto_ctx) p.audio_ctx = jni_pick_audio_ctx(n_audio_ctx, run_n);
+    // A reduced context means the clip fits one window, so its segments would
+    // all arrive at the end anyway: hold the listener back until we know
+    // which attempt is kept, so a fallback never repeats segments.
+    const struct whisper_full_params p_listen = p;
+    const bool hold_listener = auto_ctx && p.audio_ctx > 0 && jc->listener;
+    if (hold_listener) {
+        p.new_segment_callback = NULL;
+        p.progress_callback = NULL;
+    }
+    jc->audio_ctx_initial = p.audio_ctx > 0 ? p.audio_ctx : n_audio_ctx;
+
+    LOGI("Starting whisper_full(): samples=%d threads=%d translate=%d strategy=%d audio_ctx=%d state=%p",
+         run_n, p.n_threads, p.translate, (int)p.strategy, p.audio_ctx, (void *)jc->state);
+    if (!jc->state) whisper_reset_timings(ctx);  // timings live on the default state
+
+    const float *run_pcm = compact ? compact : pcm;
+    const int run_len = reuse_mel ? 0 : run_n;  // 0 samples: keep the state's mel
+    jc->run.n_samples = run_n;
+    int rc = jni_full_timed(jc, p, run_pcm, run_len);
+    if (rc == 0 && auto_ctx && p.audio_ctx > 0 && jni_result_degenerate(jc, run_n)) {
+        LOGW("audio_ctx=%d gave a degenerate result → retrying with the full context", p.audio_ctx);
+        p = p_listen;
+        p.audio_ctx = 0;
+        jc->run.n_retry++;
+        rc = jni_full_timed(jc, p, run_pcm, run_len);
+    } else if (rc == 0 && hold_listener) {
+        jni_on_new_segment(ctx, jc->state, jni_n_segments(jc), jc);  // reduced result kept
+        jni_on_progress(ctx, jc->state, 100, jc);
+    }
+    jc->audio_ctx_used = p.audio_ctx > 0 ? p.audio_ctx : n_audio_ctx;
+    jni_finish_stats(jc);
+    if (!reuse_mel && rc == 0 && !p.vad) {  // model VAD remaps inside whisper.cpp: not reusable
+        jc->mel_valid = true;
+        jc->mel_n = run_n;
+        jc->mel_n_vad_map = jc->n_vad_map;
+    }
+    if (rc != 0) {
+        if (jni_abort_callback(jc)) LOGI("whisper_full() aborted on request");
+        else LOGW("whisper_full() failed");
+    } else if (!jc->state) {
+        whisper_print_timings(ctx);
+    }
+
+    if (langStr && lang) (*env)->ReleaseStringUTFChars(env, langStr, lang);
+    return rc;
+}
+
+/**
+ * Performs full blocking transcription on provided PCM audio buffer.
+ *
+ * Note: GetFloatArrayElements() may copy the array; prefer
+ * fullTranscribeDirect() for long clips.
+ *
+ * @param env JNI environment
+ * @param clazz Java class
+ * @param ctxPtr native context handle
+ * @param langStr language code or "auto"
+ * @param nthreads number of CPU threads
+ * @param translate translation mode (true/false)
+ * @param audio float[] PCM data (-1.0f~1.0f)
+ */
+JNIEXPORT void JNICALL
+Java_com_whispercpp_whisper_WhisperLib_fullTranscribe(
+        JNIEnv *env, jclass clazz, jlong ctxPtr, jstring langStr,
+        jint nthreads, jboolean translate, jfloatArray audio) {
+    (void)clazz;
+    struct whisper_jni_context *jc = jni_context(ctxPtr);
+    if (!jc || !audio) { LOGW("fullTranscribe: context or audio NULL"); return; }
+
+    jfloat *pcm = (*env)->GetFloatArrayElements(env, audio, NULL);
+    if (!pcm) { LOGE("GetFloatArrayElements() failed"); return; }
+    jsize n = (*env)->GetArrayLength(env, audio);
+
+    run_full_transcribe(env, jc, NULL, langStr, nthreads, translate, pcm, (int)n);
+
+    (*env)->ReleaseFloatArrayElements(env, audio, pcm, JNI_ABORT);
+}
+
+/**
+ * Validates a direct-buffer range and runs run_full_transcribe() on it.
+ * `who` names the entry point in log messages.
+ */
+static void run_full_transcribe_direct(
+        JNIEnv *env, const char *who, jlong ctxPtr, const struct jni_decode_params *dp,
+        jstring langStr, jint nthreads, jboolean translate, jobject buffer, jint offset, jint nSamples) {
+    struct whisper_jni_context *jc = jni_context(ctxPtr);
+    if (!jc || !buffer) { LOGW("%s: context or buffer NULL", who); return; }
+
+    const float *base = (const float *)(*env)->GetDirectBufferAddress(env, buffer);
+    if (!base) { LOGE("GetDirectBufferAddress() failed (not a direct buffer?)"); return; }
+
+    // GetDirectBufferCapacity() is in elements of the buffer's own type.
+    const jlong cap = (*env)->GetDirectBufferCapacity(env, buffer);
+    if (offset < 0 || nSamples <= 0 || (jlong)offset + nSamples > cap) {
+        LOGW("%s: range [%d,+%d) out of capacity %lld", who, offset, nSamples, (long long)cap);
+        return;
+    }
+
+    run_full_transcribe(env, jc, dp, langStr, nthreads, translate, base + offset, (int)nSamples);
+}
+
+/**
+ * Zero-copy variant of fullTranscribe() reading PCM from a direct buffer.
+ *
+ * Expects a direct FloatBuffer in native order (a view of
+ * ByteBuffer.allocateDirect()); whisper reads the samples in place, so no
+ * Java-heap array is pinned or copied.
+ *
+ * @param env JNI environment
+ * @param clazz Java class
+ * @param ctxPtr native context handle
+ * @param langStr language code or "auto"
+ * @param nthreads number of CPU threads
+ * @param translate translation mode (true/false)
+ * @param buffer direct FloatBuffer holding PCM data (-1.0f~1.0f)
+ * @param offset first sample (in floats) to read
+ * @param nSamples number of samples to read
+ */
+JNIEXPORT void JNICALL
+Java_com_whispercpp_whisper_WhisperLib_fullTranscribeDirect(
+        JNIEnv *env, jclass clazz, jlong ctxPtr, jstring langStr,
+        jint nthreads, jboolean translate, jobject buffer, jint offset, jint nSamples) {
+    (void)clazz;
+    run_full_transcribe_direct(env, "fullTranscribeDirect", ctxPtr, NULL,
+                               langStr, nthreads, translate, buffer, offset, nSamples);
+}
+
+/**
+ * fullTranscribeDirect() with caller-supplied decoding parameters
+ * (strategy, beam size, temperature fallback, token limits, audio_ctx...).
+ *
+ * @param paramsPtr handle from paramsCreate() (0 = greedy defaults); not
+ *        consumed, may be reused across calls and contexts
+ */
+JNIEXPORT void JNICALL
+Java_com_whispercpp_whisper_WhisperLib_fullTranscribeWithParams(
+        JNIEnv *env, jclass clazz, jlong ctxPtr, jlong paramsPtr, jstring langStr,
+        jint nthreads, jboolean translate, jobject buffer, jint offset, jint nSamples) {
+    (void)clazz;
+    run_full_transcribe_direct(env, "fullTranscribeWithParams", ctxPtr, jni_params(paramsPtr),
+                               langStr, nthreads, translate, buffer, offset, nSamples);
+}
+
+/**
+ * Labels the log-mel of the handle's last run with key, so later calls
+ * can re-decode it with fullTranscribeRetained(). Energy-VAD runs qualify
+ * as well: their region map is kept with the mel, so re-decoded timestamps
+ * still refer to the original clip. Runs with whisper's model VAD do not.
+ * The label is dropped as soon as anything else runs on the handle's state.
+ *
+ * The mel stays inside the whisper_state: no copy, no extra memory. A key
+ * is per handle (and therefore per model); callers typically use the
+ * recording's path + size + mtime.
+ *
+ * @return JNI_TRUE if the mel was labelled
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_whispercpp_whisper_WhisperLib_melRetain(JNIEnv *env, jclass clazz, jlong ctxPtr, jstring key) {
+    (void)clazz;
+    struct whisper_jni_context *jc = jni_context(ctxPtr);
+    if (!jc || !key || !jc->mel_valid) return JNI_FALSE;
+    const char *k = (*env)->GetStringUTFChars(env, key, NULL);
+    if (!k) return JNI_FALSE;
+    char *copy = strdup(k);
+    (*env)->ReleaseStringUTFChars(env, key, k);
+    if (!copy) return JNI_FALSE;
+    free(jc->mel_key);
+    jc->mel_key = copy;
+    return JNI_TRUE;
+}
+
+/** True if the handle's state still holds the log-mel labelled key. */
+static bool jni_mel_matches(JNIEnv *env, const struct whisper_jni_context *jc, jstring key) {
+    if (!jc || !key || !jc->mel_valid || !jc->mel_key) return false;
+    const char *k = (*env)->GetStringUTFChars(env, key, NULL);
+    if (!k) return false;
+    const bool hit = strcmp(k, jc->mel_key) == 0;
+    (*env)->ReleaseStringUTFChars(env, key, k);
+    return hit;
+}
+
+/** @return JNI_TRUE if fullTranscribeRetained(key) would hit. */
+JNIEXPORT jboolean JNICALL
+Java_com_whispercpp_whisper_WhisperLib_melRetained(JNIEnv *env, jclass clazz, jlong ctxPtr, jstring key) {
+    (void)clazz;
+    return jni_mel_matches(env, jni_context(ctxPtr), key) ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Re-decodes the retained log-mel labelled key (see melRetain) with new
+ * language / task / decoding params; the mel computation is skipped and
+ * no PCM is needed. The label survives the run.
+ *
+ * @param paramsPtr decoding params from paramsCreate(), or 0 for defaults
+ * @return 0 on success, 1 if key is not retained (nothing ran), -1 on failure
+ */
+JNIEXPORT jint JNICALL
+Java_com_whispercpp_whisper_WhisperLib_fullTranscribeRetained(
+        JNIEnv *env, jclass clazz, jlong ctxPtr, jlong paramsPtr, jstring key,
+        jstring langStr, jint nthreads, jboolean translate) {
+    (void)clazz;
+    struct whisper_jni_context *jc = jni_context(ctxPtr);
+    if (!jni_mel_matches(env, jc, key)) return 1;
+    LOGI("Re-decoding retained mel '%s' (%d samples)", jc->mel_key, jc->mel_n);
+    const int rc = run_full_transcribe(env, jc, jni_params(paramsPtr), langStr, nthreads, translate, NULL, jc->mel_n);
+    return rc == 0 ? 0 : -1;
+}
+
+/**
+ * Encoder context of the last run on ptr.
+ *
+ * @return int[2] = { audio_ctx of the kept result, audio_ctx first tried };
+ *         they differ when a reduced context fell back to the full one
+ */
+JNIEXPORT jintArray JNICALL
+Java_com_whispercpp_whisper_WhisperLib_getLastAudioCtx(JNIEnv *env, jclass clazz, jlong ptr) {
+    (void)clazz;
+    struct whisper_jni_context *jc = jni_context(ptr);
+    if (!jc) return NULL;
+    const jint out[2] = { jc->audio_ctx_used, jc->audio_ctx_initial };
+    jintArray arr = (*env)->NewIntArray(env, 2);
+    if (!arr) return NULL;
+    (*env)->SetIntArrayRegion(env, arr, 0, 2, out);
+    return arr;
+}
+
+/** Doubles per getLastRunStats() record; layout mirrored in WhisperRunStats.kt. */
+#define RUN_STATS_FIELDS 21
+
+/**
+ * Structured telemetry of the handle's load and its last fullTranscribe*()
+ * run, for fleet-wide regression tracking without logcat scraping.
+ *
+ * Layout (-1 = not available):
+ *   [0] load_ms      [1] total_ms     [2] vad_ms       [3] mel_ms
+ *   [4] encode_ms    (all encoder passes: per-call average × passes)
+ *   [5] decode_ms    [6] batchd_ms    [7] prompt_ms    [8] sample_ms
+ *       (per-call averages from whisper_get_timings(); default state only)
+ *   [9] encoder passes   [10] sampling steps   [11] temperature fallbacks
+ *   [12] audio_ctx retries   [13] peak RSS delta (bytes)   [14] peak reset (0/1)
+ *   [15] compute buffer bytes   [16] KV cache bytes   [17] threads
+ *   [18] samples decoded   [19] audio_ctx used   [20] audio_ctx initial
+ *
+ * @return double[RUN_STATS_FIELDS], or NULL for an invalid handle
+ */
+JNIEXPORT jdoubleArray JNICALL
+Java_com_whispercpp_whisper_WhisperLib_getLastRunStats(JNIEnv *env, jclass clazz, jlong ctxPtr) {
+    (void)clazz;
+    struct whisper_jni_context *jc = jni_context(ctxPtr);
+    if (!jc) return NULL;
+    const struct jni_run_stats *r = &jc->run;
+    const int n_encode = atomic_load(&r->n_encode);
+    const int n_attempts = atomic_load(&r->n_attempts);  // first attempt per window + fallbacks
+    const jdouble out[RUN_STATS_FIELDS] = {
+        jc->load.ms, r->total_ms, r->vad_ms, r->mel_ms,
+        r->encode_ms >= 0.0f ? (double)r->encode_ms * n_encode : -1.0,
+        r->decode_ms, r->batchd_ms, r->prompt_ms, r->sample_ms,
+        n_encode, atomic_load(&r->n_sample), n_attempts > n_encode ? n_attempts - n_encode : 0,
+        r->n_retry, (double)r->peak_delta_kb * 1024.0, r->peak_reset ? 1.0 : 0.0,
+        (double)jc->load.compute_bytes, (double)jc->load.kv_bytes, r->n_threads,
+        r->n_samples, jc->audio_ctx_used, jc->audio_ctx_initial,
+    };
+    jdoubleArray arr = (*env)->NewDoubleArray(env, RUN_STATS_FIELDS);
+    if (!arr) return NULL;
+    (*env)->SetDoubleArrayRegion(env, arr, 0, RUN_STATS_FIELDS, out);
+    return arr;
+}
+
+/**
+ * Language of the last run on ptr: the requested code, or the detected one
+ * when the run used "auto". Lets a cheap draft run pick the language for a
+ * larger model, which then skips its own detection encoder pass.
+ *
+ * @return ISO code ("en", "ja", …), or NULL without a result
+ */
+JNIEXPORT jstring JNICALL
+Java_com_whispercpp_whisper_WhisperLib_getLastLanguage(JNIEnv *env, jclass clazz, jlong ptr) {
+    (void)clazz;
+    const int id = jni_lang_id(jni_context(ptr));
+    const char *code = id >= 0 ? whisper_lang_str(id) : NULL;
+    return code ? (*env)->NewStringUTF(env, code) : NULL;
+}
+
+/**
+ * ISO code of a whisper language id (as returned by detectLanguage()).
+ *
+ * @return "en", "ja", …, or NULL for an id outside [0, whisper_lang_max_id()]
+ */
+JNIEXPORT jstring JNICALL
+Java_com_whispercpp_whisper_WhisperLib_getLanguageCode(JNIEnv *env, jclass clazz, jint id) {
+    (void)clazz;
+    if (id < 0 || id > whisper_lang_max_id()) return NULL;
+    const char *code = whisper_lang_str(id);
+    return code ? (*env)->NewStringUTF(env, code) : NULL;
+}
+
+/**
+ * Spoken-language probabilities of pcm[offset, offset + nSamples), without
+ * transcribing it.
+ *
+ * Computes the log-mel of just these samples (the caller passes the first
+ * few seconds of a recording) and runs whisper_lang_auto_detect(): one
+ * encoder pass at offset 0 and one decoder step over the language tokens,
+ * instead of a detection pass inside every "auto" whisper_full().
+ *
+ * whisper.cpp sets the encoder context only inside whisper_full(), so the
+ * pass uses the state's current one: the full window, or the last run's
+ * reduced audio_ctx (see WhisperDecodeParams.autoAudioCtx).
+ *
+ * The handle's mel is replaced (a retained mel is forgotten); the last
+ * transcription result is left as it is.
+ *
+ * @param buffer direct FloatBuffer of 16 kHz mono PCM
+ * @param topK number of languages to return (clamped to [1, languages])
+ * @return float[2 * k]: (language id, probability) pairs by descending
+ *         probability, or NULL on failure
+ */
+JNIEXPORT jfloatArray JNICALL
+Java_com_whispercpp_whisper_WhisperLib_detectLanguage(
+        JNIEnv *env, jclass clazz, jlong ptr, jobject buffer, jint offset, jint nSamples,
+        jint nThreads, jint topK) {
+    (void)clazz;
+    struct whisper_jni_context *jc = jni_context(ptr);
+    if (!jc || !buffer || nThreads < 1) { LOGW("detectLanguage: invalid arguments"); return NULL; }
+    if (!whisper_is_multilingual(jc->ctx)) { LOGW("detectLanguage: model is English-only"); return NULL; }
+
+    const float *base = (const float *)(*env)->GetDirectBufferAddress(env, buffer);
+    if (!base) { LOGE("GetDirectBufferAddress() failed (not a direct buffer?)"); return NULL; }
+    const jlong cap = (*env)->GetDirectBufferCapacity(env, buffer);
+    if (offset < 0 || nSamples <= 0 || (jlong)offset + nSamples > cap) {
+        LOGW("detectLanguage: range [%d,+%d) out of capacity %lld", offset, nSamples, (long long)cap);
+        return NULL;
+    }
+
+    const int n_lang = whisper_lang_max_id() + 1;
+    float *probs = calloc((size_t)n_lang, sizeof(float));
+    if (!probs) { LOGE("detectLanguage: allocation failed"); return NULL; }
+
+    jni_apply_thread_policy(jc);
+    jni_mel_forget(jc);
+    ATrace_beginSection("whisper:lang");
+    const double t0 = now_ms();
+    int best;
+    if (jc->state) {
+        best = whisper_pcm_to_mel_with_state(jc->ctx, jc->state, base + offset, nSamples, nThreads) == 0
+             ? whisper_lang_auto_detect_with_state(jc->ctx, jc->state, 0, nThreads, probs) : -1;
+    } else {
+        best = whisper_pcm_to_mel(jc->ctx, base + offset, nSamples, nThreads) == 0
+             ? whisper_lang_auto_detect(jc->ctx, 0, nThreads, probs) : -1;
+        whisper_reset_timings(jc->ctx);
+    }
+    ATrace_endSection();
+    if (best < 0) {
+        LOGW("detectLanguage: failed (%d)", best);
+        free(probs);
+        return NULL;
+    }
+
+    // Partial selection sort: k is a handful out of ~100 languages.
+    const int k = topK < 1 ? 1 : (topK > n_lang ? n_lang : topK);
+    float *out = malloc(sizeof(float) * 2 * (size_t)k);
+    if (!out) { free(probs); return NULL; }
+    for (int i = 0; i < k; ++i) {
+        int arg = 0;
+        for (int j = 1; j < n_lang; ++j) if (probs[j] > probs[arg]) arg = j;
+        out[2 * i] = (float)arg;
+        out[2 * i + 1] = probs[arg];
+        probs[arg] = -1.0f;
+    }
+    LOGI("Language detected in %.0f ms: %s (p=%.2f, %d samples)",
+         now_ms() - t0, whisper_lang_str((int)out[0]), out[1], nSamples);
+    free(probs);
+
+    jfloatArray arr = (*env)->NewFloatArray(env, 2 * k);
+    if (arr) (*env)->SetFloatArrayRegion(env, arr, 0, 2 * k, out);
+    free(out);
+    return arr;
+}
+
+/**
+ * Sets the thread policy used for this context's whisper_full() runs and
+ * applies it to the calling thread immediately.
+ *
+ * @param cpus CPU indices to pin to; NULL or empty restores all online CPUs
+ * @param nice nice value for the compute thread (and its workers), or
+ *             Integer.MIN_VALUE to leave priority unchanged
+ * @return number of CPUs in the applied mask, or -1 on invalid handle
+ */
+JNIEXPORT jint JNICALL
+Java_com_whispercpp_whisper_WhisperLib_setThreadPolicy(
+        JNIEnv *env, jclass clazz, jlong ptr, jintArray cpus, jint nice) {
+    (void)clazz;
+    struct whisper_jni_context *jc = jni_context(ptr);
+    if (!jc) return -1;
+
+    const long n_cpu = sysconf(_SC_NPROCESSORS_CONF);
+    CPU_ZERO(&jc->affinity);
+    const jsize n = cpus ? (*env)->GetArrayLength(env, cpus) : 0;
+    if (n > 0) {
+        jint *ids = (*env)->GetIntArrayElements(env, cpus, NULL);
+        if (!ids) return -1;
+        for (jsize i = 0; i < n; ++i) {
+            if (ids[i] >= 0 && ids[i] < n_cpu && ids[i] < CPU_SETSIZE) CPU_SET(ids[i], &jc->affinity);
+        }
+        (*env)->ReleaseIntArrayElements(env, cpus, ids, JNI_ABORT);
+    }
+    if (CPU_COUNT(&jc->affinity) == 0) {
+        for (long i = 0; i < n_cpu && i < CPU_SETSIZE; ++i) CPU_SET(i, &jc->affinity);
+    }
+    jc->has_affinity = true;
+    jc->nice = nice;
+
+    jni_apply_thread_policy(jc);
+    const int count = CPU_COUNT(&jc->affinity);
+    LOGI("Thread policy: cpus=%d/%ld nice=%d", count, n_cpu, nice == INT32_MIN ? 0 : nice);
+    return count;
+}
+
+/**
+ * Configures the VAD pre-pass for subsequent fullTranscribe*() calls.
+ *
+ * Streaming sessions are unaffected (they window the audio themselves).
+ *
+ * @param mode JNI_VAD_OFF / JNI_VAD_ENERGY / JNI_VAD_MODEL
+ * @param modelPathStr whisper VAD model (ggml-silero-*.bin) for JNI_VAD_MODEL;
+ *                     without it the model mode falls back to energy VAD
+ * @param thresholdDb energy mode: speech margin above the noise floor
+ * @param speechProb model mode: speech probability threshold
+ * @param minSpeechMs drop detections shorter than this
+ * @param minSilenceMs bridge pauses shorter than this
+ * @param padMs context kept around each region
+ */
+JNIEXPORT void JNICALL
+Java_com_whispercpp_whisper_WhisperLib_setVad(
+        JNIEnv *env, jclass clazz, jlong ptr, jint mode, jstring modelPathStr,
+        jfloat thresholdDb, jfloat speechProb, jint minSpeechMs, jint minSilenceMs, jint padMs) {
+    (void)clazz;
+    struct whisper_jni_context *jc = jni_context(ptr);
+    if (!jc) return;
+
+    free(jc->vad_model_path);
+    jc->vad_model_path = NULL;
+    if (modelPathStr) {
+        const char *path = (*env)->GetStringUTFChars(env, modelPathStr, NULL);
+        if (path) {
+            jc->vad_model_path = strdup(path);
+            (*env)->ReleaseStringUTFChars(env, modelPathStr, path);
+        }
+    }
+
+    jc->vad_mode = (mode == JNI_VAD_MODEL && !jc->vad_model_path) ? JNI_VAD_ENERGY : mode;
+    jc->vad.threshold_db = thresholdDb;
+    jc->vad.min_speech_ms = minSpeechMs;
+    jc->vad.min_silence_ms = minSilenceMs;
+    jc->vad.pad_ms = padMs;
+
+    jc->vad_model.threshold = speechProb;
+    jc->vad_model.min_speech_duration_ms = minSpeechMs;
+    jc->vad_model.min_silence_duration_ms = minSilenceMs;
+    jc->vad_model.speech_pad_ms = padMs;
+
+    LOGI("VAD mode=%d model=%s thr=%.1f dB / p=%.2f speech≥%d ms silence≥%d ms pad=%d ms",
+         jc->vad_mode, jc->vad_model_path ? jc->vad_model_path : "-",
+         thresholdDb, speechProb, minSpeechMs, minSilenceMs, padMs);
+}
+
+/**
+ * Marks the Kotlin call about to run on the JNI thread (token ≠ 0), or the
+ * end of it (token = 0). Every whisper_full() in between can be stopped by
+ * requestAbort(ptr, token); runs outside such a call cannot be aborted.
+ *
+ * Called on the JNI thread only.
+ */
+JNIEXPORT void JNICALL
+Java_com_whispercpp_whisper_WhisperLib_setAbortToken(
+        JNIEnv *env, jclass clazz, jlong ptr, jint token) {
+    (void)env; (void)clazz;
+    struct whisper_jni_context *jc = jni_context(ptr);
+    if (jc) atomic_store(&jc->abort_token, (unsigned)token);
+}
+
+/**
+ * Requests cooperative cancellation of the call that armed `token` via
+ * setAbortToken(): its in-flight whisper_full() stops at the next graph
+ * node, and any later run inside the same call stops before encoding.
+ *
+ * Thread-safe: may be called from any thread. A request for a call that
+ * has already finished matches no later token and has no effect.
+ */
+JNIEXPORT void JNICALL
+Java_com_whispercpp_whisper_WhisperLib_requestAbort(
+        JNIEnv *env, jclass clazz, jlong ptr, jint token) {
+    (void)env; (void)clazz;
+    struct whisper_jni_context *jc = jni_context(ptr);
+    if (jc && token != 0) atomic_store(&jc->abort_target, (unsigned)token);
+}
+
+/**
+ * Returns number of decoded text segments.
+ */
+JNIEXPORT jint JNICALL
+Java_com_whispercpp_whisper_WhisperLib_getTextSegmentCount(
+        JNIEnv *env, jclass clazz, jlong ptr) {
+    (void)env; (void)clazz;
+    return jni_n_segments(jni_context(ptr));
+}
+
+/**
+ * Returns decoded text for segment index.
+ *
+ * Range-checked; returns "" when out of bounds.
+ */
+JNIEXPORT jstring JNICALL
+Java_com_whispercpp_whisper_WhisperLib_getTextSegment(
+        JNIEnv *env, jclass clazz, jlong ptr, jint i) {
+    (void)clazz;
+    if (!ptr) return (*env)->NewStringUTF(env, "");
+    int n = jni_n_segments(jni_context(ptr));
+    if (i < 0 || i >= n) {
+        LOGW("getTextSegment: index %d out of range [0,%d)", i, n);
+        return (*env)->NewStringUTF(env, "");
+    }
+    const char *s = jni_seg_text(jni_context(ptr), i);
+    return (*env)->NewStringUTF(env, s ? s : "");
+}
+
+/**
+ * Returns start timestamp (t0) of segment i.
+ * Note: units follow whisper API (typically 10ms ticks).
+ */
+JNIEXPORT jlong JNICALL
+Java_com_whispercpp_whisper_WhisperLib_getTextSegmentT0(
+        JNIEnv *env, jclass clazz, jlong ptr, jint i) {
+    (void)env; (void)clazz;
+    if (!ptr) return 0;
+    int n = jni_n_segments(jni_context(ptr));
+    if (i < 0 || i >= n) {
+        LOGW("getTextSegmentT0: index %d out of range [0,%d)", i, n);
+        return 0;
+    }
+    return jni_remap_ticks(jni_context(ptr), jni_seg_t0_raw(jni_context(ptr), i));
+}
+
+/**
+ * Returns end timestamp (t1) of segment i.
+ * Note: units follow whisper API (typically 10ms ticks).
+ */
+JNIEXPORT jlong JNICALL
+Java_com_whispercpp_whisper_WhisperLib_getTextSegmentT1(
+        JNIEnv *env, jclass clazz, jlong ptr, jint i) {
+    (void)env; (void)clazz;
+    if (!ptr) return 0;
+    int n = jni_n_segments(jni_context(ptr));
+    if (i < 0 || i >= n) {
+        LOGW("getTextSegmentT1: index %d out of range [0,%d)", i, n);
+        return 0;
+    }
+    return jni_remap_ticks(jni_context(ptr), jni_seg_t1_raw(jni_context(ptr), i));
+}
+
+/* ============================================================
+ * Packed result retrieval (single JNI crossing)
+ * ============================================================ */
+
+/** Bytes per segment record in the packed layout (see getAllSegments). */
+#define PACKED_SEGMENT_RECORD 32
+/** Bytes of the packed header: n_segments (i32) + flags (i32). */
+#define PACKED_HEADER 8
+/** Header flag: per-token probability table is present. */
+#define PACKED_FLAG_TOKEN_PROBS 1
+
+/** Little-endian store helpers (Android ABIs are all little-endian). */
+static inline uint8_t* put_i32(uint8_t *dst, int32_t v) { memcpy(dst, &v, 4); return dst + 4; }
+static inline uint8_t* put_i64(uint8_t *dst, int64_t v) { memcpy(dst, &v, 8); return dst + 8; }
+static inline uint8_t* put_f32(uint8_t *dst, float v)   { memcpy(dst, &v, 4); return dst + 4; }
+
+/** Bytes of the packed result of jc's last run (see getAllSegments). */
+static size_t jni_packed_size(struct whisper_jni_context *jc, bool with_p) {
+    const int n = jni_n_segments(jc);
+    size_t text_bytes = 0;
+    size_t n_tokens = 0;
+    for (int i = 0; i < n; ++i) {
+        const char *t = jni_seg_text(jc, i);
+        text_bytes += t ? strlen(t) : 0;
+        if (with_p) n_tokens += (size_t)jni_seg_n_tokens(jc, i);
+    }
+    return PACKED_HEADER + (size_t)n * PACKED_SEGMENT_RECORD + n_tokens * 4 + text_bytes;
+}
+
+/** Writes the packed result into base (jni_packed_size() bytes). */
+static void jni_pack_segments(struct whisper_jni_context *jc, bool with_p, uint8_t *base) {
+    const int n = jni_n_segments(jc);
+    size_t n_tokens = 0;
+    if (with_p) for (int i = 0; i < n; ++i) n_tokens += (size_t)jni_seg_n_tokens(jc, i);
+
+    uint8_t *rec  = put_i32(put_i32(base, n), with_p ? PACKED_FLAG_TOKEN_PROBS : 0);
+    uint8_t *prob = base + PACKED_HEADER + (size_t)n * PACKED_SEGMENT_RECORD;
+    uint8_t *text = prob + n_tokens * 4;
+    int32_t text_off = 0;
+    int32_t tok_off = 0;
+    for (int i = 0; i < n; ++i) {
+        const char *t = jni_seg_text(jc, i);
+        const int32_t len = t ? (int32_t)strlen(t) : 0;
+        const int32_t n_tok = with_p ? jni_seg_n_tokens(jc, i) : 0;
+
+        rec = put_i64(rec, jni_remap_ticks(jc, jni_seg_t0_raw(jc, i)));
+        rec = put_i64(rec, jni_remap_ticks(jc, jni_seg_t1_raw(jc, i)));
+        rec = put_i32(rec, text_off);
+        rec = put_i32(rec, len);
+        rec = put_i32(rec, tok_off);
+        rec = put_i32(rec, n_tok);
+
+        for (int j = 0; j < n_tok; ++j) prob = put_f32(prob, jni_token_p(jc, i, j));
+        if (len > 0) memcpy(text + text_off, t, (size_t)len);
+        text_off += len;
+        tok_off += n_tok;
+    }
+}
+
+/**
+ * Returns every decoded segment of the last run as one packed byte[].
+ *
+ * Layout (little-endian):
+ * - header: i32 n_segments, i32 flags (bit0 = token probabilities present)
+ * - n × record: i64 t0, i64 t1, i32 text_off, i32 text_len, i32 tok_off, i32 tok_count
+ * - if flags & 1: f32 × total_tokens (token p, indexed by tok_off/tok_count)
+ * - UTF-8 text blob (text_off is relative to the start of the blob)
+ *
+ * Replaces 1 + 3n JNI calls (and n jstring allocations) with one crossing.
+ *
+ * @param ptr native context handle
+ * @param withTokenProbs include per-token probabilities
+ * @return packed byte[] (header only when there are no segments), or NULL on failure
+ */
+JNIEXPORT jbyteArray JNICALL
+Java_com_whispercpp_whisper_WhisperLib_getAllSegments(
+        JNIEnv *env, jclass clazz, jlong ptr, jboolean withTokenProbs) {
+    (void)clazz;
+    struct whisper_jni_context *jc = jni_context(ptr);
+    const bool with_p = (withTokenProbs == JNI_TRUE);
+    const size_t total = jni_packed_size(jc, with_p);
+    if (total > (size_t)INT32_MAX) { LOGE("getAllSegments: result too large (%zu)", total); return NULL; }
+
+    jbyteArray out = (*env)->NewByteArray(env, (jsize)total);
+    if (!out) { LOGE("NewByteArray(%zu) failed", total); return NULL; }
+
+    uint8_t *base = (*env)->GetPrimitiveArrayCritical(env, out, NULL);
+    if (!base) { LOGE("GetPrimitiveArrayCritical() failed"); return NULL; }
+    jni_pack_segments(jc, with_p, base);
+    (*env)->ReleasePrimitiveArrayCritical(env, out, base, 0);
+    return out;
+}
+
+/**
+ * getAllSegments() into the context arena: same layout, no Java array.
+ *
+ * The result is exposed as a direct ByteBuffer over arena memory. When the
+ * arena did not have to grow and `current` views all of it, `current` is
+ * returned (no allocation at all); otherwise a new view is created and
+ * every earlier view is invalid. Read it on the JNI thread before the next
+ * run on this context.
+ *
+ * @param current the view returned by the previous call, or NULL
+ * @return direct ByteBuffer whose first bytes hold the packed result, or NULL on failure
+ */
+JNIEXPORT jobject JNICALL
+Java_com_whispercpp_whisper_WhisperLib_getAllSegmentsArena(
+        JNIEnv *env, jclass clazz, jlong ptr, jboolean withTokenProbs, jobject current) {
+    (void)clazz;
+    struct whisper_jni_context *jc = jni_context(ptr);
+    if (!jc) return NULL;
+    const bool with_p = (withTokenProbs == JNI_TRUE);
+    const size_t total = jni_packed_size(jc, with_p);
+    if (total > (size_t)INT32_MAX) { LOGE("getAllSegmentsArena: result too large (%zu)", total); return NULL; }
+
+    struct jni_arena *a = &jc->arena;
+    const size_t cap_before = a->out_cap;
+    if (!jni_arena_reserve((void **)&a->out, &a->out_cap, total, 1)) {
+        LOGE("getAllSegmentsArena: arena growth to %zu bytes failed", total);
+        return NULL;
+    }
+    jni_pack_segments(jc, with_p, a->out);
+    // Growth always raises out_cap; the address alone is not enough, as
+    // malloc() may hand back the freed block's address for the larger one.
+    if (current && a->out_cap == cap_before &&
+        (*env)->GetDirectBufferAddress(env, current) == a->out &&
+        (*env)->GetDirectBufferCapacity(env, current) == (jlong)a->out_cap) {
+        return current;
+    }
+    return (*env)->NewDirectByteBuffer(env, a->out, (jlong)a->out_cap);
+}
+
+/** Bytes per token record in the packed token layout (see getAllTokens). */
+#define PACKED_TOKEN_RECORD 44
+/** Token header flag: special tokens (timestamps, SOT, …) are included. */
+#define PACKED_FLAG_SPECIAL 1
+
+/** Maps a token time to the original timeline; -1 (not computed) stays -1. */
+static int64_t jni_remap_token_ticks(const struct whisper_jni_context *jc, int64_t t) {
+    return t < 0 ? t : jni_remap_ticks(jc, t);
+}
+
+/**
+ * Returns every token of the last run as one packed byte[]: the
+ * word-level timing of the same whisper_full() run, without re-decoding
+ * with max_len = 1.
+ *
+ * Layout (little-endian):
+ * - header: i32 n_tokens, i32 flags (bit0 = special tokens included)
+ * - n × record: i64 t0, i64 t1, i64 t_dtw, i32 segment, i32 id, f32 p,
+ *   i32 text_off, i32 text_len
+ * - UTF-8 text blob (text_off is relative to the start of the blob)
+ *
+ * t0 / t1 come from whisper's timestamp-token heuristic and are -1 unless
+ * the run had token timestamps on (WhisperDecodeParams.tokenTimestamps or
+ * maxLen); t_dtw is the DTW alignment of the token and -1 unless the model
+ * was loaded with alignment heads (setDtwPreset). All times are 10 ms ticks
+ * on the caller's timeline (VAD-remapped like the segment times).
+ *
+ * @param ptr native context handle
+ * @param includeSpecial keep timestamp / control tokens (id >= EOT)
+ * @return packed byte[] (header only without a result), or NULL on failure
+ */
+JNIEXPORT jbyteArray JNICALL
+Java_com_whispercpp_whisper_WhisperLib_getAllTokens(
+        JNIEnv *env, jclass clazz, jlong ptr, jboolean includeSpecial) {
+    (void)clazz;
+    struct whisper_jni_context *jc = jni_context(ptr);
+    if (!jc) return NULL;
+    const bool special = (includeSpecial == JNI_TRUE);
+    const whisper_token eot = whisper_token_eot(jc->ctx);
+    const int n_seg = jni_n_segments(jc);
+
+    size_t n_tok = 0;
+    size_t text_bytes = 0;
+    for (int i = 0; i < n_seg; ++i) {
+        const int n = jni_seg_n_tokens(jc, i);
+        for (int j = 0; j < n; ++j) {
+            if (!special && jni_token_id(jc, i, j) >= eot) continue;
+            const char *t = jni_token_text(jc, i, j);
+            text_bytes += t ? strlen(t) : 0;
+            n_tok++;
+        }
+    }
+    const size_t total = PACKED_HEADER + n_tok * PACKED_TOKEN_RECORD + text_bytes;
+    if (total > (size_t)INT32_MAX) { LOGE("getAllTokens: result too large (%zu)", total); return NULL; }
+
+    jbyteArray out = (*env)->NewByteArray(env, (jsize)total);
+    if (!out) { LOGE("NewByteArray(%zu) failed", total); return NULL; }
+    uint8_t *base = (*env)->GetPrimitiveArrayCritical(env, out, NULL);
+    if (!base) { LOGE("GetPrimitiveArrayCritical() failed"); return NULL; }
+
+    uint8_t *rec = put_i32(put_i32(base, (int32_t)n_tok), special ? PACKED_FLAG_SPECIAL : 0);
+    uint8_t *text = base + PACKED_HEADER + n_tok * PACKED_TOKEN_RECORD;
+    int32_t text_off = 0;
+    for (int i = 0; i < n_seg; ++i) {
+        const int n = jni_seg_n_tokens(jc, i);
+        for (int j = 0; j < n; ++j) {
+            const whisper_token_data d = jni_token_data(jc, i, j);
+            if (!special && d.id >= eot) continue;
+            const char *t = jni_token_text(jc, i, j);
+            const int32_t len = t ? (int32_t)strlen(t) : 0;
+
+            rec = put_i64(rec, jni_remap_token_ticks(jc, d.t0));
+            rec = put_i64(rec, jni_remap_token_ticks(jc, d.t1));
+            rec = put_i64(rec, jni_remap_token_ticks(jc, d.t_dtw));
+            rec = put_i32(rec, i);
+            rec = put_i32(rec, d.id);
+            rec = put_f32(rec, d.p);
+            rec = put_i32(rec, text_off);
+            rec = put_i32(rec, len);
+            if (len > 0) memcpy(text + text_off, t, (size_t)len);
+            text_off += len;
+        }
+    }
+    (*env)->ReleasePrimitiveArrayCritical(env, out, base, 0);
+    return out;
+}
+
+/* ============================================================
+ * Streaming session (sliding window over a PCM ring buffer)
+ * ============================================================ */
+
+/** Upper bound on carried-forward prompt tokens (half of n_text_ctx). */
+#define STREAM_MAX_PROMPT_TOKENS 224
+
+/** One committed (stable) segment in absolute 10 ms ticks. */
+struct stream_segment {
+    char    *text;
+    int64_t  t0;
+    int64_t  t1;
+};
+
+/**
+ * Live transcription session bound to one context handle.
+ *
+ * Audio is appended by streamPush() (any thread) into a ring buffer holding
+ * at most `len` samples. streamPoll() (whisper thread) decodes the window
+ * [max(committed, total - len), total) every `step` new samples, commits
+ * segments that end before the trailing `keep` region and carries the tokens
+ * of the last committed segment forward as the next prompt.
+ *
+ * Fields:
+ * - ring/cap: PCM ring buffer (cap == window length in samples)
+ * - total: absolute number of samples pushed so far
+ * - committed: absolute sample index where uncommitted audio begins
+ * - last_run: value of `total` at the previous decode
+ * - window: scratch buffer the current window is linearized into
+ * - prompt/n_prompt: tokens of the last committed segment
+ * - out/n_out: segments committed by the most recent poll
+ * - partial: text of the not-yet-stable tail from the most recent poll
+ */
+struct whisper_stream {
+    struct whisper_jni_context *owner;
+    struct whisper_context *ctx;
+    pthread_mutex_t lock;
+
+    float   *ring;
+    int64_t  cap;
+    int64_t  total;
+    int64_t  committed;
+    int64_t  last_run;
+    int64_t  step;
+    int64_t  keep;
+
+    float   *window;
+
+    whisper_token prompt[STREAM_MAX_PROMPT_TOKENS];
+    int      n_prompt;
+
+    struct stream_segment *out;
+    int      n_out;
+    int      out_cap;
+    char    *partial;
+
+    char     lang[16];
+    int      n_threads;
+    bool     translate;
+};
+
+/** Frees segments emitted by the previous poll. */
+static void stream_clear_output(struct whisper_stream *s) {
+    for (int i = 0; i < s->n_out; ++i) free(s->out[i].text);
+    s->n_out = 0;
+    free(s->partial);
+    s->partial = NULL;
+}
+
+/** Appends one committed segment to the poll output (copies text). */
+static bool stream_emit(struct whisper_stream *s, const char *text, int64_t t0, int64_t t1) {
+    if (s->n_out == s->out_cap) {
+        const int cap = s->out_cap ? s->out_cap * 2 : 8;
+        struct stream_segment *grown = realloc(s->out, (size_t)cap * sizeof(*grown));
+        if (!grown) { LOGE("stream_emit: realloc() failed"); return false; }
+        s->out = grown;
+        s->out_cap = cap;
+    }
+    s->out[s->n_out].text = strdup(text ? text : "");
+    s->out[s->n_out].t0 = t0;
+    s->out[s->n_out].t1 = t1;
+    s->n_out++;
+    return true;
+}
+
+/** Copies [from, from + n) (absolute sample indices) out of the ring. */
+static void stream_copy_window(const struct whisper_stream *s, int64_t from, int64_t n, float *dst) {
+    int64_t off = from % s->cap;
+    int64_t first = (off + n <= s->cap) ? n : (s->cap - off);
+    memcpy(dst, s->ring + off, (size_t)first * sizeof(float));
+    if (first < n) memcpy(dst + first, s->ring, (size_t)(n - first) * sizeof(float));
+}
+
+/** Stores the non-special tokens of segment i as the next prompt. */
+static void stream_capture_prompt(struct whisper_stream *s, int i) {
+    const whisper_token eot = whisper_token_eot(s->ctx);
+    const int n_tok = whisper_full_n_tokens(s->ctx, i);
+    s->n_prompt = 0;
+    for (int j = 0; j < n_tok && s->n_prompt < STREAM_MAX_PROMPT_TOKENS; ++j) {
+        const whisper_token id = whisper_full_get_token_id(s->ctx, i, j);
+        if (id < eot) s->prompt[s->n_prompt++] = id;
+    }
+}
+
+/**
+ * Creates a streaming session.
+ *
+ * @param ctxPtr native whisper_context pointer
+ * @param langStr language code or "auto"
+ * @param nthreads number of CPU threads for each decode
+ * @param translate translation mode
+ * @param stepMs decode every stepMs of new audio
+ * @param lengthMs maximum window length (≤ 30 s)
+ * @param keepMs trailing audio that is never committed (re-decoded next step)
+ * @return opaque session handle or 0
+ */
+JNIEXPORT jlong JNICALL
+Java_com_whispercpp_whisper_WhisperLib_streamCreate(
+        JNIEnv *env, jclass clazz, jlong ctxPtr, jstring langStr, jint nthreads,
+        jboolean translate, jint stepMs, jint lengthMs, jint keepMs) {
+    (void)clazz;
+    struct whisper_context *ctx = jni_whisper(ctxPtr);
+    if (!ctx) { LOGW("streamCreate: context NULL"); return 0; }
+    if (jni_context(ctxPtr)->state) { LOGW("streamCreate: handle has no default state"); return 0; }
+
+    const int len_ms = (lengthMs > 0 && lengthMs <= WHISPER_CHUNK_SIZE * 1000) ? lengthMs : 10000;
+    const int step_ms = (stepMs > 0 && stepMs <= len_ms) ? stepMs : 3000;
+    const int keep_ms = (keepMs >= 0 && keepMs < len_ms) ? keepMs : 200;
+
+    struct whisper_stream *s = calloc(1, sizeof(*s));
+    if (!s) { LOGE("calloc() failed"); return 0; }
+
+    s->owner = jni_context(ctxPtr);
+    s->ctx  = ctx;
+    s->cap  = (int64_t)len_ms * WHISPER_SAMPLE_RATE / 1000;
+    s->step = (int64_t)step_ms * WHISPER_SAMPLE_RATE / 1000;
+    s->keep = (int64_t)keep_ms * WHISPER_SAMPLE_RATE / 1000;
+    s->ring   = malloc((size_t)s->cap * sizeof(float));
+    s->window = malloc((size_t)s->cap * sizeof(float));
+    if (!s->ring || !s->window) {
+        LOGE("streamCreate: buffer allocation failed (%lld samples)", (long long)s->cap);
+        free(s->ring); free(s->window); free(s);
+        return 0;
+    }
+    pthread_mutex_init(&s->lock, NULL);
+
+    snprintf(s->lang, sizeof(s->lang), "%s", "auto");
+    if (langStr) {
+        const char *lang = (*env)->GetStringUTFChars(env, langStr, NULL);
+        if (lang) {
+            snprintf(s->lang, sizeof(s->lang), "%s", lang);
+            (*env)->ReleaseStringUTFChars(env, langStr, lang);
+        }
+    }
+    s->n_threads = (nthreads > 0) ? nthreads : 1;
+    s->translate = (translate == JNI_TRUE);
+
+    LOGI("streamCreate: step=%dms len=%dms keep=%dms lang=%s", step_ms, len_ms, keep_ms, s->lang);
+    return (jlong)s;
+}
+
+/**
+ * Appends 16 kHz mono PCM to the session ring buffer.
+ *
+ * Thread-safe with respect to streamPoll(); may be called from the recorder
+ * thread. Audio older than the window length that was never decoded is lost.
+ *
+ * @param handle session handle
+ * @param audio float[] PCM data (-1.0f~1.0f)
+ * @param offset first sample to copy
+ * @param length number of samples to copy
+ */
+JNIEXPORT void JNICALL
+Java_com_whispercpp_whisper_WhisperLib_streamPush(
+        JNIEnv *env, jclass clazz, jlong handle, jfloatArray audio, jint offset, jint length) {
+    (void)clazz;
+    struct whisper_stream *s = (struct whisper_stream*)handle;
+    if (!s || !audio || length <= 0) return;
+
+    const jsize n_arr = (*env)->GetArrayLength(env, audio);
+    if (offset < 0 || offset > n_arr - length) {
+        LOGW("streamPush: range [%d,+%d) out of bounds (%d)", offset, length, (int)n_arr);
+        return;
+    }
+
+    pthread_mutex_lock(&s->lock);
+    jint src = offset;
+    jint remaining = length;
+    if (remaining > s->cap) {  // only the newest window can ever be decoded
+        src += remaining - (jint)s->cap;
+        s->total += remaining - s->cap;
+        remaining = (jint)s->cap;
+    }
+    while (remaining > 0) {
+        const int64_t off = s->total % s->cap;
+        const jint run = (jint)((off + remaining <= s->cap) ? remaining : (s->cap - off));
+        (*env)->GetFloatArrayRegion(env, audio, src, run, s->ring + off);
+        s->total += run;
+        src += run;
+        remaining -= run;
+    }
+    pthread_mutex_unlock(&s->lock);
+}
+
+/**
+ * Decodes the current window when at least one step of new audio arrived.
+ *
+ * Newly stable segments are available through streamGetSegment*() until the
+ * next poll; the unstable tail is exposed through streamGetPartial().
+ *
+ * @param handle session handle
+ * @param flush if true, decode regardless of step and commit everything
+ * @return number of newly committed segments, or -1 on failure
+ */
+JNIEXPORT jint JNICALL
+Java_com_whispercpp_whisper_WhisperLib_streamPoll(
+        JNIEnv *env, jclass clazz, jlong handle, jboolean flush) {
+    (void)env; (void)clazz;
+    struct whisper_stream *s = (struct whisper_stream*)handle;
+    if (!s) return -1;
+
+    stream_clear_output(s);
+    const bool final_pass = (flush == JNI_TRUE);
+
+    pthread_mutex_lock(&s->lock);
+    const int64_t total = s->total;
+    if (total - s->last_run < s->step && !(final_pass && total > s->committed)) {
+        pthread_mutex_unlock(&s->lock);
+        return 0;
+    }
+    int64_t start = s->committed;
+    if (total - start > s->cap) {
+        LOGW("streamPoll: dropped %lld undecoded samples", (long long)(total - s->cap - start));
+        start = total - s->cap;
+        s->committed = start;
+    }
+    const int64_t n = total - start;
+    stream_copy_window(s, start, n, s->window);
+    pthread_mutex_unlock(&s->lock);
+    s->last_run = total;
+
+    // whisper_full() decodes nothing below 100 ms (10 mel frames); skip such windows.
+    if (n < WHISPER_SAMPLE_RATE / 10) return 0;
+
+    struct whisper_full_params p = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    p.n_threads = s->n_threads;
+    p.translate = s->translate;
+    p.no_context = true;          // context comes from prompt_tokens below
+    p.single_segment = false;
+    p.print_realtime = false;
+    p.print_progress = false;
+    p.print_timestamps = false;
+    p.print_special = false;
+    p.language = s->lang;
+    p.detect_language = false;
+    p.prompt_tokens = s->n_prompt > 0 ? s->prompt : NULL;
+    p.prompt_n_tokens = s->n_prompt;
+
+    jni_prepare_abort(&p, s->owner);
+    jni_apply_thread_policy(s->owner);
+    jni_result_reset(s->owner);
+    jni_mel_forget(s->owner);
+
+    if (whisper_full(s->ctx, p, s->window, (int)n) != 0) {
+        LOGW("streamPoll: whisper_full() failed or aborted");
+        return -1;
+    }
+
+    const int n_seg = whisper_full_n_segments(s->ctx);
+    const int64_t base = start / SAMPLES_PER_TICK;
+    const int64_t stable_end = total - s->keep;
+    const bool window_full = (n >= s->cap);
+
+    // Commit the stable prefix; a full window must make progress, so commit
+    // all but the last segment (or everything on a final pass).
+    int n_commit = 0;
+    for (int i = 0; i < n_seg; ++i) {
+        const int64_t seg_end = start + whisper_full_get_segment_t1(s->ctx, i) * SAMPLES_PER_TICK;
+        if (seg_end > stable_end) break;
+        n_commit = i + 1;
+    }
+    if (final_pass) n_commit = n_seg;
+    else if (window_full && n_commit == 0) n_commit = (n_seg > 1) ? n_seg - 1 : n_seg;
+
+    int64_t new_committed = s->committed;
+    for (int i = 0; i < n_commit; ++i) {
+        const int64_t t0 = whisper_full_get_segment_t0(s->ctx, i);
+        const int64_t t1 = whisper_full_get_segment_t1(s->ctx, i);
+        if (!stream_emit(s, whisper_full_get_segment_text(s->ctx, i), base + t0, base + t1)) break;
+        new_committed = start + t1 * SAMPLES_PER_TICK;
+    }
+    if (n_commit > 0) stream_capture_prompt(s, n_commit - 1);
+    if (final_pass || (window_full && n_commit == n_seg)) new_committed = total;
+
+    size_t partial_len = 0;
+    for (int i = n_commit; i < n_seg; ++i) {
+        const char *t = whisper_full_get_segment_text(s->ctx, i);
+        partial_len += t ? strlen(t) : 0;
+    }
+    s->partial = malloc(partial_len + 1);
+    if (s->partial) {
+        s->partial[0] = '\0';
+        for (int i = n_commit; i < n_seg; ++i) {
+            const char *t = whisper_full_get_segment_text(s->ctx, i);
+            if (t) strcat(s->partial, t);
+        }
+    }
+
+    pthread_mutex_lock(&s->lock);
+    if (new_committed > s->committed) s->committed = new_committed;
+    pthread_mutex_unlock(&s->lock);
+
+    return s->n_out;
+}
+
+/** Returns text of committed segment i from the most recent poll. */
+JNIEXPORT jstring JNICALL
+Java_com_whispercpp_whisper_WhisperLib_streamGetSegment(
+        JNIEnv *env, jclass clazz, jlong handle, jint i) {
+    (void)clazz;
+    struct whisper_stream *s = (struct whisper_stream*)handle;
+    if (!s || i < 0 || i >= s->n_out) return (*env)->NewStringUTF(env, "");
+    return (*env)->NewStringUTF(env, s->out[i].text ? s->out[i].text : "");
+}
+
+/** Returns absolute start (10 ms ticks) of committed segment i. */
+JNIEXPORT jlong JNICALL
+Java_com_whispercpp_whisper_WhisperLib_streamGetSegmentT0(
+        JNIEnv *env, jclass clazz, jlong handle, jint i) {
+    (void)env; (void)clazz;
+    struct whisper_stream *s = (struct whisper_stream*)handle;
+    return (s && i >= 0 && i < s->n_out) ? s->out[i].t0 : 0;
+}
+
+/** Returns absolute end (10 ms ticks) of committed segment i. */
+JNIEXPORT jlong JNICALL
+Java_com_whispercpp_whisper_WhisperLib_streamGetSegmentT1(
+        JNIEnv *env, jclass clazz, jlong handle, jint i) {
+    (void)env; (void)clazz;
+    struct whisper_stream *s = (struct whisper_stream*)handle;
+    return (s && i >= 0 && i < s->n_out) ? s->out[i].t1 : 0;
+}
+
+/** Returns the unstable (not yet committed) tail text from the most recent poll. */
+JNIEXPORT jstring JNICALL
+Java_com_whispercpp_whisper_WhisperLib_streamGetPartial(
+        JNIEnv *env, jclass clazz, jlong handle) {
     (void)clazz;
-    if (!pathStr) return 0;
+    struct whisper_stream *s = (struct whisper_stream*)handle;
+    return (*env)->NewStringUTF(env, (s && s->partial) ? s->partial : "");
+}
+
+/**
+ * Releases a streaming session. Does not free the underlying whisper_context.
+ * Safe to call with 0.
+ */
+JNIEXPORT void JNICALL
+Java_com_whispercpp_whisper_WhisperLib_streamClose(
+        JNIEnv *env, jclass clazz, jlong handle) {
+    (void)env; (void)clazz;
+    struct whisper_stream *s = (struct whisper_stream*)handle;
+    if (!s) return;
+    stream_clear_output(s);
+    free(s->out);
+    free(s->ring);
+    free(s->window);
+    pthread_mutex_destroy(&s->lock);
+    free(s);
+    LOGI("Stream session closed");
+}
+
+/* ============================================================
+ * Native audio decode (WAV → mono float at target rate)
+ * ============================================================ */
 
+/**
+ * Returns the number of samples decodeWave() will produce for path.
+ *
+ * Parses the RIFF header of the mapped file only; no samples are decoded.
+ *
+ * @param pathStr WAV file path
+ * @param targetRate output sample rate (e.g. 16000)
+ * @return sample count (≥ 0) or a negative audio_status
+ */
+JNIEXPORT jint JNICALL
+Java_com_whispercpp_whisper_WhisperLib_decodeWaveLength(
+        JNIEnv *env, jclass clazz, jstring pathStr, jint targetRate) {
+    (void)clazz;
+    if (!pathStr) return AUDIO_ERR_IO;
     const char *path = (*env)->GetStringUTFChars(env, pathStr, NULL);
-    if (!path) return 0;
-    struct whisper_context *ctx = whisper_init_from_asset(env, mgr, path);
+    if (!path) return AUDIO_ERR_IO;
+
+    size_t n = 0;
+    const int rc = audio_decode_wav_file(path, targetRate, NULL, 0, &n);
     (*env)->ReleaseStringUTFChars(env, pathStr, path);
-    return (jlong)ctx;
+    if (rc != AUDIO_OK) return rc;
+    return (n > (size_t)INT32_MAX) ? AUDIO_ERR_CAPACITY : (jint)n;
 }
 
 /**
- * Initializes whisper_context from a direct file path on local storage.
+ * Decodes a WAV file straight into a direct FloatBuffer.
  *
- * Fastest method (uses mmap internally via GGML).
+ * PCM16 / float32 of any channel count are downmixed to mono (NEON on arm)
+ * and resampled with the polyphase windowed-sinc filter in whisperAudio.c.
+ * Samples are written from index 0; the buffer's position/limit are untouched.
  *
- * @param env JNI environment
- * @param clazz class reference
- * @param pathStr Java string path
- * @return whisper_context pointer or 0
+ * @param pathStr WAV file path
+ * @param targetRate output sample rate (e.g. 16000)
+ * @param dst direct, native-order FloatBuffer with capacity ≥ decodeWaveLength()
+ * @return samples written (≥ 0) or a negative audio_status
  */
-JNIEXPORT jlong JNICALL
-Java_com_whispercpp_whisper_WhisperLib_initContext(
-        JNIEnv *env, jclass clazz, jstring pathStr) {
+JNIEXPORT jint JNICALL
+Java_com_whispercpp_whisper_WhisperLib_decodeWave(
+        JNIEnv *env, jclass clazz, jstring pathStr, jint targetRate, jobject dst) {
     (void)clazz;
-    if (!pathStr) { LOGW("pathStr is NULL"); return 0; }
+    if (!pathStr || !dst) return AUDIO_ERR_IO;
+
+    float *out = (float *)(*env)->GetDirectBufferAddress(env, dst);
+    const jlong cap = (*env)->GetDirectBufferCapacity(env, dst);
+    if (!out || cap < 0) { LOGE("decodeWave: destination is not a direct buffer"); return AUDIO_ERR_CAPACITY; }
 
     const char *path = (*env)->GetStringUTFChars(env, pathStr, NULL);
-    if (!path) { LOGE("GetStringUTFChars() failed"); return 0; }
+    if (!path) return AUDIO_ERR_IO;
 
-    struct whisper_context_params cparams = whisper_context_default_params();
-    struct whisper_context *ctx = whisper_init_from_file_with_params(path, cparams);
+    size_t n = 0;
+    const int rc = audio_decode_wav_file(path, targetRate, out, (size_t)cap, &n);
+    if (rc != AUDIO_OK) LOGW("decodeWave(%s) failed: %d", path, rc);
     (*env)->ReleaseStringUTFChars(env, pathStr, path);
-
-    if (!ctx) LOGE("whisper_init_from_file_with_params() failed");
-    else LOGI("✅ Whisper model loaded from file: %s", path);
-    return (jlong)ctx;
+    return (rc != AUDIO_OK) ? rc : (jint)n;
 }
 
 /**
- * Frees a whisper_context and releases all native resources.
- *
- * Safe to call multiple times (idempotent).
+ * Upper bound on the samples decodeMedia() writes for a compressed file
+ * (container duration + 1 s). Demuxes the header only.
  *
- * @param env JNI environment
- * @param clazz class ref
- * @param ptr native pointer to whisper_context
+ * @param fd readable descriptor; offset / length select the media bytes
+ * @param targetRate output sample rate (e.g. 16000)
+ * @return sample bound (≥ 0) or a negative audio_status
  */
-JNIEXPORT void JNICALL
-Java_com_whispercpp_whisper_WhisperLib_freeContext(
-        JNIEnv *env, jclass clazz, jlong ptr) {
+JNIEXPORT jint JNICALL
+Java_com_whispercpp_whisper_WhisperLib_decodeMediaLength(
+        JNIEnv *env, jclass clazz, jint fd, jlong offset, jlong length, jint targetRate) {
     (void)env; (void)clazz;
-    if (ptr) {
-        whisper_free((struct whisper_context*)ptr);
-        LOGI("Whisper context freed successfully");
-    }
+    size_t n = 0;
+    const int rc = media_probe_fd(fd, offset, length, targetRate, &n);
+    if (rc != AUDIO_OK) return rc;
+    return (n > (size_t)INT32_MAX) ? AUDIO_ERR_CAPACITY : (jint)n;
 }
 
 /**
- * Performs full blocking transcription on provided PCM audio buffer.
+ * Decodes compressed audio (first audio track of any container the
+ * platform extractor supports) straight into a direct FloatBuffer.
  *
- * @param env JNI environment
- * @param clazz Java class
- * @param ctxPtr native whisper_context pointer
- * @param langStr language code or "auto"
- * @param nthreads number of CPU threads
- * @param translate translation mode (true/false)
- * @param audio float[] PCM data (-1.0f~1.0f)
+ * Decoder output is downmixed and resampled chunk by chunk (whisperMedia.c),
+ * so nothing larger than one codec buffer is held besides dst. Samples are
+ * written from index 0; the buffer's position/limit are untouched.
+ *
+ * @param dst direct, native-order FloatBuffer, capacity ≥ decodeMediaLength()
+ * @return samples written (≥ 0) or a negative audio_status
  */
-JNIEXPORT void JNICALL
-Java_com_whispercpp_whisper_WhisperLib_fullTranscribe(
-        JNIEnv *env, jclass clazz, jlong ctxPtr, jstring langStr,
-        jint nthreads, jboolean translate, jfloatArray audio) {
+JNIEXPORT jint JNICALL
+Java_com_whispercpp_whisper_WhisperLib_decodeMedia(
+        JNIEnv *env, jclass clazz, jint fd, jlong offset, jlong length, jint targetRate, jobject dst) {
     (void)clazz;
-    struct whisper_context *ctx = (struct whisper_context*)ctxPtr;
-    if (!ctx || !audio) { LOGW("fullTranscribe: context or audio NULL"); return; }
+    float *out = dst ? (float *)(*env)->GetDirectBufferAddress(env, dst) : NULL;
+    const jlong cap = out ? (*env)->GetDirectBufferCapacity(env, dst) : -1;
+    if (!out || cap < 0) { LOGE("decodeMedia: destination is not a direct buffer"); return AUDIO_ERR_CAPACITY; }
 
-    jfloat *pcm = (*env)->GetFloatArrayElements(env, audio, NULL);
-    if (!pcm) { LOGE("GetFloatArrayElements() failed"); return; }
-    jsize n = (*env)->GetArrayLength(env, audio);
+    ATrace_beginSection("whisper:decode");
+    size_t n = 0;
+    const int rc = media_decode_fd(fd, offset, length, targetRate, out, (size_t)cap, &n);
+    ATrace_endSection();
+    if (rc != AUDIO_OK) LOGW("decodeMedia(fd=%d) failed: %d", fd, rc);
+    return (rc != AUDIO_OK) ? rc : (jint)n;
+}
 
-    const char *lang = NULL;
-    if (langStr) lang = (*env)->GetStringUTFChars(env, langStr, NULL);
+/**
+ * Plans long-form chunks over a direct buffer range (see audio_plan_chunks):
+ * ~targetSamples each, cut in pauses where possible, overlapping by
+ * overlapSamples where a cut had to fall inside speech.
+ *
+ * @return int[2 * chunks] = { start0, end0, start1, end1, … } relative to
+ *         offset, or NULL on invalid arguments / failure
+ */
+JNIEXPORT jintArray JNICALL
+Java_com_whispercpp_whisper_WhisperLib_longformPlan(
+        JNIEnv *env, jclass clazz, jobject buffer, jint offset, jint nSamples,
+        jint targetSamples, jint overlapSamples) {
+    (void)clazz;
+    const float *base = buffer ? (const float *)(*env)->GetDirectBufferAddress(env, buffer) : NULL;
+    const jlong cap = base ? (*env)->GetDirectBufferCapacity(env, buffer) : -1;
+    if (!base || offset < 0 || nSamples <= 0 || (jlong)offset + nSamples > cap ||
+        targetSamples <= 0 || overlapSamples < 0) {
+        LOGW("longformPlan: invalid buffer or range");
+        return NULL;
+    }
 
-    struct whisper_full_params p = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
-    p.n_threads = (nthreads > 0) ? nthreads : 1;
-    p.translate = (translate == JNI_TRUE);
-    p.no_context = true;          // independent runs (no KV reuse)
-    p.single_segment = false;
-    p.print_realtime = false;
-    p.print_progress = false;
-    p.print_timestamps = false;
-    p.print_special = false;
+    struct audio_span *chunks = NULL;
+    const int n = audio_plan_chunks(base + offset, (size_t)nSamples, WHISPER_SAMPLE_RATE,
+                                    (size_t)targetSamples, (size_t)overlapSamples, &chunks);
+    if (n <= 0) { LOGW("longformPlan failed: %d", n); return NULL; }
 
-    if (lang && strcmp(lang, "auto") != 0) {
-        p.language = lang;
-        p.detect_language = false;
-    } else {
-        p.detect_language = true;
+    jint *flat = malloc((size_t)n * 2 * sizeof(jint));
+    jintArray out = flat ? (*env)->NewIntArray(env, n * 2) : NULL;
+    if (out) {
+        for (int i = 0; i < n; ++i) {
+            flat[2 * i] = (jint)chunks[i].start;
+            flat[2 * i + 1] = (jint)chunks[i].end;
+        }
+        (*env)->SetIntArrayRegion(env, out, 0, n * 2, flat);
     }
+    free(flat);
+    free(chunks);
+    return out;
+}
 
-    LOGI("Starting whisper_full(): samples=%d threads=%d translate=%d", (int)n, p.n_threads, p.translate);
-    whisper_reset_timings(ctx);
+/* ============================================================
+ * In-memory capture (zero-disk recording path)
+ * ============================================================ */
 
-    if (whisper_full(ctx, p, pcm, (int)n) != 0)
-        LOGW("whisper_full() failed");
-    else
-        whisper_print_timings(ctx);
+/** Initial capture capacity: 30 s at 16 kHz; grows geometrically. */
+#define CAPTURE_INITIAL_FRAMES (16000 * 30)
 
-    if (langStr && lang) (*env)->ReleaseStringUTFChars(env, langStr, lang);
-    (*env)->ReleaseFloatArrayElements(env, audio, pcm, JNI_ABORT);
+/**
+ * Growable mono PCM16 buffer fed directly from AudioRecord.
+ *
+ * Samples stay at the device rate; conversion to float and resampling to
+ * the model rate happen once, in captureRead(). The mutex allows the
+ * recorder thread to push while another thread queries the length.
+ *
+ * Fields:
+ * - pcm / cap / len: sample storage (frames)
+ * - sample_rate: device capture rate
+ */
+struct whisper_capture {
+    pthread_mutex_t mutex;
+    int16_t        *pcm;
+    size_t          cap;
+    size_t          len;
+    int             sample_rate;
+};
+
+static inline struct whisper_capture *jni_capture(jlong h) {
+    return (struct whisper_capture *)(intptr_t)h;
 }
 
 /**
- * Returns number of decoded text segments.
+ * Creates an empty capture buffer.
+ *
+ * @param sampleRate device capture rate (Hz)
+ * @return handle or 0 on invalid rate / OOM
  */
-JNIEXPORT jint JNICALL
-Java_com_whispercpp_whisper_WhisperLib_getTextSegmentCount(
-        JNIEnv *env, jclass clazz, jlong ptr) {
+JNIEXPORT jlong JNICALL
+Java_com_whispercpp_whisper_WhisperLib_captureCreate(JNIEnv *env, jclass clazz, jint sampleRate) {
     (void)env; (void)clazz;
-    return ptr ? whisper_full_n_segments((struct whisper_context*)ptr) : 0;
+    if (sampleRate <= 0) return 0;
+
+    struct whisper_capture *c = calloc(1, sizeof(*c));
+    if (!c) return 0;
+    c->pcm = malloc(CAPTURE_INITIAL_FRAMES * sizeof(int16_t));
+    if (!c->pcm) { free(c); return 0; }
+    c->cap = CAPTURE_INITIAL_FRAMES;
+    c->sample_rate = sampleRate;
+    pthread_mutex_init(&c->mutex, NULL);
+    return (jlong)(intptr_t)c;
 }
 
 /**
- * Returns decoded text for segment index.
+ * Appends PCM16 samples (one GetShortArrayRegion copy, no float conversion).
  *
- * Range-checked; returns "" when out of bounds.
+ * @return total captured frames, or -1 on bad arguments / OOM
  */
-JNIEXPORT jstring JNICALL
-Java_com_whispercpp_whisper_WhisperLib_getTextSegment(
-        JNIEnv *env, jclass clazz, jlong ptr, jint i) {
+JNIEXPORT jlong JNICALL
+Java_com_whispercpp_whisper_WhisperLib_capturePush(
+        JNIEnv *env, jclass clazz, jlong h, jshortArray samples, jint offset, jint length) {
     (void)clazz;
-    if (!ptr) return (*env)->NewStringUTF(env, "");
-    int n = whisper_full_n_segments((struct whisper_context*)ptr);
-    if (i < 0 || i >= n) {
-        LOGW("getTextSegment: index %d out of range [0,%d)", i, n);
-        return (*env)->NewStringUTF(env, "");
+    struct whisper_capture *c = jni_capture(h);
+    if (!c || !samples || offset < 0 || length < 0) return -1;
+    if ((jlong)offset + length > (*env)->GetArrayLength(env, samples)) return -1;
+
+    pthread_mutex_lock(&c->mutex);
+    if (c->len + (size_t)length > c->cap) {
+        size_t cap = c->cap * 2;
+        while (cap < c->len + (size_t)length) cap *= 2;
+        int16_t *grown = realloc(c->pcm, cap * sizeof(int16_t));
+        if (!grown) {
+            pthread_mutex_unlock(&c->mutex);
+            LOGE("capturePush: OOM growing to %zu frames", cap);
+            return -1;
+        }
+        c->pcm = grown;
+        c->cap = cap;
     }
-    const char *s = whisper_full_get_segment_text((struct whisper_context*)ptr, i);
-    return (*env)->NewStringUTF(env, s ? s : "");
+    (*env)->GetShortArrayRegion(env, samples, offset, length, (jshort *)(c->pcm + c->len));
+    c->len += (size_t)length;
+    const jlong total = (jlong)c->len;
+    pthread_mutex_unlock(&c->mutex);
+    return total;
 }
 
 /**
- * Returns start timestamp (t0) of segment i.
- * Note: units follow whisper API (typically 10ms ticks).
+ * Returns the number of float samples captureRead() will produce at targetRate.
  */
-JNIEXPORT jlong JNICALL
-Java_com_whispercpp_whisper_WhisperLib_getTextSegmentT0(
-        JNIEnv *env, jclass clazz, jlong ptr, jint i) {
+JNIEXPORT jint JNICALL
+Java_com_whispercpp_whisper_WhisperLib_captureLength(JNIEnv *env, jclass clazz, jlong h, jint targetRate) {
     (void)env; (void)clazz;
-    if (!ptr) return 0;
-    int n = whisper_full_n_segments((struct whisper_context*)ptr);
-    if (i < 0 || i >= n) {
-        LOGW("getTextSegmentT0: index %d out of range [0,%d)", i, n);
-        return 0;
-    }
-    return whisper_full_get_segment_t0((struct whisper_context*)ptr, i);
+    struct whisper_capture *c = jni_capture(h);
+    if (!c || targetRate <= 0) return AUDIO_ERR_MALFORMED;
+
+    pthread_mutex_lock(&c->mutex);
+    const size_t len = c->len;
+    pthread_mutex_unlock(&c->mutex);
+    if (len == 0) return 0;
+
+    const size_t n = audio_resampled_length(len, c->sample_rate, targetRate);
+    return (n > (size_t)INT32_MAX) ? AUDIO_ERR_CAPACITY : (jint)n;
 }
 
 /**
- * Returns end timestamp (t1) of segment i.
- * Note: units follow whisper API (typically 10ms ticks).
+ * Converts the captured PCM16 to float at targetRate into a direct FloatBuffer.
+ *
+ * @param dst direct, native-order FloatBuffer with capacity ≥ captureLength()
+ * @return samples written (≥ 0) or a negative audio_status
  */
-JNIEXPORT jlong JNICALL
-Java_com_whispercpp_whisper_WhisperLib_getTextSegmentT1(
-        JNIEnv *env, jclass clazz, jlong ptr, jint i) {
+JNIEXPORT jint JNICALL
+Java_com_whispercpp_whisper_WhisperLib_captureRead(
+        JNIEnv *env, jclass clazz, jlong h, jint targetRate, jobject dst) {
+    (void)clazz;
+    struct whisper_capture *c = jni_capture(h);
+    if (!c || !dst || targetRate <= 0) return AUDIO_ERR_MALFORMED;
+
+    float *out = (float *)(*env)->GetDirectBufferAddress(env, dst);
+    const jlong cap = (*env)->GetDirectBufferCapacity(env, dst);
+    if (!out || cap < 0) { LOGE("captureRead: destination is not a direct buffer"); return AUDIO_ERR_CAPACITY; }
+
+    pthread_mutex_lock(&c->mutex);
+    const size_t n = (c->len == 0) ? 0 : audio_resampled_length(c->len, c->sample_rate, targetRate);
+    int rc = AUDIO_OK;
+    if (n > (size_t)cap) rc = AUDIO_ERR_CAPACITY;
+    else if (n > 0) rc = audio_pcm16_to_rate(c->pcm, c->len, c->sample_rate, targetRate, out);
+    pthread_mutex_unlock(&c->mutex);
+
+    if (rc != AUDIO_OK) LOGW("captureRead failed: %d", rc);
+    return (rc != AUDIO_OK) ? rc : (jint)n;
+}
+
+/**
+ * Archives the captured PCM16 as a mono WAV at the device rate.
+ *
+ * @return AUDIO_OK or a negative audio_status
+ */
+JNIEXPORT jint JNICALL
+Java_com_whispercpp_whisper_WhisperLib_captureWriteWav(JNIEnv *env, jclass clazz, jlong h, jstring pathStr) {
+    (void)clazz;
+    struct whisper_capture *c = jni_capture(h);
+    if (!c || !pathStr) return AUDIO_ERR_IO;
+    const char *path = (*env)->GetStringUTFChars(env, pathStr, NULL);
+    if (!path) return AUDIO_ERR_IO;
+
+    pthread_mutex_lock(&c->mutex);
+    const int rc = audio_write_wav_pcm16(path, c->pcm, c->len, c->sample_rate);
+    pthread_mutex_unlock(&c->mutex);
+
+    (*env)->ReleaseStringUTFChars(env, pathStr, path);
+    return rc;
+}
+
+/**
+ * Frees a capture buffer. Kotlin guarantees no concurrent use after close.
+ */
+JNIEXPORT void JNICALL
+Java_com_whispercpp_whisper_WhisperLib_captureClose(JNIEnv *env, jclass clazz, jlong h) {
     (void)env; (void)clazz;
-    if (!ptr) return 0;
-    int n = whisper_full_n_segments((struct whisper_context*)ptr);
-    if (i < 0 || i >= n) {
-        LOGW("getTextSegmentT1: index %d out of range [0,%d)", i, n);
-        return 0;
-    }
-    return whisper_full_get_segment_t1((struct whisper_context*)ptr, i);
+    struct whisper_capture *c = jni_capture(h);
+    if (!c) return;
+    pthread_mutex_destroy(&c->mutex);
+    free(c->pcm);
+    free(c);
 }
 
 /**
@@ -448,6 +3765,114 @@ Java_com_whispercpp_whisper_WhisperLib_getSystemInfo(JNIEnv *env, jclass clazz)
     return (*env)->NewStringUTF(env, s ? s : "");
 }
 
+/* ============================================================
+ * Model benchmark (structured timings)
+ * ============================================================ */
+
+/** Floats per benchModel() row; layout mirrored in WhisperBench.kt. */
+#define BENCH_FIELDS 7
+/** Decoder workload per run, as in whisper.cpp's bench example. */
+#define BENCH_TEXT_TOKENS   256
+#define BENCH_BATCHD_STEPS  64
+#define BENCH_BATCHD_WIDTH  5
+#define BENCH_PROMPT_TOKENS 256
+
+/**
+ * Runs one full benchmark pass at n_threads and accumulates into row.
+ *
+ * Workload: log-mel of 30 s silence, one encoder pass, 256 single-token
+ * decodes, 64 five-token batched decodes and one 256-token prompt decode.
+ *
+ * @return true on success
+ */
+static bool bench_pass(struct whisper_context *ctx, const float *silence, int n_threads, float *row) {
+    whisper_token tokens[BENCH_PROMPT_TOKENS];
+    memset(tokens, 0, sizeof(tokens));
+
+    whisper_reset_timings(ctx);
+
+    const double t0 = now_ms();
+    if (whisper_pcm_to_mel(ctx, silence, WHISPER_SAMPLE_RATE * 30, n_threads) != 0) return false;
+    const double mel_ms = now_ms() - t0;
+
+    if (whisper_encode(ctx, 0, n_threads) != 0) return false;
+    for (int i = 0; i < BENCH_TEXT_TOKENS; ++i) {
+        if (whisper_decode(ctx, tokens, 1, i, n_threads) != 0) return false;
+    }
+    for (int i = 0; i < BENCH_BATCHD_STEPS; ++i) {
+        if (whisper_decode(ctx, tokens, BENCH_BATCHD_WIDTH, 0, n_threads) != 0) return false;
+    }
+    if (whisper_decode(ctx, tokens, BENCH_PROMPT_TOKENS, 0, n_threads) != 0) return false;
+
+    struct whisper_timings *t = whisper_get_timings(ctx);
+    if (!t) return false;
+    row[1] += (float)mel_ms;
+    row[2] += t->encode_ms;
+    row[3] += t->decode_ms;
+    row[4] += t->batchd_ms;
+    row[5] += t->prompt_ms;
+    whisper_timings_free(t);
+    return true;
+}
+
+/**
+ * Benchmarks the loaded model at thread counts 1, 2, 4, … and nThreads.
+ *
+ * Each row is averaged over nRuns passes after one untimed warm-up pass:
+ *   [threads, mel_ms, encode_ms, decode_ms, batchd_ms, prompt_ms, tokens_per_s]
+ * decode/batchd/prompt are per-call averages from whisper_get_timings();
+ * tokens_per_s is the single-token decode rate.
+ *
+ * @param ctxPtr context handle
+ * @param nThreads largest thread count to measure (≥ 1)
+ * @param nRuns timed passes per thread count (≥ 1)
+ * @return float[rows * 7], or NULL on invalid args / failure
+ */
+JNIEXPORT jfloatArray JNICALL
+Java_com_whispercpp_whisper_WhisperLib_benchModel(
+        JNIEnv *env, jclass clazz, jlong ctxPtr, jint nThreads, jint nRuns) {
+    (void)clazz;
+    struct whisper_context *ctx = jni_whisper(ctxPtr);
+    if (!ctx || nThreads < 1 || nRuns < 1) return NULL;
+    if (jni_context(ctxPtr)->state) { LOGW("benchModel: handle has no default state"); return NULL; }
+
+    int counts[32];
+    int n_counts = 0;
+    for (int t = 1; t < nThreads && n_counts < 31; t *= 2) counts[n_counts++] = t;
+    counts[n_counts++] = nThreads;
+
+    jni_mel_forget(jni_context(ctxPtr));
+    float *silence = calloc((size_t)WHISPER_SAMPLE_RATE * 30, sizeof(float));
+    float *rows = calloc((size_t)n_counts * BENCH_FIELDS, sizeof(float));
+    if (!silence || !rows) { free(silence); free(rows); return NULL; }
+
+    bool ok = true;
+    for (int c = 0; c < n_counts && ok; ++c) {
+        float *row = rows + (size_t)c * BENCH_FIELDS;
+        float warm[BENCH_FIELDS] = {0};
+        ok = bench_pass(ctx, silence, counts[c], warm);
+        for (int r = 0; r < nRuns && ok; ++r) ok = bench_pass(ctx, silence, counts[c], row);
+        if (!ok) break;
+
+        row[0] = (float)counts[c];
+        for (int f = 1; f < 6; ++f) row[f] /= (float)nRuns;
+        row[6] = row[3] > 0.0f ? 1000.0f / row[3] : 0.0f;
+        LOGI("bench t=%d mel=%.1f enc=%.1f dec=%.2f batchd=%.2f prompt=%.1f ms (%.1f tok/s)",
+             counts[c], row[1], row[2], row[3], row[4], row[5], row[6]);
+    }
+    free(silence);
+
+    jfloatArray out = NULL;
+    if (ok) {
+        out = (*env)->NewFloatArray(env, n_counts * BENCH_FIELDS);
+        if (out) (*env)->SetFloatArrayRegion(env, out, 0, n_counts * BENCH_FIELDS, rows);
+    } else {
+        LOGE("benchModel failed");
+    }
+    free(rows);
+    return out;
+}
+
 /**
  * Optional benchmark: memcpy performance (requires WHISPER_BENCH build).
  */
@@ -476,11 +3901,110 @@ Java_com_whispercpp_whisper_WhisperLib_benchGgmlMulMat(JNIEnv *env, jclass clazz
 #endif
 }
 
+/* ============================================================
+ * Model quantization (whisperQuantize.cpp)
+ * ============================================================ */
+
+/**
+ * Re-quantizes a ggml model file, e.g. a downloaded f16 master into the
+ * type that runs best on this CPU. Blocking and I/O heavy (seconds to
+ * minutes); call from a background thread. Does not touch any context.
+ *
+ * @param srcStr input model path
+ * @param dstStr output model path (written via a .tmp file + rename)
+ * @param ftype target `enum ggml_ftype`
+ * @param keepEncoder keep encoder tensors at source precision (mixed precision)
+ * @return QUANTIZE_OK or a negative quantize_status
+ */
+JNIEXPORT jint JNICALL
+Java_com_whispercpp_whisper_WhisperLib_quantizeModel(
+        JNIEnv *env, jclass clazz, jstring srcStr, jstring dstStr, jint ftype, jboolean keepEncoder) {
+    (void)clazz;
+#ifdef WHISPER_QUANTIZE
+    if (!srcStr || !dstStr) return QUANTIZE_ERR_IO;
+    const char *src = (*env)->GetStringUTFChars(env, srcStr, NULL);
+    const char *dst = src ? (*env)->GetStringUTFChars(env, dstStr, NULL) : NULL;
+    int rc = QUANTIZE_ERR_IO;
+    if (src && dst) {
+        LOGI("Quantizing %s → %s (ftype=%d keepEncoder=%d)", src, dst, ftype, keepEncoder == JNI_TRUE);
+        rc = whisper_quantize_model(src, dst, ftype, keepEncoder == JNI_TRUE ? QUANTIZE_KEEP_ENCODER : 0);
+        if (rc != QUANTIZE_OK) LOGW("quantizeModel failed: %d", rc);
+    }
+    if (dst) (*env)->ReleaseStringUTFChars(env, dstStr, dst);
+    if (src) (*env)->ReleaseStringUTFChars(env, srcStr, src);
+    return rc;
+#else
+    (void)env; (void)srcStr; (void)dstStr; (void)ftype; (void)keepEncoder;
+    LOGW("quantizeModel: built without WHISPER_QUANTIZE");
+    return QUANTIZE_ERR_DISABLED;
+#endif
+}
+
+/* ============================================================
+ * Warm-up
+ * ============================================================ */
+
+/** Silence fed to the warm-up pass (the encoder pads it to 30 s anyway). */
+#define WARMUP_SAMPLES (WHISPER_SAMPLE_RATE / 2)
+/** Tokens in the warm-up prompt decode. */
+#define WARMUP_TOKENS  4
+
+/**
+ * Runs the model once on silence so the first real transcription does not
+ * pay first-touch costs: page faults in the compute / KV buffers, lazily
+ * built graph allocations and the CPU frequency ramp.
+ *
+ * Workload: log-mel of 0.5 s silence, one encoder pass, a WARMUP_TOKENS
+ * prompt decode and one single-token decode, on the handle's own state and
+ * thread policy. The last transcription result is untouched; context
+ * timings are reset afterwards so they only describe real work.
+ *
+ * @param ptr context handle (pool and cache states included)
+ * @param nThreads compute threads (use the same count as transcriptions)
+ * @return elapsed milliseconds, or -1 on failure
+ */
+JNIEXPORT jint JNICALL
+Java_com_whispercpp_whisper_WhisperLib_warmUp(JNIEnv *env, jclass clazz, jlong ptr, jint nThreads) {
+    (void)env; (void)clazz;
+    struct whisper_jni_context *jc = jni_context(ptr);
+    if (!jc || nThreads < 1) return -1;
+
+    float *silence = calloc(WARMUP_SAMPLES, sizeof(float));
+    if (!silence) { LOGE("warmUp: allocation failed"); return -1; }
+
+    whisper_token tokens[WARMUP_TOKENS];
+    for (int i = 0; i < WARMUP_TOKENS; ++i) tokens[i] = whisper_token_sot(jc->ctx);
+
+    jni_apply_thread_policy(jc);
+    jni_mel_forget(jc);
+    const double t0 = now_ms();
+    bool ok;
+    if (jc->state) {
+        ok = whisper_pcm_to_mel_with_state(jc->ctx, jc->state, silence, WARMUP_SAMPLES, nThreads) == 0
+          && whisper_encode_with_state(jc->ctx, jc->state, 0, nThreads) == 0
+          && whisper_decode_with_state(jc->ctx, jc->state, tokens, WARMUP_TOKENS, 0, nThreads) == 0
+          && whisper_decode_with_state(jc->ctx, jc->state, tokens, 1, WARMUP_TOKENS, nThreads) == 0;
+    } else {
+        ok = whisper_pcm_to_mel(jc->ctx, silence, WARMUP_SAMPLES, nThreads) == 0
+          && whisper_encode(jc->ctx, 0, nThreads) == 0
+          && whisper_decode(jc->ctx, tokens, WARMUP_TOKENS, 0, nThreads) == 0
+          && whisper_decode(jc->ctx, tokens, 1, WARMUP_TOKENS, nThreads) == 0;
+        whisper_reset_timings(jc->ctx);
+    }
+    const int ms = (int)(now_ms() - t0);
+    free(silence);
+
+    if (!ok) { LOGW("warmUp: encode/decode failed"); return -1; }
+    LOGI("Warm-up done in %d ms (threads=%d state=%p)", ms, nThreads, (void *)jc->state);
+    return ms;
+}
+
 /**
  * Called when the native library (libwhisper.so) is loaded.
  *
  * Performs minimal initialization and returns the JNI version supported.
  * This ensures that the runtime matches the compiled JNI headers.
+ * Also routes whisper.cpp's log to logcat (see jni_whisper_log).
  *
  * @param vm Pointer to the JavaVM instance
  * @param reserved Reserved by JNI spec (unused)
@@ -488,6 +4012,7 @@ Java_com_whispercpp_whisper_WhisperLib_benchGgmlMulMat(JNIEnv *env, jclass clazz
  */
 JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
     (void)vm; (void)reserved;
+    whisper_log_set(jni_whisper_log, NULL);
     LOGI("JNI_OnLoad(): Whisper JNI initialized (JNI v1.6)");
     return JNI_VERSION_1_6;
 }
@@ -0,0 +1,258 @@
+// file: whisperMedia.c
+// ============================================================
+// ✅ whisperMedia — Compressed audio decode via NDK AMediaCodec
+// ------------------------------------------------------------
+// • Synchronous AMediaCodec loop (input / output dequeue, 10 ms timeouts)
+// • Output format read lazily: rate / channels / PCM encoding as decoded
+//   (HE-AAC reports the SBR rate only after the first frames)
+// • Downmix with the whisperAudio NEON helpers, then audio_stream_resampler
+// ============================================================
+
+#include "whisperMedia.h"
+#include "whisperAudio.h"
+
+#include <android/log.h>
+#include <media/NdkMediaCodec.h>
+#include <media/NdkMediaExtractor.h>
+#include <media/NdkMediaFormat.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TAG "JNI-WhisperMedia"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN,  TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+/** Dequeue timeout: short, since input and output are serviced on one thread. */
+#define MEDIA_DEQUEUE_TIMEOUT_US 10000
+/** Consecutive empty polls after input EOS before the decoder is given up on (~5 s). */
+#define MEDIA_MAX_IDLE_POLLS 500
+/** "pcm-encoding" values (android.media.AudioFormat); key is API 28 in the NDK headers. */
+#define MEDIA_KEY_PCM_ENCODING "pcm-encoding"
+#define MEDIA_PCM_16BIT 2
+#define MEDIA_PCM_FLOAT 4
+
+/** Demuxer positioned on the first audio track. */
+struct media_source {
+    AMediaExtractor *ex;
+    AMediaFormat    *format;  // track format (owned)
+    const char      *mime;    // points into format
+    int64_t          duration_us;
+};
+
+static void media_source_close(struct media_source *src) {
+    if (src->format) AMediaFormat_delete(src->format);
+    if (src->ex) AMediaExtractor_delete(src->ex);
+    memset(src, 0, sizeof(*src));
+}
+
+static int media_source_open(int fd, int64_t offset, int64_t length, struct media_source *src) {
+    memset(src, 0, sizeof(*src));
+    if (fd < 0 || offset < 0 || length <= 0) return AUDIO_ERR_IO;
+
+    src->ex = AMediaExtractor_new();
+    if (!src->ex) return AUDIO_ERR_NOMEM;
+    if (AMediaExtractor_setDataSourceFd(src->ex, fd, offset, length) != AMEDIA_OK) {
+        LOGW("Extractor rejected the source (unknown container)");
+        media_source_close(src);
+        return AUDIO_ERR_MALFORMED;
+    }
+
+    const size_t n = AMediaExtractor_getTrackCount(src->ex);
+    for (size_t i = 0; i < n; ++i) {
+        AMediaFormat *f = AMediaExtractor_getTrackFormat(src->ex, i);
+        const char *mime = NULL;
+        if (f && AMediaFormat_getString(f, AMEDIAFORMAT_KEY_MIME, &mime) && mime &&
+            strncmp(mime, "audio/", 6) == 0) {
+            AMediaExtractor_selectTrack(src->ex, i);
+            src->format = f;
+            src->mime = mime;
+            if (!AMediaFormat_getInt64(f, AMEDIAFORMAT_KEY_DURATION, &src->duration_us)) src->duration_us = -1;
+            return AUDIO_OK;
+        }
+        if (f) AMediaFormat_delete(f);
+    }
+    LOGW("No audio track among %zu tracks", n);
+    media_source_close(src);
+    return AUDIO_ERR_CODEC;
+}
+
+int media_probe_fd(int fd, int64_t offset, int64_t length, int dst_rate, size_t *out_bound) {
+    if (out_bound) *out_bound = 0;
+    if (dst_rate <= 0) return AUDIO_ERR_MALFORMED;
+
+    struct media_source src;
+    const int rc = media_source_open(fd, offset, length, &src);
+    if (rc != AUDIO_OK) return rc;
+    const int64_t us = src.duration_us;
+    LOGD("Probe: %s duration=%lld us", src.mime, (long long)us);
+    media_source_close(&src);
+    if (us <= 0) return AUDIO_ERR_CODEC;
+
+    if (out_bound) *out_bound = (size_t)((us * (int64_t)dst_rate + 999999) / 1000000) + (size_t)dst_rate;
+    return AUDIO_OK;
+}
+
+/**
+ * Decode state: current output layout of the codec, its resampler and the
+ * mono scratch for one output buffer.
+ */
+struct media_sink {
+    int      rate;
+    int      channels;
+    int      encoding;
+    struct audio_stream_resampler *rs;
+    int      dst_rate;
+    float   *mono;
+    size_t   mono_cap;
+    float   *out;
+    size_t   cap;
+    size_t   len;
+    bool     truncated;
+};
+
+/** Flushes the resampler tail for the current input rate into the output. */
+static int sink_flush(struct media_sink *k) {
+    if (!k->rs) return AUDIO_OK;
+    size_t w = 0;
+    const int rc = audio_stream_resampler_finish(k->rs, k->out + k->len, k->cap - k->len, &w);
+    k->len += w;
+    audio_stream_resampler_free(k->rs);
+    k->rs = NULL;
+    if (rc == AUDIO_ERR_CAPACITY) { k->truncated = true; return AUDIO_OK; }
+    return rc;
+}
+
+/** Reads the codec's output format; a new rate flushes and replaces the resampler. */
+static int sink_format(struct media_sink *k, AMediaFormat *f) {
+    int32_t rate = 0, channels = 0, encoding = MEDIA_PCM_16BIT;
+    AMediaFormat_getInt32(f, AMEDIAFORMAT_KEY_SAMPLE_RATE, &rate);
+    AMediaFormat_getInt32(f, AMEDIAFORMAT_KEY_CHANNEL_COUNT, &channels);
+    AMediaFormat_getInt32(f, MEDIA_KEY_PCM_ENCODING, &encoding);
+    if (rate <= 0 || channels <= 0) return AUDIO_ERR_CODEC;
+    if (encoding != MEDIA_PCM_16BIT && encoding != MEDIA_PCM_FLOAT) {
+        LOGE("Unsupported decoder PCM encoding %d", encoding);
+        return AUDIO_ERR_FORMAT;
+    }
+
+    if (k->rs && rate != k->rate) {
+        LOGW("Decoder rate changed %d → %d Hz mid-stream", k->rate, rate);
+        const int rc = sink_flush(k);
+        if (rc != AUDIO_OK) return rc;
+    }
+    if (!k->rs) {
+        k->rs = audio_stream_resampler_create(rate, k->dst_rate);
+        if (!k->rs) return AUDIO_ERR_NOMEM;
+    }
+    k->rate = rate;
+    k->channels = channels;
+    k->encoding = encoding;
+    return AUDIO_OK;
+}
+
+/** Downmixes one decoder output buffer and resamples it into the output. */
+static int sink_write(struct media_sink *k, const uint8_t *data, size_t bytes) {
+    const size_t frame = (size_t)k->channels * (k->encoding == MEDIA_PCM_FLOAT ? 4 : 2);
+    const size_t frames = bytes / frame;
+    if (frames == 0 || k->truncated) return AUDIO_OK;
+
+    if (frames > k->mono_cap) {
+        float *m = realloc(k->mono, frames * sizeof(float));
+        if (!m) return AUDIO_ERR_NOMEM;
+        k->mono = m;
+        k->mono_cap = frames;
+    }
+    if (k->encoding == MEDIA_PCM_FLOAT) audio_f32_to_mono(data, frames, k->channels, k->mono);
+    else audio_pcm16_to_mono(data, frames, k->channels, k->mono);
+
+    size_t w = 0;
+    const int rc = audio_stream_resampler_push(k->rs, k->mono, frames, k->out + k->len, k->cap - k->len, &w);
+    k->len += w;
+    if (rc == AUDIO_ERR_CAPACITY) { k->truncated = true; return AUDIO_OK; }
+    return rc;
+}
+
+/** Queues the next compressed sample (or EOS). Returns false once EOS is queued. */
+static bool feed_input(AMediaExtractor *ex, AMediaCodec *codec) {
+    const ssize_t idx = AMediaCodec_dequeueInputBuffer(codec, MEDIA_DEQUEUE_TIMEOUT_US);
+    if (idx < 0) return true;
+    size_t cap = 0;
+    uint8_t *buf = AMediaCodec_getInputBuffer(codec, (size_t)idx, &cap);
+    const ssize_t n = buf ? AMediaExtractor_readSampleData(ex, buf, cap) : -1;
+    if (n < 0) {
+        AMediaCodec_queueInputBuffer(codec, (size_t)idx, 0, 0, 0, AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM);
+        return false;
+    }
+    const int64_t t = AMediaExtractor_getSampleTime(ex);
+    AMediaCodec_queueInputBuffer(codec, (size_t)idx, 0, (size_t)n, t > 0 ? (uint64_t)t : 0, 0);
+    AMediaExtractor_advance(ex);
+    return true;
+}
+
+int media_decode_fd(int fd, int64_t offset, int64_t length, int dst_rate,
+                    float *out, size_t out_cap, size_t *out_len) {
+    if (out_len) *out_len = 0;
+    if (!out || dst_rate <= 0) return AUDIO_ERR_MALFORMED;
+
+    struct media_source src;
+    int rc = media_source_open(fd, offset, length, &src);
+    if (rc != AUDIO_OK) return rc;
+
+    AMediaCodec *codec = AMediaCodec_createDecoderByType(src.mime);
+    if (!codec) {
+        LOGW("No decoder for %s", src.mime);
+        media_source_close(&src);
+        return AUDIO_ERR_CODEC;
+    }
+    if (AMediaCodec_configure(codec, src.format, NULL, NULL, 0) != AMEDIA_OK ||
+        AMediaCodec_start(codec) != AMEDIA_OK) {
+        LOGE("Decoder for %s failed to start", src.mime);
+        AMediaCodec_delete(codec);
+        media_source_close(&src);
+        return AUDIO_ERR_CODEC;
+    }
+
+    struct media_sink k = { .dst_rate = dst_rate, .out = out, .cap = out_cap };
+    rc = sink_format(&k, src.format);  // provisional; refined by the output format
+    bool input = true;
+    int idle = 0;
+    while (rc == AUDIO_OK) {
+        if (input) input = feed_input(src.ex, codec);
+
+        AMediaCodecBufferInfo info;
+        const ssize_t idx = AMediaCodec_dequeueOutputBuffer(codec, &info, MEDIA_DEQUEUE_TIMEOUT_US);
+        if (idx == AMEDIACODEC_INFO_OUTPUT_FORMAT_CHANGED) {
+            AMediaFormat *f = AMediaCodec_getOutputFormat(codec);
+            if (f) { rc = sink_format(&k, f); AMediaFormat_delete(f); }
+            continue;
+        }
+        if (idx < 0) {
+            if (!input && ++idle > MEDIA_MAX_IDLE_POLLS) { LOGW("Decoder stalled after EOS"); break; }
+            continue;
+        }
+        idle = 0;
+
+        size_t size = 0;
+        const uint8_t *buf = AMediaCodec_getOutputBuffer(codec, (size_t)idx, &size);
+        if (buf && info.size > 0 && (size_t)info.offset + (size_t)info.size <= size) {
+            rc = sink_write(&k, buf + info.offset, (size_t)info.size);
+        }
+        AMediaCodec_releaseOutputBuffer(codec, (size_t)idx, false);
+        if (info.flags & AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM) break;
+    }
+    if (rc == AUDIO_OK) rc = sink_flush(&k);
+
+    AMediaCodec_stop(codec);
+    AMediaCodec_delete(codec);
+    audio_stream_resampler_free(k.rs);
+    free(k.mono);
+
+    if (rc == AUDIO_OK) {
+        if (k.truncated) LOGW("Decoded audio exceeded %zu samples; tail dropped", out_cap);
+        LOGD("Decoded %s: %dch %dHz → %zu samples @ %dHz", src.mime, k.channels, k.rate, k.len, dst_rate);
+        if (out_len) *out_len = k.len;
+    }
+    media_source_close(&src);
+    return rc;
+}
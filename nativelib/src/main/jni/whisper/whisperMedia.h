@@ -0,0 +1,53 @@
+// file: whisperMedia.h
+// ============================================================
+// ✅ whisperMedia — Compressed audio decode via NDK AMediaCodec
+// ------------------------------------------------------------
+// • Pure C (no JNI): used by whisperLib.c entry points
+// • AMediaExtractor demux: m4a/AAC, Opus (ogg / webm), MP3, FLAC, AMR, …
+// • Decoder output chunks → mono → streaming resampler → caller's buffer
+// • Bounded memory: one codec buffer + filter history, no full-rate copy
+// ============================================================
+
+#ifndef WHISPER_MEDIA_H
+#define WHISPER_MEDIA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Upper bound on the samples media_decode_fd() produces at dst_rate.
+ *
+ * Derived from the container duration of the first audio track plus one
+ * second for encoder priming / padding; no audio is decoded.
+ *
+ * @param fd readable file descriptor (not closed)
+ * @param offset / length byte range of the media inside fd (length > 0)
+ * @param out_bound receives the bound in samples
+ * @return AUDIO_OK or a negative audio_status (AUDIO_ERR_CODEC: no audio
+ *         track the platform can demux, or no duration)
+ */
+int media_probe_fd(int fd, int64_t offset, int64_t length, int dst_rate, size_t *out_bound);
+
+/**
+ * Decodes the first audio track of fd to mono float at dst_rate.
+ *
+ * Each decoder output buffer (PCM16 or float, any channel count) is
+ * downmixed and pushed through the streaming resampler straight into out,
+ * so peak memory is independent of the recording length. Output beyond
+ * out_cap is dropped with a warning.
+ *
+ * @param out_len receives the samples written
+ * @return AUDIO_OK or a negative audio_status
+ */
+int media_decode_fd(int fd, int64_t offset, int64_t length, int dst_rate,
+                    float *out, size_t out_cap, size_t *out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WHISPER_MEDIA_H
@@ -0,0 +1,183 @@
+// file: whisperQuantize.cpp
+// ============================================================
+// ✅ whisperQuantize — ggml model re-quantization
+// ------------------------------------------------------------
+// • Same file walk as whisper.cpp's examples/quantize/quantize.cpp
+//   (hparams → mel filters → vocab → tensors via ggml_common_quantize_0)
+// • No exceptions or exit(): every failure maps to a quantize_status
+// • Temp file + rename(): dst is either complete or untouched
+// • -DWHISPER_QUANTIZE_MAIN adds the whisper-quantize command line tool
+// • Progress to logcat in the library, to stderr in the tool
+// ============================================================
+
+#include "whisperQuantize.h"
+
+#include "ggml.h"
+#include "common-ggml.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef WHISPER_QUANTIZE_MAIN
+#define LOGI(fmt, ...) fprintf(stderr, fmt "\n", ##__VA_ARGS__)
+#else
+#include <android/log.h>
+#define TAG "JNI-WhisperQuantize"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, TAG, __VA_ARGS__)
+#endif
+
+namespace {
+
+/** hparams in file order (see whisper_model_load). */
+struct quantize_hparams {
+    int32_t n_vocab;
+    int32_t n_audio_ctx;
+    int32_t n_audio_state;
+    int32_t n_audio_head;
+    int32_t n_audio_layer;
+    int32_t n_text_ctx;
+    int32_t n_text_state;
+    int32_t n_text_head;
+    int32_t n_text_layer;
+    int32_t n_mels;
+    int32_t ftype;
+};
+
+/** Copies n bytes from finp to fout; false on a short read. */
+bool copy_bytes(std::ifstream &finp, std::ofstream &fout, void *buf, size_t n) {
+    finp.read(static_cast<char *>(buf), static_cast<std::streamsize>(n));
+    if (!finp) return false;
+    fout.write(static_cast<const char *>(buf), static_cast<std::streamsize>(n));
+    return static_cast<bool>(fout);
+}
+
+bool is_supported(ggml_ftype t) {
+    switch (t) {
+        case GGML_FTYPE_MOSTLY_Q4_0:
+        case GGML_FTYPE_MOSTLY_Q4_1:
+        case GGML_FTYPE_MOSTLY_Q5_0:
+        case GGML_FTYPE_MOSTLY_Q5_1:
+        case GGML_FTYPE_MOSTLY_Q8_0:
+        case GGML_FTYPE_MOSTLY_Q2_K:
+        case GGML_FTYPE_MOSTLY_Q3_K:
+        case GGML_FTYPE_MOSTLY_Q4_K:
+        case GGML_FTYPE_MOSTLY_Q5_K:
+        case GGML_FTYPE_MOSTLY_Q6_K:
+            return true;
+        default:
+            return false;
+    }
+}
+
+int quantize_stream(std::ifstream &finp, std::ofstream &fout, ggml_ftype ftype, int flags) {
+    // magic
+    uint32_t magic = 0;
+    if (!copy_bytes(finp, fout, &magic, sizeof(magic))) return QUANTIZE_ERR_FORMAT;
+    if (magic != GGML_FILE_MAGIC) return QUANTIZE_ERR_FORMAT;
+
+    // hparams: copied as-is except ftype, which records the new type + quant version
+    quantize_hparams hp{};
+    finp.read(reinterpret_cast<char *>(&hp), sizeof(hp));
+    if (!finp) return QUANTIZE_ERR_FORMAT;
+    const int32_t ftype_src = hp.ftype % GGML_QNT_VERSION_FACTOR;
+    hp.ftype = GGML_QNT_VERSION * GGML_QNT_VERSION_FACTOR + static_cast<int32_t>(ftype);
+    fout.write(reinterpret_cast<const char *>(&hp), sizeof(hp));
+    LOGI("%s: n_vocab=%d n_audio_layer=%d n_text_layer=%d ftype %d → %d",
+         __func__, hp.n_vocab, hp.n_audio_layer, hp.n_text_layer, ftype_src, static_cast<int>(ftype));
+
+    // mel filters
+    {
+        int32_t n_mel = 0, n_fft = 0;
+        if (!copy_bytes(finp, fout, &n_mel, sizeof(n_mel))) return QUANTIZE_ERR_FORMAT;
+        if (!copy_bytes(finp, fout, &n_fft, sizeof(n_fft))) return QUANTIZE_ERR_FORMAT;
+        if (n_mel <= 0 || n_fft <= 0) return QUANTIZE_ERR_FORMAT;
+        std::vector<float> data(static_cast<size_t>(n_mel) * static_cast<size_t>(n_fft));
+        if (!copy_bytes(finp, fout, data.data(), data.size() * sizeof(float))) return QUANTIZE_ERR_FORMAT;
+    }
+
+    // vocabulary
+    {
+        int32_t n_vocab = 0;
+        if (!copy_bytes(finp, fout, &n_vocab, sizeof(n_vocab))) return QUANTIZE_ERR_FORMAT;
+        std::string word;
+        for (int32_t i = 0; i < n_vocab; ++i) {
+            uint32_t len = 0;
+            if (!copy_bytes(finp, fout, &len, sizeof(len))) return QUANTIZE_ERR_FORMAT;
+            if (len > (1u << 16)) return QUANTIZE_ERR_FORMAT;  // corrupt length
+            word.resize(len);
+            if (len > 0 && !copy_bytes(finp, fout, &word[0], len)) return QUANTIZE_ERR_FORMAT;
+        }
+    }
+
+    // tensors: whisper.cpp keeps these in full precision
+    std::vector<std::string> to_skip = {
+        "encoder.conv1.bias",
+        "encoder.conv2.bias",
+        "encoder.positional_embedding",
+        "decoder.positional_embedding",
+    };
+    if (flags & QUANTIZE_KEEP_ENCODER) to_skip.emplace_back("encoder.*");
+
+    if (!ggml_common_quantize_0(finp, fout, ftype, { ".*" }, to_skip)) return QUANTIZE_ERR_FAILED;
+    return fout ? QUANTIZE_OK : QUANTIZE_ERR_IO;
+}
+
+} // namespace
+
+extern "C" int whisper_quantize_model(const char *src_path, const char *dst_path, int ftype, int flags) {
+    if (!src_path || !dst_path) return QUANTIZE_ERR_IO;
+    const auto type = static_cast<ggml_ftype>(ftype);
+    if (!is_supported(type)) return QUANTIZE_ERR_TYPE;
+
+    // Initializes ggml's fp16 conversion tables used by the quantizers.
+    {
+        struct ggml_init_params params = { 0, nullptr, false };
+        struct ggml_context *ctx = ggml_init(params);
+        ggml_free(ctx);
+    }
+
+    const std::string tmp = std::string(dst_path) + ".tmp";
+    int rc;
+    {
+        std::ifstream finp(src_path, std::ios::binary);
+        if (!finp) return QUANTIZE_ERR_IO;
+        std::ofstream fout(tmp, std::ios::binary | std::ios::trunc);
+        if (!fout) return QUANTIZE_ERR_IO;
+
+        const int64_t t0 = ggml_time_us();
+        rc = quantize_stream(finp, fout, type, flags);
+        fout.close();
+        if (rc == QUANTIZE_OK && !fout) rc = QUANTIZE_ERR_IO;
+        LOGI("%s: %s → %s: rc=%d in %.1f s",
+             __func__, src_path, dst_path, rc, (ggml_time_us() - t0) / 1e6);
+    }
+
+    if (rc == QUANTIZE_OK && std::rename(tmp.c_str(), dst_path) != 0) rc = QUANTIZE_ERR_IO;
+    if (rc != QUANTIZE_OK) std::remove(tmp.c_str());
+    return rc;
+}
+
+#ifdef WHISPER_QUANTIZE_MAIN
+// usage: whisper-quantize model-f16.bin model-quant.bin type [--keep-encoder]
+int main(int argc, char **argv) {
+    if (argc < 4) {
+        fprintf(stderr, "usage: %s model-f16.bin model-quant.bin type [--keep-encoder]\n", argv[0]);
+        ggml_print_ftypes(stderr);
+        return 1;
+    }
+    ggml_time_init();
+
+    const ggml_ftype ftype = ggml_parse_ftype(argv[3]);
+    const int flags = (argc > 4 && std::string(argv[4]) == "--keep-encoder") ? QUANTIZE_KEEP_ENCODER : 0;
+
+    const int rc = whisper_quantize_model(argv[1], argv[2], static_cast<int>(ftype), flags);
+    if (rc != QUANTIZE_OK) {
+        fprintf(stderr, "%s: failed to quantize '%s' (status %d)\n", argv[0], argv[1], rc);
+        return 1;
+    }
+    return 0;
+}
+#endif
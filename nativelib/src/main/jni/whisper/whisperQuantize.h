@@ -0,0 +1,53 @@
+// file: whisperQuantize.h
+// ============================================================
+// ✅ whisperQuantize — ggml model re-quantization (port of whisper.cpp's
+//    examples/quantize)
+// ------------------------------------------------------------
+// • C API over a small C++ translation unit (whisperQuantize.cpp)
+// • Used by the quantizeModel() JNI entry point and the whisper-quantize tool
+// • f16/f32 master → q4_0 / q4_1 / q5_0 / q5_1 / q8_0 / q2_K…q6_K
+// • Optional mixed precision: encoder kept at source precision
+// ============================================================
+
+#ifndef WHISPER_QUANTIZE_H
+#define WHISPER_QUANTIZE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Status codes shared with Kotlin (WhisperQuantizer.kt). */
+enum quantize_status {
+    QUANTIZE_OK          =  0,
+    QUANTIZE_ERR_IO      = -1,  // cannot open / read / write / rename
+    QUANTIZE_ERR_FORMAT  = -2,  // not a ggml whisper model
+    QUANTIZE_ERR_TYPE    = -3,  // target type not supported by ggml_common_quantize_0
+    QUANTIZE_ERR_FAILED  = -4,  // tensor quantization failed
+    QUANTIZE_ERR_DISABLED = -5, // built without WHISPER_QUANTIZE
+};
+
+/** Keep every `encoder.*` tensor at source precision (only the decoder is quantized). */
+#define QUANTIZE_KEEP_ENCODER 1
+
+/**
+ * Re-quantizes a ggml whisper model.
+ *
+ * Copies hparams (with the new ftype), mel filters and vocabulary, then
+ * quantizes every 2-D weight except the biases / positional embeddings
+ * that whisper.cpp always keeps in full precision. Output is written to
+ * `dst_path + ".tmp"` and renamed on success, so a partial file never
+ * appears under dst_path.
+ *
+ * @param src_path input model (typically f16)
+ * @param dst_path output model
+ * @param ftype target `enum ggml_ftype` (e.g. GGML_FTYPE_MOSTLY_Q8_0)
+ * @param flags 0 or QUANTIZE_KEEP_ENCODER
+ * @return QUANTIZE_OK or a negative quantize_status
+ */
+int whisper_quantize_model(const char *src_path, const char *dst_path, int ftype, int flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WHISPER_QUANTIZE_H
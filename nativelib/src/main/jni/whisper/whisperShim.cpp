@@ -0,0 +1,12 @@
+// file: whisperShim.cpp
+// ============================================================
+// ✅ whisperShim — delete for whisper.cpp's new-allocated results
+// ============================================================
+
+#include "whisperShim.h"
+
+#include "whisper.h"
+
+void whisper_timings_free(struct whisper_timings *t) {
+    delete t;
+}
@@ -0,0 +1,28 @@
+// file: whisperShim.h
+// ============================================================
+// ✅ whisperShim — C access to whisper.cpp's C++-owned allocations
+// ------------------------------------------------------------
+// • whisper.cpp allocates some returned structs with C++ new
+// • C callers (whisperLib.c) release them here, never with free()
+// ============================================================
+
+#ifndef WHISPER_SHIM_H
+#define WHISPER_SHIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct whisper_timings;
+
+/**
+ * Releases the struct returned by whisper_get_timings() (allocated with
+ * C++ new). NULL is ignored.
+ */
+void whisper_timings_free(struct whisper_timings *t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WHISPER_SHIM_H